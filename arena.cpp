@@ -0,0 +1,160 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "arena.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace easycmd {
+
+    // Blocks grow by doubling up to this size
+    static const size_t MAX_BLOCK_SIZE = 64 * 1024;
+
+    arena::arena(size_t first_block_size)
+      : pos_(NULL),
+        end_(NULL),
+        next_block_size_(first_block_size),
+        footprint_(0),
+        used_(0),
+        intern_cnt_(0),
+        intern_requested_(0),
+        intern_stored_(0) {
+    }
+
+    arena::~arena() {
+        for (size_t i = 0; i < cleanups_.size(); i++) {
+            cleanups_[i].cb(cleanups_[i].obj);
+        }
+
+        for (size_t i = 0; i < blocks_.size(); i++) {
+            free(blocks_[i]);
+        }
+    }
+
+    void* arena::allocate(size_t size, size_t align) {
+        uintptr_t p = ((uintptr_t)pos_ + align - 1) & ~(uintptr_t)(align - 1);
+        if (pos_ == NULL || p + size > (uintptr_t)end_) {
+            __add_block(size + align);
+            p = ((uintptr_t)pos_ + align - 1) & ~(uintptr_t)(align - 1);
+        }
+
+        pos_ = (char*)(p + size);
+        used_ += size;
+
+        return (void*)p;
+    }
+
+    const char* arena::copy_string(const char *str, size_t len) {
+        if (len == 0) {
+            return "";
+        }
+
+        char *s = (char*)allocate(len + 1, 1);
+        memcpy(s, str, len);
+        s[len] = 0;
+
+        return s;
+    }
+
+    const char* arena::intern(const char *str, size_t len) {
+        if (len == 0) {
+            return "";
+        }
+        intern_requested_ += len + 1;
+
+        // FNV-1a, as the option index
+        uint32_t h = 2166136261u;
+        for (size_t i = 0; i < len; i++) {
+            h = (h ^ (unsigned char)str[i]) * 16777619u;
+        }
+
+        if ((intern_cnt_ + 1) * 2 > interned_.size()) {
+            __grow_interned();
+        }
+        size_t mask = interned_.size() - 1;
+        size_t i = h & mask;
+        for (; interned_[i].str != NULL; i = (i + 1) & mask) {
+            const intern_slot &s = interned_[i];
+            if (s.hash == h && s.len == len && memcmp(s.str, str, len) == 0) {
+                return s.str;
+            }
+        }
+
+        intern_slot &s = interned_[i];
+        s.hash = h;
+        s.len = (uint32_t)len;
+        s.str = copy_string(str, len);
+        intern_cnt_++;
+        intern_stored_ += len + 1;
+
+        return s.str;
+    }
+
+    void arena::__grow_interned() {
+        std::vector<intern_slot> old;
+        old.swap(interned_);
+
+        intern_slot empty = { 0, 0, NULL };
+        interned_.assign(old.empty() ? 64 : old.size() * 2, empty);
+        size_t mask = interned_.size() - 1;
+        for (size_t i = 0; i < old.size(); i++) {
+            if (old[i].str == NULL) {
+                continue;
+            }
+            size_t j = old[i].hash & mask;
+            while (interned_[j].str != NULL) {
+                j = (j + 1) & mask;
+            }
+            interned_[j] = old[i];
+        }
+    }
+
+    void arena::__add_block(size_t min_size) {
+        size_t size = next_block_size_;
+        while (size < min_size) {
+            size *= 2;
+        }
+        if (next_block_size_ < MAX_BLOCK_SIZE) {
+            next_block_size_ *= 2;
+        }
+
+        char *block = (char*)malloc(size);
+        if (block == NULL) {
+            throw std::bad_alloc();
+        }
+        blocks_.push_back(block);
+
+        pos_ = block;
+        end_ = block + size;
+        footprint_ += size;
+    }
+
+    void arena::__add_cleanup(void *obj, cleanup_callback cb) {
+        cleanup c = { obj, cb };
+        cleanups_.push_back(c);
+    }
+
+}
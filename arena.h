@@ -0,0 +1,209 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef easycmd_arena_h
+#define easycmd_arena_h
+
+#include <new>
+#include <mutex>
+#include <vector>
+#include <utility>
+#include <stdint.h>
+#include <stddef.h>
+#include <type_traits>
+
+namespace easycmd {
+
+    /*********************************************************************************
+     * Arena
+     * Bump allocator that places objects and strings in contiguous blocks. Objects
+     * are never freed one by one: when the arena is destroyed, the destructors of
+     * non trivial objects are called in order of creation from a flat list, so an
+     * owner is always destroyed before the objects created after it, then all
+     * blocks are freed.
+     ********************************************************************************/
+    class arena
+    {
+    public:
+        /*********************************************************************************
+         * Constructor
+         ********************************************************************************/
+        explicit arena(size_t first_block_size = 512);
+
+        /*********************************************************************************
+         * Deconstructor
+         ********************************************************************************/
+        ~arena();
+
+        /*********************************************************************************
+         * Allocate memory
+         ********************************************************************************/
+        void* allocate(size_t size, size_t align = sizeof(void*));
+
+        /*********************************************************************************
+         * Create object in arena
+         * The destructor of the object will be called when the arena is destroyed.
+         ********************************************************************************/
+        template <typename T, typename... Args>
+        T* create(Args&&... args) {
+            T *obj = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+            if (!std::is_trivially_destructible<T>::value) {
+                __add_cleanup(obj, &__destroy<T>);
+            }
+            return obj;
+        }
+
+        /*********************************************************************************
+         * Copy string to arena
+         * The result is always null terminated.
+         ********************************************************************************/
+        const char* copy_string(const char *str, size_t len);
+
+        /*********************************************************************************
+         * Intern string
+         * Equal strings interned in the arena are stored once and get the same pointer,
+         * so the pointer identifies the string. Names, descs and defaults of commands
+         * and options are interned, they repeat across sibling commands.
+         ********************************************************************************/
+        const char* intern(const char *str, size_t len);
+
+        /*********************************************************************************
+         * Get bytes of all blocks
+         ********************************************************************************/
+        size_t footprint() const {
+            return footprint_;
+        }
+
+        /*********************************************************************************
+         * Get bytes handed out
+         ********************************************************************************/
+        size_t used() const {
+            return used_;
+        }
+
+        /*********************************************************************************
+         * Get bytes of interned strings
+         * Bytes asked for by intern() and bytes actually stored, with terminators.
+         ********************************************************************************/
+        size_t intern_requested() const {
+            return intern_requested_;
+        }
+        size_t intern_stored() const {
+            return intern_stored_;
+        }
+
+        /*********************************************************************************
+         * Get count of interned strings
+         ********************************************************************************/
+        size_t intern_count() const {
+            return intern_cnt_;
+        }
+
+        /*********************************************************************************
+         * Get block count
+         ********************************************************************************/
+        size_t block_count() const {
+            return blocks_.size();
+        }
+
+        /*********************************************************************************
+         * Get mutex
+         * The arena itself is not thread safe. Objects created in the arena after the
+         * setup, such as sub commands loaded on demand, are created under this mutex.
+         ********************************************************************************/
+        std::mutex& get_mutex() {
+            return mutex_;
+        }
+
+    private:
+        /*********************************************************************************
+         * Disable copy
+         ********************************************************************************/
+        arena(const arena&);
+        arena& operator=(const arena&);
+
+        /*********************************************************************************
+         * Add new block
+         ********************************************************************************/
+        void __add_block(size_t min_size);
+
+        /*********************************************************************************
+         * Object cleanup
+         ********************************************************************************/
+        typedef void(*cleanup_callback)(void*);
+        struct cleanup {
+            void *obj;
+            cleanup_callback cb;
+        };
+
+        void __add_cleanup(void *obj, cleanup_callback cb);
+
+        template <typename T>
+        static void __destroy(void *obj) {
+            static_cast<T*>(obj)->~T();
+        }
+
+        /*********************************************************************************
+         * Interned string slot
+         ********************************************************************************/
+        struct intern_slot {
+            uint32_t hash;
+            uint32_t len;
+            const char *str;
+        };
+
+        /*********************************************************************************
+         * Grow interned string table
+         ********************************************************************************/
+        void __grow_interned();
+
+    private:
+        // Blocks
+        std::vector<char*> blocks_;
+        // Current block
+        char *pos_;
+        char *end_;
+        // Next block size
+        size_t next_block_size_;
+
+        // Cleanups in order of creation
+        std::vector<cleanup> cleanups_;
+
+        // Memory statistics
+        size_t footprint_;
+        size_t used_;
+
+        // Interned strings, open addressing with a power of 2 slots
+        std::vector<intern_slot> interned_;
+        size_t intern_cnt_;
+        size_t intern_requested_;
+        size_t intern_stored_;
+
+        // Mutex for creating objects concurrently
+        std::mutex mutex_;
+    };
+
+}
+
+#endif
@@ -0,0 +1,313 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "async.h"
+#include "command.h"
+
+#include <signal.h>
+#include <string.h>
+#include <chrono>
+#include <thread>
+
+namespace easycmd {
+
+    namespace internal
+    {
+        // Max number of signals set to cancel
+        static const int max_signals = 8;
+
+#if !defined(WIN32)
+        typedef struct sigaction signal_action;
+#else
+        typedef void (*signal_action)(int);
+#endif
+
+        struct signal_slot
+        {
+            int signo;
+            // Handler before ours was installed
+            signal_action prev;
+        };
+
+        // Set signals, only appended, the count is read by the handler
+        static signal_slot signal_slots[max_signals];
+        static std::atomic<int> signal_cnt(0);
+
+        // Guards installing and restoring handlers
+        static std::mutex signal_mutex;
+        static int signal_scopes = 0;
+        // Handlers bump the generation while some scope is alive
+        static std::atomic<bool> signal_active(false);
+        static std::atomic<unsigned> signal_gen(0);
+
+        static signal_slot* find_signal_slot(int signo) {
+            int cnt = signal_cnt.load(std::memory_order_acquire);
+            for (int i = 0; i < cnt; i++) {
+                if (signal_slots[i].signo == signo) {
+                    return &signal_slots[i];
+                }
+            }
+            return NULL;
+        }
+
+#if !defined(WIN32)
+        static void cancel_signal_handler(int signo, siginfo_t *info, void *ctx) {
+            if (signal_active.load(std::memory_order_acquire)) {
+                signal_gen.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            // Received while the last scope goes away, act as the previous handler
+            signal_slot *slot = find_signal_slot(signo);
+            if (slot == NULL) {
+                return;
+            }
+            const signal_action &prev = slot->prev;
+            if (prev.sa_flags & SA_SIGINFO) {
+                prev.sa_sigaction(signo, info, ctx);
+            } else if (prev.sa_handler == SIG_DFL) {
+                // Delivered with the default disposition after the handler returns
+                sigaction(signo, &prev, NULL);
+                raise(signo);
+            } else if (prev.sa_handler != SIG_IGN) {
+                prev.sa_handler(signo);
+            }
+        }
+
+        static bool install_signal_handler(signal_slot &slot) {
+            signal_action act;
+            memset(&act, 0, sizeof(act));
+            act.sa_sigaction = cancel_signal_handler;
+            act.sa_flags = SA_SIGINFO | SA_RESTART;
+            sigemptyset(&act.sa_mask);
+            return sigaction(slot.signo, &act, &slot.prev) == 0;
+        }
+
+        static void restore_signal_handler(signal_slot &slot) {
+            sigaction(slot.signo, &slot.prev, NULL);
+        }
+#else
+        static void cancel_signal_handler(int signo) {
+            signal_slot *slot = find_signal_slot(signo);
+            if (signal_active.load(std::memory_order_acquire)) {
+                signal_gen.fetch_add(1, std::memory_order_relaxed);
+                // Handlers are reset to the default before they are called
+                signal(signo, cancel_signal_handler);
+            } else if (slot != NULL && slot->prev != SIG_IGN) {
+                signal(signo, slot->prev);
+                raise(signo);
+            }
+        }
+
+        static bool install_signal_handler(signal_slot &slot) {
+            slot.prev = signal(slot.signo, cancel_signal_handler);
+            return slot.prev != SIG_ERR;
+        }
+
+        static void restore_signal_handler(signal_slot &slot) {
+            signal(slot.signo, slot.prev);
+        }
+#endif
+
+        signal_scope::signal_scope() {
+            std::lock_guard<std::mutex> lock(signal_mutex);
+            if (signal_scopes++ == 0) {
+                int cnt = signal_cnt.load(std::memory_order_relaxed);
+                for (int i = 0; i < cnt; i++) {
+                    install_signal_handler(signal_slots[i]);
+                }
+                signal_active.store(true, std::memory_order_release);
+            }
+            gen_ = signal_gen.load(std::memory_order_relaxed);
+            set_ = signal_cnt.load(std::memory_order_relaxed) > 0;
+        }
+
+        signal_scope::~signal_scope() {
+            std::lock_guard<std::mutex> lock(signal_mutex);
+            if (--signal_scopes == 0) {
+                signal_active.store(false, std::memory_order_release);
+                int cnt = signal_cnt.load(std::memory_order_relaxed);
+                for (int i = 0; i < cnt; i++) {
+                    restore_signal_handler(signal_slots[i]);
+                }
+            }
+        }
+
+        bool signal_scope::is_received() const {
+            return signal_gen.load(std::memory_order_relaxed) != gen_;
+        }
+
+        struct async_context
+        {
+            // Run of the action
+            parse_result *res;
+            cancel_token *token;
+
+            // Result of the action
+            int ret;
+            bool done;
+            std::mutex mutex;
+            std::condition_variable cond;
+        };
+
+        // Interval of checking signals while an action runs
+        static const int signal_poll_ms = 10;
+    }
+
+    cancel_token::cancel_token()
+      : reason_(CANCEL_NONE) {
+    }
+
+    void cancel_token::cancel(cancel_reason reason) {
+        int none = CANCEL_NONE;
+        if (reason_.compare_exchange_strong(none, reason, std::memory_order_acq_rel)) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            cond_.notify_all();
+        }
+    }
+
+    bool cancel_token::wait_for(unsigned ms) const {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cond_.wait_for(lock, std::chrono::milliseconds(ms), [this]() { return is_cancelled(); });
+        return is_cancelled();
+    }
+
+    bool cancel_token::cancel_on_signal(int signo) {
+        std::lock_guard<std::mutex> lock(internal::signal_mutex);
+        if (internal::find_signal_slot(signo) != NULL) {
+            return true;
+        }
+        int cnt = internal::signal_cnt.load(std::memory_order_relaxed);
+        if (cnt == internal::max_signals) {
+            return false;
+        }
+
+        // Installed now to check the signal can be handled, kept only while scopes exist
+        internal::signal_slot &slot = internal::signal_slots[cnt];
+        slot.signo = signo;
+        if (!internal::install_signal_handler(slot)) {
+            return false;
+        }
+        internal::signal_cnt.store(cnt + 1, std::memory_order_release);
+        if (internal::signal_scopes == 0) {
+            internal::restore_signal_handler(slot);
+        }
+
+        return true;
+    }
+
+    std::future<int> command::run_async(int argc, 
+                                        const char **argv, 
+                                        parse_result &res, 
+                                        cancel_token &token) const {
+        return std::async(std::launch::async, [this, argc, argv, &res, &token]() {
+            return run(argc, argv, res, token);
+        });
+    }
+
+    int command::__run_async_action(parse_result &res) const {
+        cancel_token local;
+        cancel_token *token = res.token_ ? res.token_ : &local;
+
+        internal::async_context ctx;
+        ctx.res = &res;
+        ctx.token = token;
+        ctx.ret = 0;
+        ctx.done = false;
+
+        std::chrono::steady_clock::time_point deadline = 
+            std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms_);
+        internal::signal_scope signals;
+
+        std::thread worker(&command::__run_async_worker, this, (void*)&ctx);
+        {
+            // A signal handler can't notify, so signals are polled while they are set
+            std::unique_lock<std::mutex> lock(ctx.mutex);
+            while (!ctx.done) {
+                bool timed = timeout_ms_ > 0 && !token->is_cancelled();
+                bool polled = signals.is_set() && !token->is_cancelled();
+                if (!timed && !polled) {
+                    ctx.cond.wait(lock);
+                    continue;
+                }
+
+                std::chrono::steady_clock::time_point wake = deadline;
+                if (polled) {
+                    std::chrono::steady_clock::time_point poll = 
+                        std::chrono::steady_clock::now() + std::chrono::milliseconds(internal::signal_poll_ms);
+                    if (!timed || poll < wake) {
+                        wake = poll;
+                    }
+                }
+                ctx.cond.wait_until(lock, wake);
+                if (ctx.done) {
+                    break;
+                }
+
+                if (timed && std::chrono::steady_clock::now() >= deadline) {
+                    token->cancel(CANCEL_TIMEOUT);
+                }
+                if (polled && signals.is_received()) {
+                    token->cancel(CANCEL_SIGNAL);
+                }
+            }
+        }
+        worker.join();
+
+        // A cancelled run fails even if the action returned 0
+        int ret = ctx.ret;
+        cancel_reason reason = token->get_reason();
+        if (reason == CANCEL_TIMEOUT) {
+            __set_error(res, ERR_TIMEOUT);
+        } else if (reason == CANCEL_SIGNAL) {
+            __set_error(res, ERR_SIGNAL);
+        } else if (reason == CANCEL_USER) {
+            __set_error(res, ERR_CANCELLED);
+        } else if (ret != 0) {
+            __set_error(res, ERR_ACTION_FAILED);
+        }
+        if (reason != CANCEL_NONE && ret == 0) {
+            ret = -1;
+        }
+
+        return ret;
+    }
+
+    void command::__run_async_worker(void *arg) const {
+        internal::async_context *ctx = (internal::async_context*)arg;
+
+        int ret = 0;
+        {
+            // Option getters in the action read the result of the run
+            internal::active_result_scope scope(ctx->res);
+            ret = async_action_cb_(this, *ctx->res, *ctx->token);
+        }
+
+        std::lock_guard<std::mutex> lock(ctx->mutex);
+        ctx->ret = ret;
+        ctx->done = true;
+        ctx->cond.notify_all();
+    }
+
+}
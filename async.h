@@ -0,0 +1,154 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef easycmd_async_h
+#define easycmd_async_h
+
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+
+namespace easycmd {
+
+    /*********************************************************************************
+     * Cancel reasons
+     ********************************************************************************/
+    enum cancel_reason
+    {
+        CANCEL_NONE = 0,
+        // Cancelled by cancel_token::cancel
+        CANCEL_USER,
+        // A signal set by cancel_token::cancel_on_signal was received
+        CANCEL_SIGNAL,
+        // The timeout of the command passed
+        CANCEL_TIMEOUT
+    };
+
+    /*********************************************************************************
+     * Cancel token
+     * Passed to async actions, which should poll it or sleep on it and return soon
+     * after it is cancelled. Cancellation is cooperative: an action that ignores
+     * the token runs to its end. A token can be cancelled from any thread.
+     ********************************************************************************/
+    class cancel_token
+    {
+    public:
+        /*********************************************************************************
+         * Constructor
+         ********************************************************************************/
+        cancel_token();
+
+        /*********************************************************************************
+         * Cancel
+         * Only the first reason is kept. Sleeping waiters are woken up.
+         ********************************************************************************/
+        void cancel(cancel_reason reason = CANCEL_USER);
+
+        /*********************************************************************************
+         * Check the token is cancelled
+         ********************************************************************************/
+        bool is_cancelled() const {
+            return reason_.load(std::memory_order_acquire) != CANCEL_NONE;
+        }
+
+        /*********************************************************************************
+         * Get cancel reason
+         ********************************************************************************/
+        cancel_reason get_reason() const {
+            return (cancel_reason)reason_.load(std::memory_order_acquire);
+        }
+
+        /*********************************************************************************
+         * Sleep until cancelled or ms milliseconds passed
+         * Return true if the token is cancelled.
+         ********************************************************************************/
+        bool wait_for(unsigned ms) const;
+
+        /*********************************************************************************
+         * Reset for reuse
+         ********************************************************************************/
+        void reset() {
+            reason_.store(CANCEL_NONE, std::memory_order_release);
+        }
+
+        /*********************************************************************************
+         * Cancel running async actions on signal
+         * Sets the signal, such as SIGINT, to cancel the token of every async action and
+         * serve running when it is received, with CANCEL_SIGNAL. The handler is only
+         * installed while such runs exist, the previous handler is restored after the
+         * last of them. A signal received when none runs is passed to the previous
+         * handler, so the default disposition applies. Return false if the handler
+         * can't be installed.
+         ********************************************************************************/
+        static bool cancel_on_signal(int signo);
+
+    private:
+        /*********************************************************************************
+         * Disable copy
+         ********************************************************************************/
+        cancel_token(const cancel_token&);
+        cancel_token& operator=(const cancel_token&);
+
+    private:
+        // Cancel reason
+        std::atomic<int> reason_;
+
+        // Waiters of wait_for
+        mutable std::mutex mutex_;
+        mutable std::condition_variable cond_;
+    };
+
+    namespace internal {
+
+        /*********************************************************************************
+         * Signal scope
+         * Installs the handlers of the signals set by cancel_token::cancel_on_signal
+         * while alive. The previous handlers are restored when the last scope goes away.
+         ********************************************************************************/
+        class signal_scope
+        {
+        public:
+            signal_scope();
+            ~signal_scope();
+
+            // Check some signal is set to cancel
+            bool is_set() const {
+                return set_;
+            }
+
+            // Check a set signal was received since the scope was created
+            bool is_received() const;
+
+        private:
+            // Generation of signals when created
+            unsigned gen_;
+            // Some signal was set when created
+            bool set_;
+        };
+
+    }
+
+}
+
+#endif
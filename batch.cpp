@@ -0,0 +1,188 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "batch.h"
+#include "command.h"
+#include "tokenizer.h"
+
+#include <stdio.h>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace easycmd {
+
+    namespace internal
+    {
+        struct batch_context
+        {
+            // Input
+            FILE *input;
+            size_t line_no;
+            std::mutex input_mutex;
+
+            // Report
+            batch_callback cb;
+            size_t lines;
+            size_t failed;
+            std::mutex report_mutex;
+        };
+
+        static bool read_line(FILE *f, std::string &line) {
+            line.clear();
+
+            char buf[4096];
+            while (fgets(buf, sizeof(buf), f) != NULL) {
+                line.append(buf);
+                if (line[line.size() - 1] == '\n') {
+                    return true;
+                }
+            }
+
+            return !line.empty();
+        }
+
+        static bool is_blank_line(const std::string &line) {
+            for (size_t i = 0; i < line.size(); i++) {
+                char c = line[i];
+                if (c == '#') {
+                    return true;
+                }
+                if (c != ' ' && c != '\t' && c != '\r' && c != '\n') {
+                    return false;
+                }
+            }
+            return true;
+        }
+    }
+
+    int command::run_batch(const char *path, 
+                           int workers, 
+                           batch_callback cb, 
+                           batch_stats *stats) {
+        if (path == NULL || strcmp(path, "-") == 0) {
+            return run_batch(stdin, workers, cb, stats);
+        }
+
+        FILE *input = fopen(path, "r");
+        if (input == NULL) {
+            __set_error(err_, "open batch file %s failed\n", path);
+            return -1;
+        }
+
+        int ret = run_batch(input, workers, cb, stats);
+        fclose(input);
+
+        return ret;
+    }
+
+    int command::run_batch(FILE *input, 
+                           int workers, 
+                           batch_callback cb, 
+                           batch_stats *stats) const {
+        if (workers <= 0) {
+            workers = (int)std::thread::hardware_concurrency();
+            if (workers <= 0) {
+                workers = 1;
+            }
+        }
+
+        internal::batch_context ctx;
+        ctx.input = input;
+        ctx.line_no = 0;
+        ctx.cb = cb;
+        ctx.lines = 0;
+        ctx.failed = 0;
+
+        std::chrono::steady_clock::time_point beg = std::chrono::steady_clock::now();
+
+        std::vector<std::thread> threads;
+        for (int i = 0; i < workers; i++) {
+            threads.push_back(std::thread(&command::__run_batch_worker, this, (void*)&ctx));
+        }
+        for (size_t i = 0; i < threads.size(); i++) {
+            threads[i].join();
+        }
+
+        double seconds = std::chrono::duration_cast<std::chrono::duration<double> >(
+            std::chrono::steady_clock::now() - beg).count();
+
+        if (stats) {
+            stats->lines = ctx.lines;
+            stats->failed = ctx.failed;
+            stats->seconds = seconds;
+            stats->lines_per_sec = seconds > 0 ? (double)ctx.lines / seconds : 0;
+        }
+
+        return ctx.failed == 0 ? 0 : -1;
+    }
+
+    void command::__run_batch_worker(void *arg) const {
+        internal::batch_context *ctx = (internal::batch_context*)arg;
+
+        // Each worker keeps its own parse result, so command lines run in parallel
+        parse_result pres;
+        std::string line;
+        std::vector<const char*> argv;
+        while (true) {
+            batch_result res;
+            {
+                std::lock_guard<std::mutex> lock(ctx->input_mutex);
+                if (!internal::read_line(ctx->input, line)) {
+                    return;
+                }
+                res.line = ++ctx->line_no;
+            }
+            if (internal::is_blank_line(line)) {
+                continue;
+            }
+
+            argv.clear();
+            argv.push_back(name_);
+            if (!internal::split_command_line(&line[0], argv)) {
+                res.ret = -1;
+                res.code = ERR_UNTERMINATED_QUOTE;
+                res.err = "unterminated quote\n";
+            } else {
+                res.ret = run((int)argv.size(), &argv[0], pres);
+                res.code = pres.get_error().get_code();
+                // Nobody reads the text without a callback
+                if (res.ret != 0 && ctx->cb) {
+                    res.err = pres.get_err();
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(ctx->report_mutex);
+            ctx->lines++;
+            if (res.ret != 0) {
+                ctx->failed++;
+            }
+            if (ctx->cb) {
+                ctx->cb(res);
+            }
+        }
+    }
+
+}
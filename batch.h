@@ -0,0 +1,72 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef easycmd_batch_h
+#define easycmd_batch_h
+
+#include <string>
+#include <stddef.h>
+
+#include "run_error.h"
+
+namespace easycmd {
+
+    /*********************************************************************************
+     * Batch result of one command line
+     ********************************************************************************/
+    struct batch_result
+    {
+        // Line number in input, starting from 1
+        size_t line;
+        // Return value of run
+        int ret;
+        // Error code and error of run if ret is not 0
+        error_code code;
+        std::string err;
+    };
+
+    /*********************************************************************************
+     * Batch statistics
+     ********************************************************************************/
+    struct batch_stats
+    {
+        // Command lines run, blank and comment lines are not counted
+        size_t lines;
+        // Command lines failed
+        size_t failed;
+        // Wall time
+        double seconds;
+        // Command lines per second
+        double lines_per_sec;
+    };
+
+    /*********************************************************************************
+     * Batch result callback
+     * Called from worker threads, but never at the same time.
+     ********************************************************************************/
+    typedef void(*batch_callback)(const batch_result&);
+
+}
+
+#endif
@@ -0,0 +1,81 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "bench.h"
+
+#include <easycmd/batch.h>
+
+#include <stdio.h>
+#include <thread>
+
+void bench_batch(const bench_config &cfg, bench_report &rep)
+{
+	const int line_cnt = 20000;
+
+	easycmd::command *root = build_tree(cfg, NULL);
+
+	std::vector<std::string> storage;
+	std::vector<const char*> argv;
+	build_args(cfg, storage, argv);
+
+	std::string line;
+	for (size_t i = 1; i < argv.size(); i++) {
+		line.append(argv[i]).append(i + 1 < argv.size() ? " " : "\n");
+	}
+
+	FILE *input = tmpfile();
+	if (input == NULL) {
+		fprintf(stderr, "create batch file failed\n");
+		delete root;
+		return;
+	}
+	for (int i = 0; i < line_cnt; i++) {
+		fputs(line.c_str(), input);
+	}
+
+	int hw = (int)std::thread::hardware_concurrency();
+	int worker_cnts[] = { 1, hw > 1 ? hw : 2 };
+	for (int w = 0; w < 2; w++) {
+		rewind(input);
+
+		easycmd::batch_stats stats;
+		size_t allocs = alloc_count();
+		if (root->run_batch(input, worker_cnts[w], NULL, &stats) != 0) {
+			fprintf(stderr, "batch failed: %zu of %zu lines\n", stats.failed, stats.lines);
+		}
+		allocs = alloc_count() - allocs;
+
+		rep.begin_case("batch");
+		rep.param("workers", worker_cnts[w]);
+		rep.param("argc", (double)argv.size());
+		rep.metric("lines", (double)stats.lines);
+		rep.metric("ns_per_op", stats.seconds * 1e9 / stats.lines);
+		rep.metric("lines_per_sec", stats.lines_per_sec);
+		rep.metric("allocs_per_op", (double)allocs / stats.lines);
+		rep.end_case();
+	}
+
+	fclose(input);
+	delete root;
+}
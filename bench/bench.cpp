@@ -0,0 +1,219 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "bench.h"
+
+#include <new>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/*********************************************************************************
+ * Heap allocation counter
+ ********************************************************************************/
+static size_t alloc_cnt = 0;
+
+void* operator new(size_t size)
+{
+	alloc_cnt++;
+	void *p = malloc(size ? size : 1);
+	if (p == NULL) {
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void operator delete(void *p) noexcept
+{
+	free(p);
+}
+
+size_t alloc_count()
+{
+	return alloc_cnt;
+}
+
+double elapsed_ns(bench_clock::time_point beg)
+{
+	return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(bench_clock::now() - beg).count();
+}
+
+std::string bench_name(const char *prefix, int i)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "%s%d", prefix, i);
+	return name;
+}
+
+int bench_noop(const easycmd::command *cmd)
+{
+	return 0;
+}
+
+static void build_level(easycmd::command *cmd, const bench_config &cfg, int level, easycmd::command **last_leaf)
+{
+	for (int i = 0; i < cfg.options; i++) {
+		cmd->create_option_int(bench_name("opt", i), "")
+			->with_desc("Synthetic option")
+			->with_default(0);
+	}
+
+	if (level == cfg.depth) {
+		cmd->with_action(bench_noop);
+		if (last_leaf) {
+			*last_leaf = cmd;
+		}
+		return;
+	}
+
+	for (int i = 0; i < cfg.width; i++) {
+		easycmd::command *sub = cmd->create_sub_cmd(bench_name("c", i));
+		sub->with_desc("Synthetic command");
+		build_level(sub, cfg, level + 1, last_leaf);
+	}
+}
+
+easycmd::command* build_tree(const bench_config &cfg, easycmd::command **last_leaf)
+{
+	easycmd::command *root = new easycmd::command();
+	root->with_name("bench")->with_desc("Synthetic root command");
+	build_level(root, cfg, 0, last_leaf);
+	return root;
+}
+
+void build_args(const bench_config &cfg, 
+                std::vector<std::string> &storage, 
+                std::vector<const char*> &argv)
+{
+	storage.clear();
+	storage.push_back("bench");
+	for (int i = 0; i < cfg.depth; i++) {
+		storage.push_back(bench_name("c", cfg.width - 1));
+	}
+	for (int i = 0; cfg.options > 0 && i < cfg.tokens; i++) {
+		// Spread tokens over all options, so early hits don't hide lookup cost
+		int idx = (int)(((long long)i * 7919) % cfg.options);
+		storage.push_back("--" + bench_name("opt", idx) + "=1");
+	}
+
+	argv.clear();
+	for (size_t i = 0; i < storage.size(); i++) {
+		argv.push_back(storage[i].c_str());
+	}
+}
+
+bench_report::bench_report()
+{
+}
+
+void bench_report::begin_case(const char *name)
+{
+	name_ = name;
+	params_.clear();
+	metrics_.clear();
+}
+
+void bench_report::end_case()
+{
+	std::string c;
+	c.append("    {\"name\": \"").append(name_).append("\", ");
+	c.append("\"params\": {").append(params_).append("}, ");
+	c.append("\"metrics\": {").append(metrics_).append("}}");
+	cases_.push_back(c);
+}
+
+void bench_report::param(const char *key, double value)
+{
+	char buf[64];
+	snprintf(buf, sizeof(buf), "%.17g", value);
+	__append_key(params_, key);
+	params_.append(buf);
+}
+
+void bench_report::param(const char *key, const char *value)
+{
+	__append_key(params_, key);
+	params_.append("\"");
+	for (const char *p = value; *p; p++) {
+		if (*p == '"' || *p == '\\') {
+			params_.append(1, '\\');
+		}
+		params_.append(1, *p);
+	}
+	params_.append("\"");
+}
+
+void bench_report::metric(const char *key, double value)
+{
+	char buf[64];
+	if (isfinite(value)) {
+		snprintf(buf, sizeof(buf), "%.6g", value);
+	} else {
+		snprintf(buf, sizeof(buf), "null");
+	}
+	__append_key(metrics_, key);
+	metrics_.append(buf);
+}
+
+void bench_report::add_rounds(const std::vector<double> &round_ns, size_t allocs, double ops)
+{
+	double sum = 0;
+	double best = 0;
+	for (size_t i = 0; i < round_ns.size(); i++) {
+		sum += round_ns[i];
+		if (i == 0 || round_ns[i] < best) {
+			best = round_ns[i];
+		}
+	}
+
+	double cnt = (double)round_ns.size();
+	metric("ns_per_op", sum / cnt / ops);
+	metric("min_ns_per_op", best / ops);
+	metric("allocs_per_op", (double)allocs / cnt / ops);
+}
+
+std::string bench_report::to_json(const bench_config &cfg) const
+{
+	char buf[256];
+	snprintf(buf, sizeof(buf),
+		"  \"config\": {\"width\": %d, \"depth\": %d, \"options\": %d, \"tokens\": %d, \"rounds\": %d},\n",
+		cfg.width, cfg.depth, cfg.options, cfg.tokens, cfg.rounds);
+
+	std::string out;
+	out.append("{\n").append(buf).append("  \"cases\": [\n");
+	for (size_t i = 0; i < cases_.size(); i++) {
+		out.append(cases_[i]).append(i + 1 < cases_.size() ? ",\n" : "\n");
+	}
+	out.append("  ]\n}\n");
+
+	return out;
+}
+
+void bench_report::__append_key(std::string &out, const char *key)
+{
+	if (!out.empty()) {
+		out.append(", ");
+	}
+	out.append("\"").append(key).append("\": ");
+}
@@ -0,0 +1,166 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef easycmd_bench_h
+#define easycmd_bench_h
+
+#include <easycmd/command.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+/*********************************************************************************
+ * Benchmark config
+ ********************************************************************************/
+struct bench_config
+{
+	// Sub commands per command
+	int width;
+	// Levels of sub commands
+	int depth;
+	// Options per command
+	int options;
+	// Option tokens per command line
+	int tokens;
+	// Measure rounds, the best and the mean round are reported
+	int rounds;
+};
+
+/*********************************************************************************
+ * Timing
+ ********************************************************************************/
+typedef std::chrono::steady_clock bench_clock;
+
+double elapsed_ns(bench_clock::time_point beg);
+
+/*********************************************************************************
+ * Heap allocations since process start
+ ********************************************************************************/
+size_t alloc_count();
+
+/*********************************************************************************
+ * Synthetic names: prefix + index
+ ********************************************************************************/
+std::string bench_name(const char *prefix, int i);
+
+/*********************************************************************************
+ * Action doing nothing
+ ********************************************************************************/
+int bench_noop(const easycmd::command *cmd);
+
+/*********************************************************************************
+ * Synthetic tree
+ * Every command has width sub commands named c0..cN and options int options named
+ * opt0..optN, down to depth levels. Leaf commands have the noop action, the last
+ * created leaf is returned by last_leaf if it is not null.
+ ********************************************************************************/
+easycmd::command* build_tree(const bench_config &cfg, easycmd::command **last_leaf);
+
+/*********************************************************************************
+ * Synthetic command line
+ * Dispatches to the last leaf and passes tokens option tokens to it. The strings 
+ * are kept in storage, argv points into them.
+ ********************************************************************************/
+void build_args(const bench_config &cfg, 
+                std::vector<std::string> &storage, 
+                std::vector<const char*> &argv);
+
+/*********************************************************************************
+ * JSON report
+ ********************************************************************************/
+class bench_report
+{
+public:
+	bench_report();
+
+	/*********************************************************************************
+	 * Case
+	 ********************************************************************************/
+	void begin_case(const char *name);
+	void end_case();
+
+	/*********************************************************************************
+	 * Case param and metric
+	 ********************************************************************************/
+	void param(const char *key, double value);
+	void param(const char *key, const char *value);
+	void metric(const char *key, double value);
+
+	/*********************************************************************************
+	 * Measure rounds
+	 * Adds ns_per_op, min_ns_per_op and allocs_per_op metrics of the rounds.
+	 ********************************************************************************/
+	void add_rounds(const std::vector<double> &round_ns, size_t allocs, double ops);
+
+	/*********************************************************************************
+	 * Render report
+	 ********************************************************************************/
+	std::string to_json(const bench_config &cfg) const;
+
+private:
+	void __append_key(std::string &out, const char *key);
+
+private:
+	// Rendered cases
+	std::vector<std::string> cases_;
+	// Current case
+	std::string params_;
+	std::string metrics_;
+	std::string name_;
+};
+
+/*********************************************************************************
+ * Cases
+ ********************************************************************************/
+void bench_build(const bench_config &cfg, bench_report &rep);
+void bench_usage(const bench_config &cfg, bench_report &rep);
+void bench_run(const bench_config &cfg, bench_report &rep);
+void bench_option_lookup(const bench_config &cfg, bench_report &rep);
+void bench_tokenizer(const bench_config &cfg, bench_report &rep);
+void bench_response_file(const bench_config &cfg, bench_report &rep);
+void bench_getopt(const bench_config &cfg, bench_report &rep);
+void bench_batch(const bench_config &cfg, bench_report &rep);
+void bench_complete(const bench_config &cfg, bench_report &rep);
+void bench_suggest(const bench_config &cfg, bench_report &rep);
+void bench_env(const bench_config &cfg, bench_report &rep);
+void bench_numeric(const bench_config &cfg, bench_report &rep);
+void bench_trace(const bench_config &cfg, bench_report &rep);
+void bench_lazy(const bench_config &cfg, bench_report &rep);
+void bench_schema(const bench_config &cfg, bench_report &rep);
+void bench_errors(const bench_config &cfg, bench_report &rep);
+void bench_intern(const bench_config &cfg, bench_report &rep);
+void bench_scope(const bench_config &cfg, bench_report &rep);
+void bench_daemon(const bench_config &cfg, bench_report &rep);
+void bench_choice(const bench_config &cfg, bench_report &rep);
+void bench_usage_sink(const bench_config &cfg, bench_report &rep);
+void bench_def(const bench_config &cfg, bench_report &rep);
+
+/*********************************************************************************
+ * Child process of the daemon case
+ * Started as "bench --daemon-child <cold|client> width depth options".
+ ********************************************************************************/
+int bench_daemon_child(int argc, const char **argv);
+
+#endif
@@ -0,0 +1,101 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "bench.h"
+
+#include <stdio.h>
+
+static const char *const modes[] = { "fast", "safe", "audit", "trace", "replay", "dry-run", "verify", "repair" };
+static const int mode_cnt = sizeof(modes) / sizeof(modes[0]);
+
+// Mapped id of the last run, read back so the mapping is not optimized away
+static int mode_id = 0;
+
+// What actions do with a string option: a chain of compares
+static int string_action(const easycmd::command *cmd)
+{
+	const std::string &mode = cmd->get_option("mode")->get_string();
+	mode_id = -1;
+	for (int i = 0; i < mode_cnt; i++) {
+		if (mode == modes[i]) {
+			mode_id = i;
+			break;
+		}
+	}
+	return mode_id < 0 ? -1 : 0;
+}
+
+static int choice_action(const easycmd::command *cmd)
+{
+	mode_id = cmd->get_option("mode")->get_int();
+	return 0;
+}
+
+// The mode passed as string option and mapped by the action, against the mode
+// passed as choice option and mapped while the option is set up
+void bench_choice(const bench_config &cfg, bench_report &rep)
+{
+	const int iterations = 100000;
+	for (int choice = 0; choice < 2; choice++) {
+		easycmd::command cmd;
+		cmd.with_name("bench")->with_action(choice ? choice_action : string_action);
+		if (choice) {
+			cmd.create_option_choice("mode", "m", std::vector<std::string>(modes, modes + mode_cnt))
+				->with_default("fast");
+		} else {
+			cmd.create_option_string("mode", "m")->with_default("fast");
+		}
+
+		std::vector<std::string> args;
+		for (int i = 0; i < mode_cnt; i++) {
+			args.push_back(std::string("--mode=") + modes[i]);
+		}
+
+		easycmd::parse_result res;
+		std::vector<double> round_ns;
+		round_ns.reserve(cfg.rounds);
+		size_t allocs = alloc_count();
+		long long sum = 0;
+		for (int r = 0; r < cfg.rounds; r++) {
+			bench_clock::time_point beg = bench_clock::now();
+			for (int i = 0; i < iterations; i++) {
+				const char *argv[] = { "bench", args[i % mode_cnt].c_str() };
+				if (((const easycmd::command&)cmd).run(2, argv, res) != 0) {
+					fprintf(stderr, "run failed: %s\n", res.get_err().c_str());
+					return;
+				}
+				sum += mode_id;
+			}
+			round_ns.push_back(elapsed_ns(beg));
+		}
+		allocs = alloc_count() - allocs;
+
+		rep.begin_case("choice");
+		rep.param("modes", mode_cnt);
+		rep.param("option", choice ? "choice" : "string");
+		rep.add_rounds(round_ns, allocs, iterations);
+		rep.metric("mean_id", (double)sum / ((double)iterations * cfg.rounds));
+		rep.end_case();
+	}
+}
@@ -0,0 +1,103 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "bench.h"
+
+static easycmd::command* build_flat(int subs, int options)
+{
+	easycmd::command *cmd = new easycmd::command();
+	cmd->with_name("bench");
+	for (int i = 0; i < subs; i++) {
+		cmd->create_sub_cmd(bench_name("c", i))->with_action(bench_noop);
+	}
+	for (int i = 0; i < options; i++) {
+		cmd->create_option_int(bench_name("opt", i), "")->with_default(0);
+	}
+	return cmd;
+}
+
+static void bench_complete_word(const char *name, 
+								const easycmd::command *cmd, 
+								std::vector<const char*> &argv,
+								const bench_config &cfg, 
+								bench_report &rep)
+{
+	const int iterations = 1000;
+	std::vector<const char*> candidates;
+	std::vector<double> round_ns;
+	round_ns.reserve(cfg.rounds);
+	size_t allocs = alloc_count();
+	for (int r = 0; r < cfg.rounds; r++) {
+		bench_clock::time_point beg = bench_clock::now();
+		for (int i = 0; i < iterations; i++) {
+			cmd->complete((int)argv.size(), &argv[0], candidates, 64);
+		}
+		round_ns.push_back(elapsed_ns(beg));
+	}
+	allocs = alloc_count() - allocs;
+
+	rep.begin_case(name);
+	rep.param("word", argv.back());
+	rep.add_rounds(round_ns, allocs, iterations);
+	rep.metric("candidates", (double)candidates.size());
+	rep.end_case();
+}
+
+void bench_complete(const bench_config &cfg, bench_report &rep)
+{
+	const int sub_cnts[] = { 100, 1000, 5000 };
+	for (size_t c = 0; c < sizeof(sub_cnts) / sizeof(sub_cnts[0]); c++) {
+		easycmd::command *cmd = build_flat(sub_cnts[c], cfg.options);
+
+		// The first completion builds the trie
+		std::vector<const char*> argv;
+		argv.push_back("bench");
+		argv.push_back("c12");
+		std::vector<const char*> candidates;
+		bench_clock::time_point beg = bench_clock::now();
+		cmd->complete((int)argv.size(), &argv[0], candidates, 64);
+		double first_ns = elapsed_ns(beg);
+
+		rep.begin_case("complete_first");
+		rep.param("sub_cmds", sub_cnts[c]);
+		rep.metric("ns", first_ns);
+		rep.end_case();
+
+		bench_complete_word("complete_prefix", cmd, argv, cfg, rep);
+		argv.back() = "--opt1";
+		bench_complete_word("complete_option", cmd, argv, cfg, rep);
+
+		delete cmd;
+	}
+
+	// Completion after the whole path of the synthetic tree
+	easycmd::command *root = build_tree(cfg, NULL);
+	std::vector<std::string> storage;
+	std::vector<const char*> argv;
+	build_args(cfg, storage, argv);
+	argv.resize(cfg.depth + 1);
+	argv.push_back("");
+	bench_complete_word("complete_path", root, argv, cfg, rep);
+	delete root;
+}
@@ -0,0 +1,222 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "bench.h"
+
+#include <easycmd/async.h>
+#include <easycmd/daemon.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <thread>
+#if !defined(WIN32)
+#include <spawn.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+extern char **environ;
+#endif
+
+static const char *daemon_path = "bench_daemon.sock";
+
+// Synthetic tree of the config passed as "width depth options" after the mode
+static easycmd::command* child_tree(const char **argv, bench_config &cfg)
+{
+	cfg.width = atoi(argv[0]);
+	cfg.depth = atoi(argv[1]);
+	cfg.options = atoi(argv[2]);
+	cfg.tokens = 64;
+	cfg.rounds = 1;
+	return build_tree(cfg, NULL);
+}
+
+int bench_daemon_child(int argc, const char **argv)
+{
+	if (argc < 4) {
+		return -1;
+	}
+
+	// Cold start: build the tree and run the synthetic command line once
+	if (strcmp(argv[0], "cold") == 0) {
+		bench_config cfg;
+		easycmd::command *root = child_tree(argv + 1, cfg);
+		std::vector<std::string> storage;
+		std::vector<const char*> args;
+		build_args(cfg, storage, args);
+		int ret = root->run((int)args.size(), &args[0]);
+		delete root;
+		return ret;
+	}
+
+	// Client: forward the synthetic command line to the daemon
+	if (strcmp(argv[0], "client") == 0) {
+		bench_config cfg;
+		cfg.width = atoi(argv[1]);
+		cfg.depth = atoi(argv[2]);
+		cfg.options = atoi(argv[3]);
+		cfg.tokens = 64;
+		std::vector<std::string> storage;
+		std::vector<const char*> args;
+		build_args(cfg, storage, args);
+		int ret = -1;
+		if (!easycmd::forward_to_daemon(daemon_path, (int)args.size(), &args[0], ret)) {
+			return -1;
+		}
+		return ret;
+	}
+
+	return -1;
+}
+
+#if !defined(WIN32)
+// Spawns count processes of this program in mode, then waits for all of them
+static bool spawn_children(const char *exe, const char *mode, const bench_config &cfg, int count)
+{
+	char width[16], depth[16], options[16];
+	snprintf(width, sizeof(width), "%d", cfg.width);
+	snprintf(depth, sizeof(depth), "%d", cfg.depth);
+	snprintf(options, sizeof(options), "%d", cfg.options);
+	char *argv[] = { (char*)exe, (char*)"--daemon-child", (char*)mode, width, depth, options, NULL };
+
+	std::vector<pid_t> pids;
+	for (int i = 0; i < count; i++) {
+		pid_t pid;
+		if (posix_spawn(&pid, exe, NULL, NULL, argv, environ) != 0) {
+			return false;
+		}
+		pids.push_back(pid);
+	}
+
+	bool ok = true;
+	for (size_t i = 0; i < pids.size(); i++) {
+		int status = 0;
+		waitpid(pids[i], &status, 0);
+		ok = ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+	}
+	return ok;
+}
+
+static bool measure_children(const char *exe, 
+                             const char *mode, 
+                             const bench_config &cfg, 
+                             int parallel, 
+                             std::vector<double> &round_ns, 
+                             int iterations)
+{
+	round_ns.clear();
+	for (int r = 0; r < cfg.rounds; r++) {
+		bench_clock::time_point beg = bench_clock::now();
+		for (int i = 0; i < iterations; i += parallel) {
+			if (!spawn_children(exe, mode, cfg, parallel)) {
+				fprintf(stderr, "%s run failed\n", mode);
+				return false;
+			}
+		}
+		round_ns.push_back(elapsed_ns(beg));
+	}
+	return true;
+}
+#endif
+
+// Cold starts of the program against runs forwarded to a daemon holding the
+// tree. Forwarded runs are measured from a client process, as a tool would be
+// used, and from a client in this process, which leaves only the round trip.
+// Parallel invocations show throughput, the daemon serves one at a time.
+void bench_daemon(const bench_config &cfg, bench_report &rep)
+{
+#if !defined(WIN32)
+	char exe[4096];
+	ssize_t len = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+	if (len <= 0) {
+		fprintf(stderr, "daemon case needs /proc/self/exe\n");
+		return;
+	}
+	exe[len] = 0;
+
+	easycmd::command *root = build_tree(cfg, NULL);
+	easycmd::cancel_token token;
+	std::thread server([root, &token]() {
+		std::string err;
+		if (!root->serve(daemon_path, token, err)) {
+			fprintf(stderr, "%s\n", err.c_str());
+		}
+	});
+
+	// Wait for the daemon to listen
+	std::vector<std::string> storage;
+	std::vector<const char*> args;
+	build_args(cfg, storage, args);
+	int ret = -1;
+	for (int i = 0; i < 100 && !easycmd::forward_to_daemon(daemon_path, (int)args.size(), &args[0], ret); i++) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+
+	const int iterations = 64;
+	const int parallels[] = { 1, 8 };
+	const char *modes[] = { "cold", "client" };
+	std::vector<double> round_ns;
+	for (size_t m = 0; m < 2; m++) {
+		for (size_t p = 0; p < 2; p++) {
+			if (!measure_children(exe, modes[m], cfg, parallels[p], round_ns, iterations)) {
+				break;
+			}
+			double best = round_ns[0];
+			for (size_t i = 1; i < round_ns.size(); i++) {
+				best = round_ns[i] < best ? round_ns[i] : best;
+			}
+
+			rep.begin_case("daemon");
+			rep.param("mode", modes[m]);
+			rep.param("parallel", parallels[p]);
+			rep.add_rounds(round_ns, 0, iterations);
+			rep.metric("runs_per_sec", iterations / (best / 1e9));
+			rep.end_case();
+		}
+	}
+
+	// Round trip only
+	const int forwards = 1000;
+	round_ns.clear();
+	for (int r = 0; r < cfg.rounds; r++) {
+		bench_clock::time_point beg = bench_clock::now();
+		for (int i = 0; i < forwards; i++) {
+			if (!easycmd::forward_to_daemon(daemon_path, (int)args.size(), &args[0], ret) || ret != 0) {
+				fprintf(stderr, "forward failed\n");
+				break;
+			}
+		}
+		round_ns.push_back(elapsed_ns(beg));
+	}
+	rep.begin_case("daemon");
+	rep.param("mode", "in_process");
+	rep.param("parallel", 1);
+	rep.add_rounds(round_ns, 0, forwards);
+	rep.end_case();
+
+	token.cancel();
+	server.join();
+	delete root;
+#endif
+}
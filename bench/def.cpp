@@ -0,0 +1,104 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "bench.h"
+
+#include <stdio.h>
+
+// The synthetic tree with width 8, depth 2 and 16 options declared as static 
+// definitions. Names and shape must match build_tree with the same config.
+#define DEF_OPT(i) easycmd::def_option_int("opt" #i, "").with_desc("Synthetic option").with_default(0)
+
+static const easycmd::option_def def_opts[] = {
+	DEF_OPT(0), DEF_OPT(1), DEF_OPT(2), DEF_OPT(3), DEF_OPT(4), DEF_OPT(5), DEF_OPT(6), DEF_OPT(7),
+	DEF_OPT(8), DEF_OPT(9), DEF_OPT(10), DEF_OPT(11), DEF_OPT(12), DEF_OPT(13), DEF_OPT(14), DEF_OPT(15)
+};
+
+#define DEF_LEAF(i) \
+	static const easycmd::command_def leaf##i = easycmd::def_command("c" #i) \
+		.with_desc("Synthetic command").with_action(bench_noop).with_options(def_opts)
+
+DEF_LEAF(0); DEF_LEAF(1); DEF_LEAF(2); DEF_LEAF(3); DEF_LEAF(4); DEF_LEAF(5); DEF_LEAF(6); DEF_LEAF(7);
+
+static const easycmd::command_def *const leaves[] = { 
+	&leaf0, &leaf1, &leaf2, &leaf3, &leaf4, &leaf5, &leaf6, &leaf7 
+};
+
+#define DEF_MID(i) \
+	static const easycmd::command_def mid##i = easycmd::def_command("c" #i) \
+		.with_desc("Synthetic command").with_options(def_opts).with_sub_cmds(leaves)
+
+DEF_MID(0); DEF_MID(1); DEF_MID(2); DEF_MID(3); DEF_MID(4); DEF_MID(5); DEF_MID(6); DEF_MID(7);
+
+static const easycmd::command_def *const mids[] = { 
+	&mid0, &mid1, &mid2, &mid3, &mid4, &mid5, &mid6, &mid7 
+};
+
+static const easycmd::command_def root_def = 
+	easycmd::def_command("bench").with_desc("Synthetic root command").with_options(def_opts).with_sub_cmds(mids);
+
+// Startup of a process: builds the tree and runs the synthetic command line once, 
+// with the tree built in code and constructed from the static definitions
+void bench_def(const bench_config &cfg, bench_report &rep)
+{
+	bench_config def_cfg = cfg;
+	def_cfg.width = 8;
+	def_cfg.depth = 2;
+	def_cfg.options = 16;
+
+	std::vector<std::string> storage;
+	std::vector<const char*> argv;
+	build_args(def_cfg, storage, argv);
+
+	for (int def = 0; def < 2; def++) {
+		std::vector<double> round_ns;
+		round_ns.reserve(cfg.rounds);
+		size_t allocs = 0;
+		size_t footprint = 0;
+		for (int r = 0; r < cfg.rounds; r++) {
+			size_t beg_allocs = alloc_count();
+			bench_clock::time_point beg = bench_clock::now();
+			easycmd::command *root = def ? new easycmd::command(&root_def) : build_tree(def_cfg, NULL);
+			easycmd::parse_result res;
+			if (((const easycmd::command*)root)->run((int)argv.size(), &argv[0], res) != 0) {
+				fprintf(stderr, "run failed: %s\n", res.get_err().c_str());
+				delete root;
+				return;
+			}
+			round_ns.push_back(elapsed_ns(beg));
+			allocs += alloc_count() - beg_allocs;
+			footprint = root->get_arena()->footprint();
+			delete root;
+		}
+
+		rep.begin_case("def_startup");
+		rep.param("definitions", def ? "yes" : "no");
+		rep.param("width", def_cfg.width);
+		rep.param("depth", def_cfg.depth);
+		rep.param("options", def_cfg.options);
+		rep.add_rounds(round_ns, allocs, 1);
+		rep.metric("arena_footprint_bytes", (double)footprint);
+		rep.end_case();
+	}
+}
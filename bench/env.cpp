@@ -0,0 +1,115 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// Measures the env source of a run, every option is bound and half of them are set
+static void bench_env_case(int env_cnt, int opt_cnt, const bench_config &cfg, bench_report &rep)
+{
+	std::vector<std::string> names;
+	for (int i = 0; i < env_cnt; i++) {
+		names.push_back(bench_name("BENCH_ENV_", i));
+		setenv(names.back().c_str(), "1", 1);
+	}
+
+	easycmd::command cmd;
+	cmd.with_name("bench")->with_action(bench_noop);
+	for (int i = 0; i < opt_cnt; i++) {
+		// Bound names are spread over the environment, odd ones are not set
+		int idx = (int)((long long)i * env_cnt / opt_cnt);
+		std::string env = i % 2 ? bench_name("BENCH_UNSET_", i) : names[idx];
+		cmd.create_option_int(bench_name("opt", i), "")->with_env(env)->with_default(0);
+	}
+	const char *argv[] = { "bench" };
+
+	const int iterations = 100;
+	easycmd::parse_result res;
+	std::vector<double> round_ns;
+	round_ns.reserve(cfg.rounds);
+	size_t allocs = alloc_count();
+	for (int r = 0; r < cfg.rounds; r++) {
+		bench_clock::time_point beg = bench_clock::now();
+		for (int i = 0; i < iterations; i++) {
+			if (((const easycmd::command&)cmd).run(1, argv, res) != 0) {
+				fprintf(stderr, "run failed: %s\n", res.get_err().c_str());
+				return;
+			}
+		}
+		round_ns.push_back(elapsed_ns(beg));
+	}
+	allocs = alloc_count() - allocs;
+
+	rep.begin_case("env_index");
+	rep.param("env", env_cnt);
+	rep.param("options", opt_cnt);
+	rep.add_rounds(round_ns, allocs, iterations);
+	rep.end_case();
+
+	// One getenv per bound option, as the env source did before the index
+	std::vector<std::string> bound;
+	for (int i = 0; i < opt_cnt; i++) {
+		int idx = (int)((long long)i * env_cnt / opt_cnt);
+		bound.push_back(i % 2 ? bench_name("BENCH_UNSET_", i) : names[idx]);
+	}
+	int found = 0;
+	round_ns.clear();
+	allocs = alloc_count();
+	for (int r = 0; r < cfg.rounds; r++) {
+		bench_clock::time_point beg = bench_clock::now();
+		for (int i = 0; i < iterations; i++) {
+			for (int j = 0; j < opt_cnt; j++) {
+				const char *value = getenv(bound[j].c_str());
+				found += value != NULL ? atoi(value) : 0;
+			}
+		}
+		round_ns.push_back(elapsed_ns(beg));
+	}
+	allocs = alloc_count() - allocs;
+
+	rep.begin_case("env_getenv");
+	rep.param("env", env_cnt);
+	rep.param("options", opt_cnt);
+	rep.add_rounds(round_ns, allocs, iterations);
+	rep.metric("found", (double)found / cfg.rounds / iterations);
+	rep.end_case();
+
+	for (int i = 0; i < env_cnt; i++) {
+		unsetenv(names[i].c_str());
+	}
+}
+
+void bench_env(const bench_config &cfg, bench_report &rep)
+{
+#if !defined(WIN32)
+	const int env_cnts[] = { 100, 1000, 10000 };
+	const int opt_cnts[] = { 16, 256 };
+	for (size_t e = 0; e < sizeof(env_cnts) / sizeof(env_cnts[0]); e++) {
+		for (size_t o = 0; o < sizeof(opt_cnts) / sizeof(opt_cnts[0]); o++) {
+			bench_env_case(env_cnts[e], opt_cnts[o], cfg, rep);
+		}
+	}
+#endif
+}
@@ -0,0 +1,74 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "bench.h"
+
+#include <stdio.h>
+
+// Failing command lines as in batch validation: an unknown option close to the
+// options of the command, read as error code only or as formatted text
+void bench_errors(const bench_config &cfg, bench_report &rep)
+{
+	bench_config flat = cfg;
+	flat.depth = 0;
+	easycmd::command *cmd = build_tree(flat, NULL);
+
+	const char *argv[] = { "bench", "--opt1=1", "--opx2=2", "--opt3=3" };
+	const int argc = sizeof(argv) / sizeof(argv[0]);
+
+	const int iterations = 10000;
+	for (int text = 0; text < 2; text++) {
+		easycmd::parse_result res;
+		std::vector<double> round_ns;
+		round_ns.reserve(cfg.rounds);
+		size_t allocs = alloc_count();
+		size_t bytes = 0;
+		for (int r = 0; r < cfg.rounds; r++) {
+			bench_clock::time_point beg = bench_clock::now();
+			for (int i = 0; i < iterations; i++) {
+				if (((const easycmd::command*)cmd)->run(argc, argv, res) == 0) {
+					fprintf(stderr, "run should fail\n");
+					delete cmd;
+					return;
+				}
+				if (text) {
+					bytes += res.get_err().size();
+				} else {
+					bytes += res.get_error().get_code() == easycmd::ERR_UNKNOWN_OPTION ? 1 : 0;
+				}
+			}
+			round_ns.push_back(elapsed_ns(beg));
+		}
+		allocs = alloc_count() - allocs;
+
+		rep.begin_case("errors");
+		rep.param("options", flat.options);
+		rep.param("text", text ? "yes" : "no");
+		rep.add_rounds(round_ns, allocs, iterations);
+		rep.metric("bytes_per_op", (double)bytes / ((double)iterations * cfg.rounds));
+		rep.end_case();
+	}
+
+	delete cmd;
+}
@@ -0,0 +1,64 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "bench.h"
+
+#include <easycmd/memory_report.h>
+
+// Memory of the synthetic tree with interned names and descs. Every command has
+// the same option names and descs, so they are stored once per arena. Before is
+// the arena without interning, after is the arena as it is.
+void bench_intern(const bench_config &cfg, bench_report &rep)
+{
+	easycmd::memory_report mem;
+	std::vector<double> round_ns;
+	round_ns.reserve(cfg.rounds);
+	size_t allocs = alloc_count();
+	for (int r = 0; r < cfg.rounds; r++) {
+		bench_clock::time_point beg = bench_clock::now();
+		easycmd::command *root = build_tree(cfg, NULL);
+		round_ns.push_back(elapsed_ns(beg));
+		root->get_memory_report(mem);
+		delete root;
+	}
+	allocs = alloc_count() - allocs;
+
+	double cmds = mem.commands > 0 ? (double)mem.commands : 1.0;
+	double opts = mem.options > 0 ? (double)mem.options : 1.0;
+
+	rep.begin_case("intern");
+	rep.param("commands", (double)mem.commands);
+	rep.param("options", (double)mem.options);
+	rep.add_rounds(round_ns, allocs, 1);
+	rep.metric("string_bytes", (double)mem.string_bytes);
+	rep.metric("interned_bytes", (double)mem.interned_bytes);
+	rep.metric("interned_strings", (double)mem.interned_strings);
+	rep.metric("arena_bytes_before", (double)mem.used_without_interning());
+	rep.metric("arena_bytes_after", (double)mem.arena_used);
+	rep.metric("bytes_per_command_before", mem.used_without_interning() / cmds);
+	rep.metric("bytes_per_command_after", mem.arena_used / cmds);
+	rep.metric("bytes_per_option_before", mem.used_without_interning() / opts);
+	rep.metric("bytes_per_option_after", mem.arena_used / opts);
+	rep.end_case();
+}
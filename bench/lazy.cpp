@@ -0,0 +1,100 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "bench.h"
+
+#include <stdio.h>
+
+// Builders have no context, the config of the running case is kept here
+static const bench_config *lazy_cfg = NULL;
+
+static void build_lazy_level(easycmd::command *cmd)
+{
+	int level = 0;
+	for (const easycmd::command *p = cmd->get_parent_cmd(); p != NULL; p = p->get_parent_cmd()) {
+		level++;
+	}
+
+	for (int i = 0; i < lazy_cfg->options; i++) {
+		cmd->create_option_int(bench_name("opt", i), "")
+			->with_desc("Synthetic option")
+			->with_default(0);
+	}
+
+	if (level == lazy_cfg->depth) {
+		cmd->with_action(bench_noop);
+		return;
+	}
+
+	for (int i = 0; i < lazy_cfg->width; i++) {
+		std::string name = bench_name("c", i);
+		cmd->add_sub_cmd(easycmd::command_factory(name.c_str(), "Synthetic command", build_lazy_level));
+	}
+}
+
+// Builds the synthetic tree and runs the synthetic command line once, with all
+// commands created up front and with sub commands added by factories
+void bench_lazy(const bench_config &cfg, bench_report &rep)
+{
+	std::vector<std::string> storage;
+	std::vector<const char*> argv;
+	build_args(cfg, storage, argv);
+
+	lazy_cfg = &cfg;
+	for (int lazy = 0; lazy < 2; lazy++) {
+		std::vector<double> round_ns;
+		round_ns.reserve(cfg.rounds);
+		size_t allocs = 0;
+		size_t footprint = 0;
+		for (int r = 0; r < cfg.rounds; r++) {
+			size_t beg_allocs = alloc_count();
+			bench_clock::time_point beg = bench_clock::now();
+			easycmd::command *root = NULL;
+			if (lazy) {
+				root = new easycmd::command();
+				root->with_name("bench")->with_desc("Synthetic root command");
+				build_lazy_level(root);
+			} else {
+				root = build_tree(cfg, NULL);
+			}
+			easycmd::parse_result res;
+			if (((const easycmd::command*)root)->run((int)argv.size(), &argv[0], res) != 0) {
+				fprintf(stderr, "run failed: %s\n", res.get_err().c_str());
+				delete root;
+				return;
+			}
+			round_ns.push_back(elapsed_ns(beg));
+			allocs += alloc_count() - beg_allocs;
+			footprint = root->get_arena()->footprint();
+			delete root;
+		}
+
+		rep.begin_case("lazy_startup");
+		rep.param("factories", lazy ? "yes" : "no");
+		rep.add_rounds(round_ns, allocs, 1);
+		rep.metric("arena_footprint_bytes", (double)footprint);
+		rep.end_case();
+	}
+	lazy_cfg = NULL;
+}
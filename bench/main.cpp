@@ -0,0 +1,143 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*********************************************************************************
+ * Benchmark suite
+ * Build with -DBUILD_DEBUG=OFF for meaningful numbers. Results are written as 
+ * JSON to stdout or to --output.
+ ********************************************************************************/
+
+#include "bench.h"
+
+#include <stdio.h>
+#include <string.h>
+
+typedef void(*bench_case)(const bench_config&, bench_report&);
+
+struct bench_entry
+{
+	const char *name;
+	bench_case fn;
+};
+
+static const bench_entry bench_cases[] = {
+	{ "build", bench_build },
+	{ "usage", bench_usage },
+	{ "run", bench_run },
+	{ "lookup", bench_option_lookup },
+	{ "tokenizer", bench_tokenizer },
+	{ "response", bench_response_file },
+	{ "getopt", bench_getopt },
+	{ "batch", bench_batch },
+	{ "complete", bench_complete },
+	{ "suggest", bench_suggest },
+	{ "env", bench_env },
+	{ "numeric", bench_numeric },
+	{ "trace", bench_trace },
+	{ "lazy", bench_lazy },
+	{ "schema", bench_schema },
+	{ "errors", bench_errors },
+	{ "intern", bench_intern },
+	{ "scope", bench_scope },
+	{ "daemon", bench_daemon },
+	{ "choice", bench_choice },
+	{ "usage_sink", bench_usage_sink },
+	{ "def", bench_def },
+};
+
+static int run_bench(const easycmd::command *cmd)
+{
+	bench_config cfg;
+	cfg.width = cmd->get_option("width")->get_int();
+	cfg.depth = cmd->get_option("depth")->get_int();
+	cfg.options = cmd->get_option("options")->get_int();
+	cfg.tokens = cmd->get_option("tokens")->get_int();
+	cfg.rounds = cmd->get_option("rounds")->get_int();
+	if (cfg.rounds <= 0) {
+		cfg.rounds = 1;
+	}
+
+	const std::string &only = cmd->get_option("case")->get_string();
+	bench_report rep;
+	for (size_t i = 0; i < sizeof(bench_cases) / sizeof(bench_cases[0]); i++) {
+		if (only.empty() || only == bench_cases[i].name) {
+			bench_cases[i].fn(cfg, rep);
+		}
+	}
+
+	std::string json = rep.to_json(cfg);
+	const std::string &output = cmd->get_option("output")->get_string();
+	if (output.empty()) {
+		fputs(json.c_str(), stdout);
+		return 0;
+	}
+
+	FILE *f = fopen(output.c_str(), "w");
+	if (f == NULL) {
+		fprintf(stderr, "open %s failed\n", output.c_str());
+		return -1;
+	}
+	fputs(json.c_str(), f);
+	fclose(f);
+
+	return 0;
+}
+
+int main(int argc, const char **argv)
+{
+	if (argc > 1 && strcmp(argv[1], "--daemon-child") == 0) {
+		return bench_daemon_child(argc - 2, argv + 2);
+	}
+
+	easycmd::command cmd;
+	cmd.with_name(argv[0])->with_desc("easycmd benchmark suite")->with_action(run_bench);
+	cmd.create_option_int("width", "w")
+		->with_desc("Sub commands per command")
+		->with_default(8);
+	cmd.create_option_int("depth", "d")
+		->with_desc("Levels of sub commands")
+		->with_default(3);
+	cmd.create_option_int("options", "o")
+		->with_desc("Options per command")
+		->with_default(16);
+	cmd.create_option_int("tokens", "t")
+		->with_desc("Option tokens per command line")
+		->with_default(64);
+	cmd.create_option_int("rounds", "r")
+		->with_desc("Measure rounds")
+		->with_default(10);
+	cmd.create_option_string("case", "c")
+		->with_desc("Run only this case: build, usage, run, lookup, tokenizer, response, getopt, batch, complete, suggest, env, numeric, trace, lazy, schema, errors, intern, scope, daemon, choice, usage_sink, def")
+		->with_default("");
+	cmd.create_option_string("output", "f")
+		->with_desc("Write JSON to this file instead of stdout")
+		->with_default("");
+
+	int ret = cmd.run(argc, argv);
+	if (ret != 0) {
+		fprintf(stderr, "%s\n", cmd.get_err().c_str());
+	}
+
+	return ret;
+}
@@ -0,0 +1,126 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "bench.h"
+
+#include <easycmd/number.h>
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Validation of the int option path before the number parser
+static bool legacy_is_int_value(const char *s, size_t len)
+{
+	if (len == 0) {
+		return false;
+	}
+	for (size_t i = 0; i < len; i++) {
+		if (isdigit((unsigned char)s[i]) == 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static void bench_numeric_values(const char *name, 
+								 bool is_float, 
+								 const std::vector<std::string> &values, 
+								 const bench_config &cfg, 
+								 bench_report &rep)
+{
+	for (int engine = 0; engine < 2; engine++) {
+		double sum = 0;
+		int failed = 0;
+		std::vector<double> round_ns;
+		round_ns.reserve(cfg.rounds);
+		size_t allocs = alloc_count();
+		for (int r = 0; r < cfg.rounds; r++) {
+			bench_clock::time_point beg = bench_clock::now();
+			for (size_t i = 0; i < values.size(); i++) {
+				const char *s = values[i].c_str();
+				size_t len = values[i].size();
+				if (engine == 0 && !is_float) {
+					if (legacy_is_int_value(s, len)) {
+						sum += atoi(s);
+					} else {
+						failed++;
+					}
+				} else if (engine == 0) {
+					// The old float check rejected any point, atof is what converted
+					sum += atof(s);
+				} else if (!is_float) {
+					int v = 0;
+					if (easycmd::internal::parse_int(s, len, v) == easycmd::PARSE_OK) {
+						sum += v;
+					} else {
+						failed++;
+					}
+				} else {
+					double v = 0;
+					if (easycmd::internal::parse_double(s, len, v) == easycmd::PARSE_OK) {
+						sum += v;
+					} else {
+						failed++;
+					}
+				}
+			}
+			round_ns.push_back(elapsed_ns(beg));
+		}
+		allocs = alloc_count() - allocs;
+
+		rep.begin_case(name);
+		rep.param("values", (double)values.size());
+		rep.param("engine", engine == 0 ? "legacy" : "parser");
+		rep.add_rounds(round_ns, allocs, (double)values.size());
+		rep.metric("failed", (double)failed / cfg.rounds);
+		rep.metric("checksum", sum / cfg.rounds);
+		rep.end_case();
+	}
+}
+
+void bench_numeric(const bench_config &cfg, bench_report &rep)
+{
+	const int value_cnt = 100000;
+
+	// Short ints like ports and counts, and 9 to 10 digit ints
+	std::vector<std::string> shorts;
+	std::vector<std::string> longs;
+	std::vector<std::string> floats;
+	unsigned seed = 12345;
+	char buf[64];
+	for (int i = 0; i < value_cnt; i++) {
+		seed = seed * 1103515245 + 12345;
+		snprintf(buf, sizeof(buf), "%u", seed % 10000);
+		shorts.push_back(buf);
+		snprintf(buf, sizeof(buf), "%u", 100000000 + seed % 2000000000);
+		longs.push_back(buf);
+		snprintf(buf, sizeof(buf), "%u.%03u", seed % 100000, (seed >> 8) % 1000);
+		floats.push_back(buf);
+	}
+
+	bench_numeric_values("numeric_int_short", false, shorts, cfg, rep);
+	bench_numeric_values("numeric_int_long", false, longs, cfg, rep);
+	bench_numeric_values("numeric_float", true, floats, cfg, rep);
+}
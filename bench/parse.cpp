@@ -0,0 +1,287 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#if !defined(WIN32)
+#include <getopt.h>
+#endif
+
+// Command lines per round are scaled to keep rounds in the millisecond range
+static int run_iterations(int tokens)
+{
+	int n = 200000 / (tokens + 1);
+	return n > 0 ? n : 1;
+}
+
+void bench_run(const bench_config &cfg, bench_report &rep)
+{
+	easycmd::command *root = build_tree(cfg, NULL);
+
+	std::vector<std::string> storage;
+	std::vector<const char*> argv;
+	build_args(cfg, storage, argv);
+
+	// Legacy run keeps values in the tree, the reentrant one fills a parse result
+	for (int reentrant = 0; reentrant < 2; reentrant++) {
+		easycmd::parse_result res;
+		int iterations = run_iterations((int)argv.size());
+		std::vector<double> round_ns;
+		round_ns.reserve(cfg.rounds);
+		size_t allocs = alloc_count();
+		for (int r = 0; r < cfg.rounds; r++) {
+			bench_clock::time_point beg = bench_clock::now();
+			for (int i = 0; i < iterations; i++) {
+				int ret = reentrant ? 
+					((const easycmd::command*)root)->run((int)argv.size(), &argv[0], res) :
+					root->run((int)argv.size(), &argv[0]);
+				if (ret != 0) {
+					fprintf(stderr, "run failed: %s\n", 
+						reentrant ? res.get_err().c_str() : root->get_err().c_str());
+					delete root;
+					return;
+				}
+			}
+			round_ns.push_back(elapsed_ns(beg));
+		}
+		allocs = alloc_count() - allocs;
+
+		rep.begin_case("run");
+		rep.param("argc", (double)argv.size());
+		rep.param("reentrant", reentrant);
+		rep.add_rounds(round_ns, allocs, iterations);
+		rep.end_case();
+	}
+
+	delete root;
+}
+
+void bench_option_lookup(const bench_config &cfg, bench_report &rep)
+{
+	const int opt_cnts[] = { 10, 100, 1000, 4000 };
+	for (size_t c = 0; c < sizeof(opt_cnts) / sizeof(opt_cnts[0]); c++) {
+		bench_config flat = cfg;
+		flat.depth = 0;
+		flat.options = opt_cnts[c];
+		easycmd::command *cmd = build_tree(flat, NULL);
+
+		std::vector<std::string> names;
+		for (int i = 0; i < flat.options; i++) {
+			names.push_back(bench_name("opt", i));
+		}
+
+		std::vector<double> round_ns;
+		round_ns.reserve(cfg.rounds);
+		size_t allocs = alloc_count();
+		int found = 0;
+		for (int r = 0; r < cfg.rounds; r++) {
+			bench_clock::time_point beg = bench_clock::now();
+			for (int i = 0; i < flat.options; i++) {
+				found += cmd->get_option(names[i]) ? 1 : 0;
+			}
+			round_ns.push_back(elapsed_ns(beg));
+		}
+		allocs = alloc_count() - allocs;
+
+		rep.begin_case("option_lookup");
+		rep.param("options", (double)flat.options);
+		rep.add_rounds(round_ns, allocs, flat.options);
+		rep.metric("found", (double)found / cfg.rounds);
+		rep.end_case();
+
+		delete cmd;
+	}
+}
+
+void bench_tokenizer(const bench_config &cfg, bench_report &rep)
+{
+	const int token_cnt = 100000;
+
+	easycmd::command cmd;
+	cmd.with_name("bench")->with_action(bench_noop);
+	cmd.create_option_bool("all", "a")->with_default(false);
+	cmd.create_option_bool("brief", "b")->with_default(false);
+	cmd.create_option_int("maximum-retry-count", "c")->with_default(0);
+	cmd.create_option_string("name", "n")->with_default("");
+
+	for (int with_string = 0; with_string < 2; with_string++) {
+		std::vector<const char*> argv;
+		argv.push_back("bench");
+		while ((int)argv.size() <= token_cnt) {
+			argv.push_back("--all");
+			argv.push_back("-abc");
+			argv.push_back("12");
+			argv.push_back("--maximum-retry-count=34");
+			if (with_string) {
+				argv.push_back("--name");
+				argv.push_back("value");
+			}
+		}
+
+		std::vector<double> round_ns;
+		round_ns.reserve(cfg.rounds);
+		size_t allocs = alloc_count();
+		for (int r = 0; r < cfg.rounds; r++) {
+			bench_clock::time_point beg = bench_clock::now();
+			if (cmd.run((int)argv.size(), &argv[0]) != 0) {
+				fprintf(stderr, "run failed: %s\n", cmd.get_err().c_str());
+				return;
+			}
+			round_ns.push_back(elapsed_ns(beg));
+		}
+		allocs = alloc_count() - allocs;
+
+		rep.begin_case("tokenizer");
+		rep.param("tokens", (double)(argv.size() - 1));
+		rep.param("strings", with_string ? "yes" : "no");
+		rep.add_rounds(round_ns, allocs, (double)(argv.size() - 1));
+		rep.end_case();
+	}
+}
+
+void bench_response_file(const bench_config &cfg, bench_report &rep)
+{
+	const int token_cnt = 100000;
+	const char *path = "bench_response.rsp";
+
+	easycmd::command cmd;
+	cmd.with_name("bench")->with_action(bench_noop)->with_response_files(true);
+	cmd.create_option_bool("all", "a")->with_default(false);
+	cmd.create_option_bool("brief", "b")->with_default(false);
+	cmd.create_option_int("maximum-retry-count", "c")->with_default(0);
+
+	// Same tokens as the tokenizer case, one option per line
+	FILE *f = fopen(path, "w");
+	if (f == NULL) {
+		fprintf(stderr, "create %s failed\n", path);
+		return;
+	}
+	int tokens = 0;
+	fputs("# response file of bench\n", f);
+	while (tokens < token_cnt) {
+		fputs("--all\n-abc 12\n--maximum-retry-count=34\n", f);
+		tokens += 4;
+	}
+	fclose(f);
+
+	std::string arg = std::string("@") + path;
+	const char *argv[] = { "bench", arg.c_str() };
+
+	easycmd::parse_result res;
+	std::vector<double> round_ns;
+	round_ns.reserve(cfg.rounds);
+	size_t allocs = alloc_count();
+	for (int r = 0; r < cfg.rounds; r++) {
+		bench_clock::time_point beg = bench_clock::now();
+		if (((const easycmd::command&)cmd).run(2, argv, res) != 0) {
+			fprintf(stderr, "run failed: %s\n", res.get_err().c_str());
+			remove(path);
+			return;
+		}
+		round_ns.push_back(elapsed_ns(beg));
+	}
+	allocs = alloc_count() - allocs;
+	remove(path);
+
+	rep.begin_case("response_file");
+	rep.param("tokens", tokens);
+	rep.add_rounds(round_ns, allocs, tokens);
+	rep.end_case();
+}
+
+void bench_getopt(const bench_config &cfg, bench_report &rep)
+{
+	if (cfg.options == 0) {
+		return;
+	}
+
+	bench_config flat = cfg;
+	flat.depth = 0;
+	easycmd::command *cmd = build_tree(flat, NULL);
+
+	std::vector<std::string> storage;
+	std::vector<const char*> argv;
+	build_args(flat, storage, argv);
+
+	int iterations = run_iterations((int)argv.size());
+	std::vector<double> round_ns;
+	round_ns.reserve(cfg.rounds);
+	size_t allocs = alloc_count();
+	for (int r = 0; r < cfg.rounds; r++) {
+		bench_clock::time_point beg = bench_clock::now();
+		for (int i = 0; i < iterations; i++) {
+			cmd->run((int)argv.size(), &argv[0]);
+		}
+		round_ns.push_back(elapsed_ns(beg));
+	}
+	allocs = alloc_count() - allocs;
+
+	rep.begin_case("flat_easycmd");
+	rep.param("argc", (double)argv.size());
+	rep.add_rounds(round_ns, allocs, iterations);
+	rep.end_case();
+
+	delete cmd;
+
+#if !defined(WIN32)
+	// Same options and command line through getopt_long, values are converted 
+	// and stored like easycmd does.
+	std::vector<std::string> names;
+	for (int i = 0; i < flat.options; i++) {
+		names.push_back(bench_name("opt", i));
+	}
+	std::vector<struct option> longopts;
+	for (int i = 0; i < flat.options; i++) {
+		struct option o = { names[i].c_str(), required_argument, NULL, 256 + i };
+		longopts.push_back(o);
+	}
+	struct option end = { NULL, 0, NULL, 0 };
+	longopts.push_back(end);
+
+	std::vector<int> values(flat.options, 0);
+	round_ns.clear();
+	allocs = alloc_count();
+	for (int r = 0; r < cfg.rounds; r++) {
+		bench_clock::time_point beg = bench_clock::now();
+		for (int i = 0; i < iterations; i++) {
+			optind = 0;
+			int c;
+			while ((c = getopt_long((int)argv.size(), (char* const*)&argv[0], "", &longopts[0], NULL)) != -1) {
+				if (c >= 256) {
+					values[c - 256] = atoi(optarg);
+				}
+			}
+		}
+		round_ns.push_back(elapsed_ns(beg));
+	}
+	allocs = alloc_count() - allocs;
+
+	rep.begin_case("flat_getopt_long");
+	rep.param("argc", (double)argv.size());
+	rep.add_rounds(round_ns, allocs, iterations);
+	rep.end_case();
+#endif
+}
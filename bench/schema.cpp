@@ -0,0 +1,89 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "bench.h"
+
+#include <easycmd/schema.h>
+
+#include <stdio.h>
+
+// A helper reading the synthetic tree: load the exported schema and find the 
+// dispatched leaf, compared with building the tree in code
+void bench_schema(const bench_config &cfg, bench_report &rep)
+{
+	easycmd::command *root = build_tree(cfg, NULL);
+	std::string data;
+	root->get_schema(data);
+	delete root;
+
+	std::vector<std::string> names;
+	for (int i = 0; i < cfg.depth; i++) {
+		names.push_back(bench_name("c", cfg.width - 1));
+	}
+	std::vector<const char*> path;
+	for (size_t i = 0; i < names.size(); i++) {
+		path.push_back(names[i].c_str());
+	}
+
+	const int iterations = 100;
+	std::vector<double> round_ns;
+	round_ns.reserve(cfg.rounds);
+	size_t allocs = alloc_count();
+	int found = 0;
+	for (int r = 0; r < cfg.rounds; r++) {
+		bench_clock::time_point beg = bench_clock::now();
+		for (int i = 0; i < iterations; i++) {
+			easycmd::schema sc;
+			std::string err;
+			if (!sc.load(data.data(), data.size(), err)) {
+				fprintf(stderr, "load schema failed: %s\n", err.c_str());
+				return;
+			}
+			easycmd::schema_command leaf = sc.find(path.empty() ? NULL : &path[0], path.size());
+			found += leaf.find_option("opt0").valid() ? 1 : 0;
+		}
+		round_ns.push_back(elapsed_ns(beg));
+	}
+	allocs = alloc_count() - allocs;
+
+	rep.begin_case("schema_load_find");
+	rep.add_rounds(round_ns, allocs, iterations);
+	rep.metric("schema_bytes", (double)data.size());
+	rep.metric("found", (double)found / (iterations * cfg.rounds));
+	rep.end_case();
+
+	round_ns.clear();
+	allocs = alloc_count();
+	for (int r = 0; r < cfg.rounds; r++) {
+		bench_clock::time_point beg = bench_clock::now();
+		root = build_tree(cfg, NULL);
+		delete root;
+		round_ns.push_back(elapsed_ns(beg));
+	}
+	allocs = alloc_count() - allocs;
+
+	rep.begin_case("schema_tree_build");
+	rep.add_rounds(round_ns, allocs, 1);
+	rep.end_case();
+}
@@ -0,0 +1,113 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "bench.h"
+
+#include <stdio.h>
+
+// A chain of levels, each with width sub commands and width public sub commands.
+// The command line walks the chain and ends at a public sub command of the root,
+// so every level is searched on the way. Usage of the deepest command lists the
+// public sub commands of all levels.
+void bench_scope(const bench_config &cfg, bench_report &rep)
+{
+	const int levels = 8;
+
+	easycmd::command *root = new easycmd::command();
+	root->with_name("bench")->with_desc("Synthetic root command");
+	easycmd::command *cmd = root;
+	for (int l = 0; l < levels; l++) {
+		for (int i = 0; i < cfg.width; i++) {
+			cmd->create_public_sub_cmd(bench_name(l == 0 ? "root" : "pub", i))
+				->with_desc("Synthetic public command")
+				->with_action(bench_noop);
+		}
+		easycmd::command *next = NULL;
+		for (int i = 0; i < cfg.width; i++) {
+			easycmd::command *sub = cmd->create_sub_cmd(bench_name("c", i));
+			sub->with_desc("Synthetic command")->with_action(bench_noop);
+			next = sub;
+		}
+		cmd = next;
+	}
+
+	std::vector<std::string> storage;
+	storage.push_back("bench");
+	for (int l = 0; l < levels; l++) {
+		storage.push_back(bench_name("c", cfg.width - 1));
+	}
+	storage.push_back(bench_name("root", cfg.width - 1));
+	std::vector<const char*> argv;
+	for (size_t i = 0; i < storage.size(); i++) {
+		argv.push_back(storage[i].c_str());
+	}
+
+	const int iterations = 10000;
+	easycmd::parse_result res;
+	std::vector<double> round_ns;
+	round_ns.reserve(cfg.rounds);
+	size_t allocs = alloc_count();
+	for (int r = 0; r < cfg.rounds; r++) {
+		bench_clock::time_point beg = bench_clock::now();
+		for (int i = 0; i < iterations; i++) {
+			if (((const easycmd::command*)root)->run((int)argv.size(), &argv[0], res) != 0) {
+				fprintf(stderr, "run failed: %s\n", res.get_err().c_str());
+				delete root;
+				return;
+			}
+		}
+		round_ns.push_back(elapsed_ns(beg));
+	}
+	allocs = alloc_count() - allocs;
+
+	rep.begin_case("scope_dispatch");
+	rep.param("levels", levels);
+	rep.param("width", cfg.width);
+	rep.add_rounds(round_ns, allocs, iterations);
+	rep.end_case();
+
+	const int usage_iterations = 1000;
+	size_t bytes = 0;
+	round_ns.clear();
+	allocs = alloc_count();
+	for (int r = 0; r < cfg.rounds; r++) {
+		bench_clock::time_point beg = bench_clock::now();
+		for (int i = 0; i < usage_iterations; i++) {
+			std::string usage;
+			cmd->get_usage(usage);
+			bytes = usage.size();
+		}
+		round_ns.push_back(elapsed_ns(beg));
+	}
+	allocs = alloc_count() - allocs;
+
+	rep.begin_case("scope_usage");
+	rep.param("levels", levels);
+	rep.param("width", cfg.width);
+	rep.add_rounds(round_ns, allocs, usage_iterations);
+	rep.metric("usage_bytes", (double)bytes);
+	rep.end_case();
+
+	delete root;
+}
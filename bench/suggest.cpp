@@ -0,0 +1,85 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "bench.h"
+
+#include <stdio.h>
+
+static void bench_error_path(const char *name, 
+							 const easycmd::command *cmd, 
+							 std::vector<const char*> &argv, 
+							 int entries,
+							 const bench_config &cfg, 
+							 bench_report &rep)
+{
+	const int iterations = 200;
+	easycmd::parse_result res;
+	std::vector<double> round_ns;
+	round_ns.reserve(cfg.rounds);
+	size_t allocs = alloc_count();
+	for (int r = 0; r < cfg.rounds; r++) {
+		bench_clock::time_point beg = bench_clock::now();
+		for (int i = 0; i < iterations; i++) {
+			cmd->run((int)argv.size(), &argv[0], res);
+		}
+		round_ns.push_back(elapsed_ns(beg));
+	}
+	allocs = alloc_count() - allocs;
+
+	rep.begin_case(name);
+	rep.param("entries", entries);
+	rep.param("word", argv.back());
+	rep.add_rounds(round_ns, allocs, iterations);
+	rep.metric("suggested", res.get_err().find("did you mean") != std::string::npos ? 1 : 0);
+	rep.end_case();
+}
+
+void bench_suggest(const bench_config &cfg, bench_report &rep)
+{
+	const int cnts[] = { 100, 1000, 5000 };
+	for (size_t c = 0; c < sizeof(cnts) / sizeof(cnts[0]); c++) {
+		easycmd::command *cmd = new easycmd::command();
+		cmd->with_name("bench");
+		for (int i = 0; i < cnts[c]; i++) {
+			cmd->create_sub_cmd(bench_name("command", i))->with_action(bench_noop);
+		}
+		easycmd::command *leaf = cmd->create_sub_cmd("leaf");
+		leaf->with_action(bench_noop);
+		for (int i = 0; i < cnts[c]; i++) {
+			leaf->create_option_int(bench_name("option", i), "")->with_default(0);
+		}
+
+		// Unknown command and unknown option, each one typo away from a name
+		std::vector<const char*> argv;
+		argv.push_back("bench");
+		argv.push_back("commadn12");
+		bench_error_path("suggest_command", cmd, argv, cnts[c], cfg, rep);
+
+		argv.back() = "leaf";
+		argv.push_back("--optoin12");
+		bench_error_path("suggest_option", cmd, argv, cnts[c], cfg, rep);
+
+		delete cmd;
+	}
+}
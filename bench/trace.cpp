@@ -0,0 +1,94 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "bench.h"
+
+#include <stdio.h>
+
+// Phase timings summed over the traced runs of a round
+static easycmd::run_stats trace_sum;
+
+static void bench_trace_cb(const easycmd::command *cmd, const easycmd::parse_result &res)
+{
+	const easycmd::run_stats &st = res.get_stats();
+	for (int i = 0; i < easycmd::PHASE_COUNT; i++) {
+		trace_sum.phase_ns[i] += st.phase_ns[i];
+	}
+	trace_sum.total_ns += st.total_ns;
+	trace_sum.tokens += st.tokens;
+	trace_sum.option_lookups += st.option_lookups;
+	trace_sum.allocations += st.allocations;
+}
+
+// Same command line as the run case, untraced and traced
+void bench_trace(const bench_config &cfg, bench_report &rep)
+{
+	easycmd::command *root = build_tree(cfg, NULL);
+
+	std::vector<std::string> storage;
+	std::vector<const char*> argv;
+	build_args(cfg, storage, argv);
+
+	const int iterations = 10000;
+	for (int traced = 0; traced < 2; traced++) {
+		root->with_trace(traced ? bench_trace_cb : NULL, traced ? alloc_count : NULL);
+		trace_sum.clear();
+
+		easycmd::parse_result res;
+		std::vector<double> round_ns;
+		round_ns.reserve(cfg.rounds);
+		size_t allocs = alloc_count();
+		for (int r = 0; r < cfg.rounds; r++) {
+			bench_clock::time_point beg = bench_clock::now();
+			for (int i = 0; i < iterations; i++) {
+				if (((const easycmd::command*)root)->run((int)argv.size(), &argv[0], res) != 0) {
+					fprintf(stderr, "run failed: %s\n", res.get_err().c_str());
+					delete root;
+					return;
+				}
+			}
+			round_ns.push_back(elapsed_ns(beg));
+		}
+		allocs = alloc_count() - allocs;
+
+		rep.begin_case("trace");
+		rep.param("argc", (double)argv.size());
+		rep.param("traced", traced ? "yes" : "no");
+		rep.add_rounds(round_ns, allocs, iterations);
+		if (traced) {
+			double runs = (double)iterations * cfg.rounds;
+			for (int i = 0; i < easycmd::PHASE_COUNT; i++) {
+				std::string key = std::string(easycmd::run_stats::phase_name(i)) + "_ns";
+				rep.metric(key.c_str(), trace_sum.phase_ns[i] / runs);
+			}
+			rep.metric("traced_total_ns", trace_sum.total_ns / runs);
+			rep.metric("tokens", trace_sum.tokens / runs);
+			rep.metric("option_lookups", trace_sum.option_lookups / runs);
+			rep.metric("traced_allocs", trace_sum.allocations / runs);
+		}
+		rep.end_case();
+	}
+
+	delete root;
+}
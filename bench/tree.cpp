@@ -0,0 +1,91 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "bench.h"
+
+void bench_build(const bench_config &cfg, bench_report &rep)
+{
+	std::vector<double> build_ns;
+	std::vector<double> teardown_ns;
+	build_ns.reserve(cfg.rounds);
+	teardown_ns.reserve(cfg.rounds);
+	size_t build_allocs = 0;
+	size_t footprint = 0;
+	for (int r = 0; r < cfg.rounds; r++) {
+		size_t allocs = alloc_count();
+		bench_clock::time_point beg = bench_clock::now();
+		easycmd::command *root = build_tree(cfg, NULL);
+		build_ns.push_back(elapsed_ns(beg));
+		build_allocs += alloc_count() - allocs;
+		footprint = root->get_arena()->footprint();
+
+		beg = bench_clock::now();
+		delete root;
+		teardown_ns.push_back(elapsed_ns(beg));
+	}
+
+	rep.begin_case("tree_build");
+	rep.add_rounds(build_ns, build_allocs, 1);
+	rep.metric("arena_footprint_bytes", (double)footprint);
+	rep.end_case();
+
+	rep.begin_case("tree_teardown");
+	rep.add_rounds(teardown_ns, 0, 1);
+	rep.end_case();
+}
+
+static void bench_usage_of(const char *name, const easycmd::command *cmd, const bench_config &cfg, bench_report &rep)
+{
+	const int iterations = 100;
+	std::vector<double> round_ns;
+	round_ns.reserve(cfg.rounds);
+	size_t allocs = alloc_count();
+	size_t bytes = 0;
+	for (int r = 0; r < cfg.rounds; r++) {
+		bench_clock::time_point beg = bench_clock::now();
+		for (int i = 0; i < iterations; i++) {
+			std::string usage;
+			cmd->get_usage(usage);
+			bytes = usage.size();
+		}
+		round_ns.push_back(elapsed_ns(beg));
+	}
+	allocs = alloc_count() - allocs;
+
+	rep.begin_case(name);
+	rep.add_rounds(round_ns, allocs, iterations);
+	rep.metric("usage_bytes", (double)bytes);
+	rep.end_case();
+}
+
+void bench_usage(const bench_config &cfg, bench_report &rep)
+{
+	easycmd::command *leaf = NULL;
+	easycmd::command *root = build_tree(cfg, &leaf);
+
+	bench_usage_of("usage_root", root, cfg, rep);
+	bench_usage_of("usage_leaf", leaf, cfg, rep);
+
+	delete root;
+}
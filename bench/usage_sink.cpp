@@ -0,0 +1,91 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "bench.h"
+
+#include <easycmd/usage_writer.h>
+
+#include <stdio.h>
+#if !defined(WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Usage of a command with many options written out to /dev/null: built in a string
+// and copied out with fwrite as print_usage did, against streamed to the file 
+// descriptor by the usage writer
+void bench_usage_sink(const bench_config &cfg, bench_report &rep)
+{
+#if !defined(WIN32)
+	const int opt_cnts[] = { 100, 1000 };
+	const int iterations = 20;
+
+	FILE *null_file = fopen("/dev/null", "w");
+	if (null_file == NULL) {
+		fprintf(stderr, "open /dev/null failed\n");
+		return;
+	}
+	int null_fd = fileno(null_file);
+
+	for (size_t c = 0; c < sizeof(opt_cnts) / sizeof(opt_cnts[0]); c++) {
+		easycmd::command cmd;
+		cmd.with_name("bench")->with_desc("Usage of many options");
+		for (int i = 0; i < opt_cnts[c]; i++) {
+			cmd.create_option_int(bench_name("opt", i), "")
+				->with_desc("Description of the option, long enough to be like real ones")
+				->with_default(i);
+		}
+
+		for (int stream = 0; stream < 2; stream++) {
+			std::vector<double> round_ns;
+			round_ns.reserve(cfg.rounds);
+			size_t allocs = alloc_count();
+			for (int r = 0; r < cfg.rounds; r++) {
+				bench_clock::time_point beg = bench_clock::now();
+				for (int i = 0; i < iterations; i++) {
+					if (stream) {
+						easycmd::usage_writer w(null_fd);
+						cmd.write_usage(w, -1);
+					} else {
+						std::string usage;
+						cmd.get_usage(usage);
+						fwrite(usage.data(), 1, usage.size(), null_file);
+						fflush(null_file);
+					}
+				}
+				round_ns.push_back(elapsed_ns(beg));
+			}
+			allocs = alloc_count() - allocs;
+
+			rep.begin_case("usage_sink");
+			rep.param("options", opt_cnts[c]);
+			rep.param("sink", stream ? "fd" : "string");
+			rep.add_rounds(round_ns, allocs, iterations);
+			rep.end_case();
+		}
+	}
+
+	fclose(null_file);
+#endif
+}
@@ -0,0 +1,104 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "choice.h"
+
+namespace easycmd {
+
+    namespace internal {
+
+        // Seeds tried for a slot count before the count is doubled
+        static const uint32_t max_seeds = 256;
+
+        choice_table::choice_table()
+          : values_(NULL),
+            lens_(NULL),
+            cnt_(0),
+            slots_(NULL),
+            mask_(0),
+            seed_(0) {
+        }
+
+        void choice_table::build(arena *a, const char *const *values, size_t cnt) {
+            cnt_ = cnt;
+            if (cnt == 0) {
+                return;
+            }
+
+            values_ = (const char**)a->allocate(sizeof(const char*) * cnt);
+            lens_ = (uint32_t*)a->allocate(sizeof(uint32_t) * cnt, alignof(uint32_t));
+            for (size_t i = 0; i < cnt; i++) {
+                lens_[i] = (uint32_t)strlen(values[i]);
+                values_[i] = a->intern(values[i], lens_[i]);
+            }
+
+            // Start with the smallest power of 2 holding all values, a few values
+            // always fit with some seed before the slot count grows far
+            uint32_t slot_cnt = 1;
+            while (slot_cnt < cnt) {
+                slot_cnt *= 2;
+            }
+            for (;; slot_cnt *= 2) {
+                slots_ = (int*)a->allocate(sizeof(int) * slot_cnt, alignof(int));
+                for (uint32_t seed = 0; seed < max_seeds; seed++) {
+                    if (__place(seed, slot_cnt - 1)) {
+                        mask_ = slot_cnt - 1;
+                        seed_ = seed;
+                        return;
+                    }
+                }
+            }
+        }
+
+        bool choice_table::__place(uint32_t seed, uint32_t mask) {
+            for (uint32_t i = 0; i <= mask; i++) {
+                slots_[i] = -1;
+            }
+            for (size_t i = 0; i < cnt_; i++) {
+                int &slot = slots_[__hash(values_[i], lens_[i], seed) & mask];
+                if (slot < 0) {
+                    slot = (int)i;
+                } else if (lens_[slot] != lens_[i] || memcmp(values_[slot], values_[i], lens_[i]) != 0) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        void choice_table::join(const char *sep, std::string &des) const {
+            for (size_t i = 0; i < cnt_; i++) {
+                // Repeated values are shown once
+                if (find(values_[i], lens_[i]) != (int)i) {
+                    continue;
+                }
+                if (i > 0) {
+                    des.append(sep);
+                }
+                des.append(values_[i]);
+            }
+        }
+
+    }
+
+}
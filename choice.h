@@ -0,0 +1,129 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef easycmd_choice_h
+#define easycmd_choice_h
+
+#include <string>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "arena.h"
+
+namespace easycmd {
+
+    namespace internal {
+
+        /*********************************************************************************
+         * Choice table
+         * Maps the accepted values of a choice option to their ids, the position in the
+         * declared values. A seed is searched at build so that the values hash to 
+         * distinct slots, then a lookup is one hash and one compare. Everything is
+         * stored in the arena of the option.
+         ********************************************************************************/
+        class choice_table
+        {
+        public:
+            /*********************************************************************************
+             * Constructor
+             ********************************************************************************/
+            choice_table();
+
+            /*********************************************************************************
+             * Build table
+             * A repeated value keeps the id of its first one.
+             ********************************************************************************/
+            void build(arena *a, const char *const *values, size_t cnt);
+
+            /*********************************************************************************
+             * Find id of value
+             * Return -1 if the value is not accepted.
+             ********************************************************************************/
+            int find(const char *value, size_t len) const {
+                if (cnt_ == 0) {
+                    return -1;
+                }
+                int id = slots_[__hash(value, len, seed_) & mask_];
+                if (id < 0 || lens_[id] != len || memcmp(values_[id], value, len) != 0) {
+                    return -1;
+                }
+                return id;
+            }
+
+            /*********************************************************************************
+             * Get value of id
+             * Return empty string if id is out of range.
+             ********************************************************************************/
+            const char* get(int id) const {
+                return id >= 0 && (size_t)id < cnt_ ? values_[id] : "";
+            }
+
+            /*********************************************************************************
+             * Get count of values
+             ********************************************************************************/
+            size_t size() const {
+                return cnt_;
+            }
+
+            /*********************************************************************************
+             * Append values separated by sep
+             ********************************************************************************/
+            void join(const char *sep, std::string &des) const;
+
+        private:
+            /*********************************************************************************
+             * Hash value with seed
+             ********************************************************************************/
+            static uint32_t __hash(const char *value, size_t len, uint32_t seed) {
+                // FNV-1a from a seeded basis, the high bits are folded in for the mask
+                uint32_t h = 2166136261u ^ (seed * 0x9e3779b9u);
+                for (size_t i = 0; i < len; i++) {
+                    h = (h ^ (unsigned char)value[i]) * 16777619u;
+                }
+                return h ^ (h >> 16);
+            }
+
+            /*********************************************************************************
+             * Try to place values in slots with seed
+             ********************************************************************************/
+            bool __place(uint32_t seed, uint32_t mask);
+
+        private:
+            // Values and their lengths, indexed by id
+            const char **values_;
+            uint32_t *lens_;
+            size_t cnt_;
+
+            // Slots hold ids, -1 for empty, the count is a power of 2
+            int *slots_;
+            uint32_t mask_;
+            uint32_t seed_;
+        };
+
+    }
+
+}
+
+#endif
@@ -23,133 +23,134 @@
  */
  
 #include "command.h"
+#include "tokenizer.h"
+#include "completion.h"
+#include "config_file.h"
+#include "memory_report.h"
 
+#include <ctype.h>
 #include <stdarg.h>
+#include <algorithm>
 
 namespace easycmd {
 
-    namespace internal
-    {
-        bool is_command_arg(const char *arg) {
-            int len = (int)strlen(arg);
-            for (int i = 0; i < len; i++) {
-                if (isalpha(arg[i++]) == 0) {
-                    return false;
-                }
-            }
-            return true;
-        }
+    // Source of scope generations, a changed command takes the next one, so the
+    // generation of a scope only grows
+    static std::atomic<unsigned> scope_generation(0);
 
-        bool is_option_arg(const char *arg){
-            if (strlen(arg) < 2 || 
-                strncmp(arg, "-", 1) != 0) {
-                return false;
-            }
-            return true;
+    command::command()
+      : command(NULL, NULL) {
+    }
+
+    command::command(const command_def *def)
+      : command(NULL, def) {
+    }
+
+    command::command(arena *a, const command_def *def)
+      : arena_(a),
+        own_arena_(false),
+        in_arena_(a != NULL),
+        name_(""),
+        desc_(""),
+        env_prefix_(""),
+        def_(def),
+        def_sub_cmds_(NULL),
+        def_public_sub_cmds_(NULL),
+        parent_cmd_(NULL),
+        action_cb_(NULL),
+        result_action_cb_(NULL),
+        async_action_cb_(NULL),
+        timeout_ms_(0),
+        response_files_(false),
+        completion_(false),
+        trace_cb_(NULL),
+        alloc_counter_(NULL),
+        config_(NULL),
+        typed_size_(0),
+        completion_trie_(NULL),
+        completion_trie_stale_(false),
+        scope_generation_(0),
+        scope_table_(NULL),
+        usage_layout_(NULL),
+        usage_layout_stale_(false) {
+        if (arena_ == NULL) {
+            arena_ = new arena();
+            own_arena_ = true;
         }
 
-        bool is_long_option_arg(const char *arg) {
-            if (strlen(arg) < 3 ||
-                strncmp(arg, "--", 2) != 0 || 
-                isalpha(arg[2]) == 0) {
-                return false;
-            }
-            return true;
+        if (def_ == NULL) {
+            return;
         }
 
-        bool is_short_option_arg(const char *arg) {
-            if (strlen(arg) < 2 ||
-                strncmp(arg, "-", 1) != 0 ||
-                isalpha(arg[1]) == 0) {
-                return false;
+        // Strings of static definition are used in place
+        name_ = def->name;
+        desc_ = def->desc;
+        action_cb_ = def->action;
+
+        // Slots of sub commands, they are filled on demand
+        if (def->sub_cmd_count > 0) {
+            def_sub_cmds_ = (std::atomic<command*>*)arena_->allocate(
+                sizeof(std::atomic<command*>) * def->sub_cmd_count, 
+                alignof(std::atomic<command*>));
+            for (int i = 0; i < def->sub_cmd_count; i++) {
+                new (&def_sub_cmds_[i]) std::atomic<command*>(NULL);
             }
-            return true;
         }
-
-        bool is_short_option(const char c) {
-            if (isalpha(c) == 0) {
-                return false;
+        if (def->public_sub_cmd_count > 0) {
+            def_public_sub_cmds_ = (std::atomic<command*>*)arena_->allocate(
+                sizeof(std::atomic<command*>) * def->public_sub_cmd_count, 
+                alignof(std::atomic<command*>));
+            for (int i = 0; i < def->public_sub_cmd_count; i++) {
+                new (&def_public_sub_cmds_[i]) std::atomic<command*>(NULL);
             }
-            return true;
         }
 
-        bool is_int_value(const std::string &value) {
-            int len = (int)value.size();
-            if (len == 0) {
-                return false;
+        for (int i = 0; i < def->option_count; i++) {
+            const option_def &od = def->options[i];
+            if (od.long_name[0] == 0 && od.short_name[0] == 0) {
+                continue;
             }
-
-            const char *p = value.c_str();
-            for (int i = 0; i < len; i++) {
-                if (isdigit(p[i]) == 0) {
-                    return false;
-                }
+            if (__find_option(od.long_name, od.short_name)) {
+                continue;
             }
 
-            return true;
-        }
-
-        bool is_float_value(const std::string &value) {
-            int len = (int)value.size();
-            if (len == 0) {
-                return false;
+            option *opt = __add_option(od.type, od.long_name, od.short_name);
+            opt->env_ = od.env;
+            opt->desc_ = od.desc;
+            if (od.type == internal::OP_TYPE_CHOICE) {
+                opt->__set_choices(od.choices, (size_t)od.choice_count);
             }
-
-            int point_cnt = 0;
-            const char *p = value.c_str();
-            for (int i = 0; i < len; i++) {
-                if (p[i] == '.') {
-                    if (i == 0 || point_cnt > 0) {
-                        return false;
-                    }
-                    point_cnt++;
-                }
-                if (isdigit(p[i]) == 0) {
-                    return false;
-                }
+            if (od.required) {
+                continue;
             }
 
-            return true;
-        }
-
-        bool parse_option_name(bool is_short_option, const char *arg, std::string &name, std::string &value) {
-            int len = (int)strlen(arg);
-            int beg = is_short_option ? 1 : 2;
-            for (int i = beg; i < len; i++) {
-                if (arg[i] == '=') {
-                    if (is_short_option || i + 1 == len) {
-                        return false;
-                    }
-                    value.assign(arg + i + 1);
-                    break;
+            if (od.type == internal::OP_TYPE_BOOL) {
+                opt->with_default(od.b);
+            } else if (od.type == internal::OP_TYPE_INT) {
+                opt->with_default(od.i);
+            } else if (od.type == internal::OP_TYPE_FLOAT) {
+                opt->with_default(od.f);
+            } else if (od.type == internal::OP_TYPE_STRING) {
+                opt->with_default(od.s);
+            } else if (od.type == internal::OP_TYPE_CHOICE) {
+                if (od.s[0] != 0) {
+                    opt->with_default(od.s);
+                } else {
+                    opt->with_default(od.i);
                 }
-                name.append(1, arg[i]);
             }
-
-            return !name.empty();
         }
-
-        int get_system_env(const char *name, std::string &value) {
-            const char *tmp = getenv(name);
-            if (tmp == NULL) {
-                return -1;
-            }
-            value.assign(tmp);
-            return (int)value.size();
-        }
-    }
-
-    command::command()
-      : parent_cmd_(NULL),
-        action_cb_(NULL) {
     }
 
     command::~command() {
+        // Sub commands and options placed in the arena are destroyed with the arena.
         {
-            // Free all sub commands
+            // Free all public sub commands
             command_map::iterator beg = public_sub_cmds_.begin();
             for (; beg != public_sub_cmds_.end(); beg++) {
-                delete beg->second;
+                if (!beg->second->in_arena_) {
+                    delete beg->second;
+                }
             }
         }
 
@@ -157,274 +158,601 @@ namespace easycmd {
             // Free all sub commands
             command_map::iterator beg = sub_cmds_.begin();
             for (; beg != sub_cmds_.end(); beg++) {
-                delete beg->second;
+                if (!beg->second->in_arena_) {
+                    delete beg->second;
+                }
             }
         }
-        
-        // Free all options
-        for (int i = 0; i < (int)options_.size(); i++) {
-            delete options_[i];
+
+        delete config_;
+
+        if (own_arena_) {
+            delete arena_;
         }
     }
 
+    int command::load_config_file(const std::string &path) {
+        internal::config_file *config = new internal::config_file();
+        if (!config->open(path, err_)) {
+            delete config;
+            return -1;
+        }
+
+        delete config_;
+        config_ = config;
+
+        return 0;
+    }
+
     void command::add_sub_cmd(command *sub) {
         command_map::iterator it = sub_cmds_.find(sub->name_);
         if (it != sub_cmds_.end()) {
-            delete it->second;
+            if (!it->second->in_arena_) {
+                delete it->second;
+            }
             sub_cmds_.erase(it);
         }
 
         sub_cmds_[sub->name_] = sub;
+        __remove_lazy_sub_cmd(sub->name_, lazy_sub_cmds_);
 
         sub->parent_cmd_ = this;
+        sub->__change_scope();
+
+        completion_trie_stale_.store(true);
+        __change_scope();
     }
 
     void command::add_public_sub_cmd(command *gsub) {
         command_map::iterator it = public_sub_cmds_.find(gsub->name_);
         if (it != public_sub_cmds_.end()) {
-            delete it->second;
+            if (!it->second->in_arena_) {
+                delete it->second;
+            }
             public_sub_cmds_.erase(it);
         }
         public_sub_cmds_[gsub->name_] = gsub;
+        __remove_lazy_sub_cmd(gsub->name_, lazy_public_sub_cmds_);
+
+        gsub->parent_cmd_ = this;
+        gsub->__change_scope();
+
+        completion_trie_stale_.store(true);
+        __change_scope();
     }
 
-    void command::get_usage(std::string &des) const {
-        if (!desc_.empty()) {
-            des.append("\n").append(desc_).append("\n");
-        }
+    void command::add_sub_cmd(const command_factory &factory) {
+        __add_lazy_sub_cmd(factory, sub_cmds_, lazy_sub_cmds_);
+    }
+
+    void command::add_public_sub_cmd(const command_factory &factory) {
+        __add_lazy_sub_cmd(factory, public_sub_cmds_, lazy_public_sub_cmds_);
+    }
+
+    command* command::create_sub_cmd(const std::string &name) {
+        command *sub = arena_->create<command>(arena_, (const command_def*)NULL);
+        sub->with_name(name);
+        add_sub_cmd(sub);
+        return sub;
+    }
+
+    command* command::create_public_sub_cmd(const std::string &name) {
+        command *gsub = arena_->create<command>(arena_, (const command_def*)NULL);
+        gsub->with_name(name);
+        add_public_sub_cmd(gsub);
+        return gsub;
+    }
 
-        command_map sub_cmds = sub_cmds_;
-        __get_public_sub_cmds(sub_cmds);
-        for (command_map::const_iterator beg = sub_cmds.begin(); beg != sub_cmds.end(); beg++) {
-            if (beg->second == this) {
-                sub_cmds.erase(beg);
-                break;
+    const command* command::get_parent_cmd() const {
+        const parse_result *res = internal::get_active_result();
+        if (res) {
+            const command *parent = res->get_parent_cmd(this);
+            if (parent) {
+                return parent;
             }
         }
+        return parent_cmd_;
+    }
 
-        std::string path = __get_cmd_path();
-        des.append("\nUsage:\n  ").append(path);
-        if (!sub_cmds.empty()) {
-            des.append(" [COMMAND]");
-        }
-        if (!options_.empty()) {
-            des.append(" [OPTIONS]");
+    int command::run(int argc, const char **argv) {
+        // Shell completion scripts call the program with __complete
+        if (completion_ && argc > 1 && strcmp(argv[1], "__complete") == 0) {
+            last_res_.clear();
+            err_.clear();
+            return __print_completion(argc - 1, argv + 1);
         }
-        des.append("\n");
 
-        if (!sub_cmds.empty()) {
-            std::string sub_cmds_desc;
-            sub_cmds_desc.append("COMMANDS: \n");
-            for (command_map::const_iterator beg = sub_cmds.begin(); beg != sub_cmds.end(); beg++) {
-                int space_len = (int)(32 - 4 - beg->second->name_.size());
-                sub_cmds_desc
-                    .append("    ")
-                    .append(beg->second->name_)
-                    .append(space_len, ' ').append(beg->second->desc_)
-                    .append("\n");
+        // The error text of the run is formatted when get_err() is called
+        parse_result &res = last_res_;
+        int ret = run(argc, argv, res);
+        err_.clear();
+
+        // Keep values in options for reading after run
+        if (res.cmd_) {
+            for (size_t i = 0; i < res.cmd_->options_.size(); i++) {
+                option *opt = res.cmd_->options_[i];
+                opt->val_ = res.values_[i];
+                if (opt->typed_) {
+                    memcpy(opt->typed_->last, res.__typed_value(opt), opt->typed_->size);
+                }
             }
-            des.append("\n").append(sub_cmds_desc);
         }
 
-        if (!options_.empty()) {
-            std::string options_desc;
-            options_desc.append("OPTIONS: \n");
-            for (option_vector::const_iterator beg = options_.begin(); beg != options_.end(); beg++) {
-                option *opt = (option*)(*beg);
+        return ret;
+    }
 
-                int space_len = 32 - 4;
-                options_desc.append("    ");
+    int command::run(int argc, const char **argv, parse_result &res) const {
+        res.clear();
+        return __trace_run(argc, argv, res);
+    }
 
-                if (!opt->short_name_.empty()) {
-                    options_desc.append("-").append(opt->short_name_);
-                    space_len -= (1 + (int)opt->short_name_.size());
-                }
-                if (!opt->long_name_.empty()) {
-                    if (!opt->short_name_.empty()) {
-                        options_desc.append(", ");
-                        space_len -= 2;
-                    }
-                    options_desc.append("--").append(opt->long_name_);
-                    space_len -= (2 + (int)opt->long_name_.size());
-                }
-                options_desc.append(space_len, ' ');
-                
-                if (opt->required_) {
-                    options_desc.append("[Required] ");
-                } else {
-                    options_desc.append("[Optional] ");
-                }
-                options_desc.append(opt->desc_).append("\n");
-            }
-            des.append("\n").append(options_desc);
-        }
+    int command::run(int argc, const char **argv, parse_result &res, cancel_token &token) const {
+        res.clear();
+        res.token_ = &token;
+        return __trace_run(argc, argv, res);
     }
 
-    void command::print_usage() const {
-        std::string usage;
-        get_usage(usage);
-        printf("%s", usage.c_str());
+    int command::__trace_run(int argc, const char **argv, parse_result &res) const {
+        if (trace_cb_ == NULL) {
+            res.stats_.ret = __run(argc, argv, res);
+            return res.stats_.ret;
+        }
+
+        size_t allocs = alloc_counter_ ? alloc_counter_() : 0;
+        uint64_t beg = internal::trace_clock_ns();
+        res.trace_ = true;
+        res.trace_mark_ = beg;
+        res.stats_.ret = __run(argc, argv, res);
+        res.stats_.total_ns = internal::trace_clock_ns() - beg;
+        if (alloc_counter_) {
+            res.stats_.allocations = alloc_counter_() - allocs;
+        }
+        trace_cb_(this, res);
+
+        return res.stats_.ret;
     }
 
-    int command::run(int argc, const char **argv) {
+    int command::__run(int argc, const char **argv, parse_result &res) const {
         if (argc <= 0) {
-            __set_error(this, "no arguments");
+            __set_error(res, ERR_NO_ARGUMENTS);
             return -1;
         }
-        return __run_cmd(argv, argc, 1);
+
+        // Args of response files point into the files kept by the result
+        if (response_files_ && internal::has_response_file(argc, argv)) {
+            std::string err;
+            if (!internal::expand_response_files(argc, argv, res.args_, res.files_, err)) {
+                __set_error(res, ERR_RESPONSE_FILE).text_ = err;
+                return -1;
+            }
+            argc = (int)res.args_.size();
+            argv = &res.args_[0];
+        }
+        res.argv_ = argv;
+        res.__trace(PHASE_EXPAND);
+
+        return __run_cmd(argv, argc, 1, res);
     }
 
     option* command::__create_option(internal::option_type ot, 
                                      const std::string& long_name, 
                                      const std::string& short_name) {
-        if (long_name.empty() && short_name.empty()) {
+        if (!__check_option_names(long_name, short_name)) {
             return nullptr;
         }
-        if (__find_option(long_name, short_name)) {
-            return nullptr;
+
+        return __add_option(ot, 
+                            arena_->intern(long_name.data(), long_name.size()), 
+                            arena_->intern(short_name.data(), short_name.size()));
+    }
+
+    bool command::__check_option_names(const std::string &long_name, 
+                                       const std::string &short_name) const {
+        if (long_name.empty() && short_name.empty()) {
+            return false;
         }
+        return __find_option(long_name.c_str(), short_name.c_str()) == nullptr;
+    }
 
-        option *opt =  new option(ot, long_name, short_name);
-        options_.push_back(opt);
+    internal::typed_value* command::__add_typed_value(size_t size, size_t align) {
+        internal::typed_value *tv = arena_->create<internal::typed_value>();
+        tv->parse = NULL;
+        tv->size = size;
+        tv->offset = (typed_size_ + align - 1) / align * align;
+        tv->def = arena_->allocate(size, align);
+        tv->last = arena_->allocate(size, align);
+        typed_size_ = tv->offset + size;
+        return tv;
+    }
 
+    option* command::__add_option(internal::option_type ot, 
+                                  const char *long_name, 
+                                  const char *short_name) {
+        option *opt = arena_->create<option>(arena_, this, (int)options_.size(), ot, long_name, short_name);
+        __register_option(opt);
         return opt;
     }
 
-    option* command::__find_option(const std::string& long_name,
-                                   const std::string& short_name) const {
-        for (int i = 0; i < (int)options_.size(); i++) {
-            if (!long_name.empty()) {
-                if (options_[i]->long_name_ == long_name) {
-                    return options_[i];
-                }
-            }
-            if (!short_name.empty()) {
-                if (options_[i]->short_name_ == short_name) {
-                    return options_[i];
-                }
+    void command::__register_option(option *opt) {
+        options_index_.add(opt->long_name_, opt->short_name_, (int)options_.size());
+        options_.push_back(opt);
+        completion_trie_stale_.store(true);
+        usage_layout_stale_.store(true);
+    }
+
+    option* command::__find_option(const char *long_name,
+                                   const char *short_name) const {
+        int lpos = options_index_.find_long(long_name, strlen(long_name));
+        int spos = options_index_.find_short(short_name, strlen(short_name));
+        if (lpos < 0 || (spos >= 0 && spos < lpos)) {
+            lpos = spos;
+        }
+        return lpos < 0 ? nullptr : options_[lpos];
+    }
+
+    option* command::__find_option(const char *name, size_t len) const {
+        int pos = options_index_.find(name, len);
+        return pos < 0 ? nullptr : options_[pos];
+    }
+
+    positional* command::__create_positional(const std::string &name, bool tail) {
+        if (name.empty()) {
+            return nullptr;
+        }
+        for (size_t i = 0; i < positionals_.size(); i++) {
+            if (positionals_[i]->tail_ || name == positionals_[i]->name_) {
+                return nullptr;
             }
         }
-        return nullptr;
+
+        positional *pos = arena_->create<positional>(arena_, 
+                                                     arena_->intern(name.data(), name.size()), 
+                                                     tail);
+        positionals_.push_back(pos);
+        usage_layout_stale_.store(true);
+        return pos;
+    }
+
+    operand_range command::get_operands() const {
+        const parse_result *res = __get_result();
+        return res ? res->get_operands() : operand_range();
     }
 
-    int command::__run_cmd(const char **argv, int argc, int arg_idx) {
-        // If no more args, the command should be handled.
-        if (arg_idx >= argc) {
-            return __handle_cmd();
+    operand_range command::get_operands(const std::string &name) const {
+        const parse_result *res = __get_result();
+        return res ? res->get_operands(name) : operand_range();
+    }
+
+    const char* command::get_positional(const std::string &name) const {
+        const parse_result *res = __get_result();
+        return res ? res->get_positional(name) : NULL;
+    }
+
+    const parse_result* command::__get_result() const {
+        const parse_result *res = internal::get_active_result();
+        if (res && res->cmd_ == this) {
+            return res;
+        }
+
+        const command *root = this;
+        while (root->parent_cmd_) {
+            root = root->parent_cmd_;
+        }
+        if (root->last_res_.cmd_ == this) {
+            return &root->last_res_;
         }
 
+        return NULL;
+    }
+
+    bool command::__add_operand(const char **arg, parse_result &res) const {
+        if (res.operand_cnt_ >= positionals_.size() && !positionals_.back()->tail_) {
+            __set_error(res, ERR_UNEXPECTED_ARGUMENT, arg);
+            return false;
+        }
+        res.operand_cnt_++;
+        return true;
+    }
+
+    bool command::__takes_next(const internal::arg_token &tok, const internal::arg_token &next) const {
+        if (internal::is_option_token(next)) {
+            return false;
+        }
+        if (positionals_.empty()) {
+            return true;
+        }
+
+        // A bool option would swallow an operand, so it only takes literal values
+        const option *opt = NULL;
+        if (tok.type == internal::ARG_LONG_OPTION) {
+            opt = __find_option(tok.name.data, tok.name.size);
+        } else if (tok.type == internal::ARG_SHORT_OPTION && !tok.name.empty()) {
+            opt = __find_option(tok.name.data + tok.name.size - 1, 1);
+        }
+        if (opt == NULL || opt->type_ != internal::OP_TYPE_BOOL) {
+            return true;
+        }
+        return next.name.equal("true", 4) || next.name.equal("TRUE", 4) ||
+               next.name.equal("false", 5) || next.name.equal("FALSE", 5);
+    }
+
+    int command::__run_cmd(const char **argv, int argc, int arg_idx, parse_result &res) const {
+        __enter_path(res);
+
         // The next arg is command
-        if (internal::is_command_arg(argv[arg_idx])) {
-            command *sub = NULL;
-            std::string name(argv[arg_idx]);
-            command_map::iterator it = sub_cmds_.find(name);
-            if (it != sub_cmds_.end()) {
-                sub = it->second;
-            }
-
-            if (sub == NULL) {
-                sub = __get_public_sub_cmd(name);
-                if (!sub) {
-                    __set_error(this, "no found command: %s\n", name.c_str());
-                    return -1;
-                }
-                sub->parent_cmd_ = this;
+        internal::arg_token tok;
+        if (arg_idx < argc) {
+            internal::tokenize_arg(argv[arg_idx], tok);
+            res.stats_.tokens++;
+        }
+        if (arg_idx < argc && tok.type == internal::ARG_COMMAND) {
+            const command *sub = __dispatch_sub_cmd(argv[arg_idx], res);
+            if (sub) {
+                return sub->__run_cmd(argv, argc, arg_idx + 1, res);
             }
 
-            return sub->__run_cmd(argv, argc, arg_idx + 1);
-        } else { 
-            // Try to setup options from system env.
-            __setup_options_from_env();
-
-            // Try to setup options from args
-            if (!__setup_options_from_args(argv + arg_idx, argc - arg_idx)) {
+            // Without positional arguments, the arg must be a command
+            if (positionals_.empty()) {
+                run_error &e = __set_error(res, ERR_UNKNOWN_COMMAND, argv + arg_idx);
+                e.name_ = internal::string_ref(argv[arg_idx]);
                 return -1;
             }
+        }
+
+        res.cmd_ = this;
+        res.cmd_argv_ = argv + arg_idx;
+        res.cmd_argc_ = argc - arg_idx;
+
+        res.__trace(PHASE_DISPATCH);
+
+        // Start from default values
+        __reset_options(res);
+        res.__trace(PHASE_DEFAULTS);
+
+        // Try to setup options from config file
+        bool ok = __setup_options_from_config(res);
+        res.__trace(PHASE_CONFIG);
+        if (!ok) {
+            return -1;
+        }
+
+        // Try to setup options from system env.
+        __setup_options_from_env(res);
+        res.__trace(PHASE_ENV);
 
-            // handle command
-            return __handle_cmd();
+        // Try to setup options from args
+        ok = __setup_options_from_args(argv + arg_idx, argc - arg_idx, res);
+        res.__trace(PHASE_ARGS);
+        if (!ok) {
+            return -1;
         }
 
-        return -1;
+        // handle command
+        return __handle_cmd(res);
     }
 
-    int command::__handle_cmd() {
-        for (option_vector::iterator beg = options_.begin(); beg != options_.end(); beg++) {
-            option *opt = (option*)(*beg);
-            if (!opt->found_value_ && opt->required_) {
-                if (!opt->long_name_.empty()) {
-                    __set_error(this, "option --%s required\n", (*beg)->long_name_.c_str());
-                } else {
-                    __set_error(this, "option -%s required\n", (*beg)->short_name_.c_str());
-                }
+    int command::__handle_cmd(parse_result &res) const {
+        for (size_t i = 0; i < options_.size(); i++) {
+            const option *opt = options_[i];
+            if (!res.values_[i].found_ && opt->required_) {
+                __set_error(res, ERR_OPTION_REQUIRED).opt_ = opt;
+                return -1;
+            }
+        }
+        for (size_t i = 0; i < positionals_.size(); i++) {
+            if (positionals_[i]->required_ && res.operand_cnt_ < i + 1) {
+                __set_error(res, ERR_ARGUMENT_REQUIRED).pos_ = positionals_[i];
                 return -1;
             }
         }
 
-        if (action_cb_) {
-            int ret = action_cb_(this);
+        res.__trace(PHASE_VALIDATE);
+
+        // Option getters and get_parent_cmd read the parse result in action
+        internal::active_result_scope scope(&res);
+
+        int ret = 0;
+        if (async_action_cb_) {
+            ret = __run_async_action(res);
+        } else if (action_cb_ || result_action_cb_) {
+            ret = result_action_cb_ ? result_action_cb_(this, res) : action_cb_(this);
             if (ret != 0) {
-                __set_error(this, "process command %s failed\n", this->name_.c_str());
+                __set_error(res, ERR_ACTION_FAILED);
             }
-            return ret;
+        } else {
+            print_usage();
         }
+        res.__trace(PHASE_ACTION);
 
-        print_usage();
+        return ret;
+    }
 
-        return 0;
+    void command::__reset_options(parse_result &res) const {
+        if (res.values_.size() < options_.size()) {
+            res.values_.resize(options_.size());
+        }
+        for (size_t i = 0; i < options_.size(); i++) {
+            options_[i]->__reset(res.values_[i]);
+        }
+
+        if (typed_size_ > 0) {
+            size_t words = (typed_size_ + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t);
+            if (res.typed_values_.size() < words) {
+                res.typed_values_.resize(words);
+            }
+            for (size_t i = 0; i < options_.size(); i++) {
+                const internal::typed_value *tv = options_[i]->typed_;
+                if (tv) {
+                    memcpy(res.__typed_value(options_[i]), tv->def, tv->size);
+                }
+            }
+        }
     }
 
-    void command::__setup_options_from_env() {
-        for (int i = 0; i < (int)options_.size(); i++) {
-            option *opt = options_[i];
-            if (!opt->env_.empty()) {
-                std::string value;
-                if (internal::get_system_env(opt->env_.c_str(), value) > 0) {
-                    __setup_option(opt, value);
+    bool command::__setup_options_from_config(parse_result &res) const {
+        internal::config_file *config = res.path_[0]->config_;
+        if (config == NULL) {
+            return true;
+        }
+
+        // Section name parts are the names of sub commands below the running command
+        struct path_names {
+            const std::vector<const command*> &path;
+            internal::string_ref operator[](size_t i) const {
+                return internal::string_ref(path[i + 1]->name_);
+            }
+        } names = { res.path_ };
+
+        const internal::config_section *sec = NULL;
+        std::string err;
+        if (!config->find(names, res.path_.size() - 1, sec, err)) {
+            __set_error(res, ERR_CONFIG_FILE).text_ = err;
+            return false;
+        }
+        if (sec == NULL) {
+            return true;
+        }
+
+        for (size_t i = 0; i < sec->entries.size(); i++) {
+            const internal::config_entry &e = sec->entries[i];
+            int pos = options_index_.find_long(e.key.data, e.key.size);
+            res.stats_.option_lookups++;
+            if (pos < 0) {
+                continue;
+            }
+            parse_status st = __setup_option(options_[pos], e.value, res);
+            if (st != PARSE_OK) {
+                run_error &err = __set_error(res, st == PARSE_OVERFLOW ? ERR_CONFIG_OUT_OF_RANGE : ERR_CONFIG_INVALID);
+                err.arg_ = e.key.data;
+                err.opt_ = options_[pos];
+                err.line_ = e.line;
+                return false;
+            }
+            res.values_[pos].source_ = SOURCE_CONFIG;
+        }
+
+        return true;
+    }
+
+    void command::__setup_options_from_env(parse_result &res) const {
+        const char *prefix = "";
+        for (size_t i = res.path_.size(); i > 0 && prefix[0] == 0; i--) {
+            prefix = res.path_[i - 1]->env_prefix_;
+        }
+        size_t prefix_len = strlen(prefix);
+
+        // All bindings are resolved from one snapshot of the environment
+        char name[256];
+        for (size_t i = 0; i < options_.size(); i++) {
+            const option *opt = options_[i];
+            const char *env = opt->env_;
+            size_t len = strlen(env);
+            if (len == 0 && prefix_len > 0 && opt->long_name_[0] != 0) {
+                len = prefix_len + strlen(opt->long_name_);
+                if (len >= sizeof(name)) {
+                    continue;
+                }
+                memcpy(name, prefix, prefix_len);
+                for (size_t j = prefix_len; j < len; j++) {
+                    char c = opt->long_name_[j - prefix_len];
+                    name[j] = c == '-' ? '_' : (char)toupper((unsigned char)c);
                 }
+                env = name;
+            }
+            if (len == 0) {
+                continue;
+            }
+
+            if (!res.env_.is_built()) {
+                res.env_.build(res.envp_);
+                res.stats_.env_vars = res.env_.size();
+            }
+            const char *value = res.env_.find(env, len);
+            res.stats_.env_probes++;
+            if (value != NULL && value[0] != 0 && 
+                __setup_option(opt, internal::string_ref(value), res) == PARSE_OK) {
+                res.values_[i].source_ = SOURCE_ENV;
             }
         }
     }
 
-    bool command::__setup_options_from_args(const char **argv, int argc) {
+    bool command::__setup_options_from_args(const char **argv, int argc, parse_result &res) const {
+        // Each argument is tokenized once, the next one is kept as lookahead to
+        // decide whether it is the value of the current option.
+        internal::arg_token tok;
+        internal::arg_token next;
+        res.stats_.tokens += argc;
+        if (argc > 0) {
+            internal::tokenize_arg(argv[0], next);
+        }
+
         for (int i = 0; i < argc; i++) {
-            std::string name;
-            std::string value;
-            bool is_short_option = false;
-            if (internal::is_short_option_arg(argv[i])) {
-                is_short_option = true;
-            } else if (!internal::is_long_option_arg(argv[i])) {
-                __set_error(this, "invalid option: %s\n", argv[i]);
-                return false;
+            const char *arg = argv[i];
+            const char **argp = argv + i;
+            tok = next;
+            if (i + 1 < argc) {
+                internal::tokenize_arg(argv[i + 1], next);
+            }
+
+            if (!positionals_.empty()) {
+                // All args after "--" are operands
+                if (strcmp(arg, "--") == 0) {
+                    for (i++; i < argc; i++) {
+                        if (!__add_operand(argv + i, res)) {
+                            return false;
+                        }
+                    }
+                    break;
+                }
+                if (tok.type == internal::ARG_COMMAND || tok.type == internal::ARG_OTHER) {
+                    if (!__add_operand(argp, res)) {
+                        return false;
+                    }
+                    continue;
+                }
             }
 
-            if (!internal::parse_option_name(is_short_option, argv[i], name, value)) {
-                __set_error(this, "invalid option: %s\n", argv[i]);
+            if (tok.type != internal::ARG_LONG_OPTION && 
+                tok.type != internal::ARG_SHORT_OPTION) {
+                __set_error(res, ERR_UNKNOWN_OPTION, argp);
                 return false;
             }
 
-            if (is_short_option) {
-                for (int j = 0; j < (int)name.size(); j++) {
-                    if (j == (int)name.size() - 1) {
-                        if (i + 1 < argc && !internal::is_option_arg(argv[i + 1])) {
-                            value = argv[i + 1];
-                            i++;
+            internal::string_ref value = tok.value;
+            if (!tok.has_value && i + 1 < argc && __takes_next(tok, next)) {
+                value = next.name;
+                i++;
+                if (i + 1 < argc) {
+                    internal::tokenize_arg(argv[i + 1], next);
+                }
+            }
+
+            if (tok.type == internal::ARG_SHORT_OPTION) {
+                // Only the last one of bundled short options takes the value
+                for (size_t j = 0; j < tok.name.size; j++) {
+                    bool last = j + 1 == tok.name.size;
+                    parse_status st = 
+                        __setup_option(tok.name.data + j, 1, last ? value : internal::string_ref(), res);
+                    if (st != PARSE_OK) {
+                        __set_option_error(st, tok.name.data + j, 1, argp, res);
+
+                        // A long option typed with one dash is suggested by the whole name
+                        for (size_t k = 0; st != PARSE_OVERFLOW && tok.name.size > 1 && k < tok.name.size; k++) {
+                            if (!__find_option(tok.name.data + k, 1)) {
+                                res.error_.name_ = tok.name;
+                                break;
+                            }
                         }
-                    }
-                    if (!__setup_option(name.substr(j, 1), value)) {
-                        __set_error(this, "invalid option: %s\n", argv[i]);
                         return false;
                     }
                 }
             } else {
-                if (value.empty() && i + 1 < argc) {
-                    if (!internal::is_option_arg(argv[i + 1])) {
-                        value = argv[i + 1];
-                        i++;
+                parse_status st = __setup_option(tok.name.data, tok.name.size, value, res);
+                if (st != PARSE_OK) {
+                    __set_option_error(st, tok.name.data, tok.name.size, argp, res);
+                    if (res.error_.opt_ == NULL) {
+                        res.error_.name_ = tok.name;
                     }
-                }
-                if (!__setup_option(name, value)) {
-                    __set_error(this, "invalid option: %s\n", argv[i]);
                     return false;
                 }
             }
@@ -433,87 +761,506 @@ namespace easycmd {
         return true;
     }
 
-    bool command::__setup_option(const std::string &name, const std::string &value) {
-        option *opt = __find_option(name, name);
-        if (!opt) {
-            return false;
+    parse_status command::__setup_option(const char *name, 
+                                         size_t len, 
+                                         const internal::string_ref &value, 
+                                         parse_result &res) const {
+        int pos = options_index_.find(name, len);
+        res.stats_.option_lookups++;
+        if (pos < 0) {
+            return PARSE_INVALID;
+        }
+        parse_status st = __setup_option(options_[pos], value, res);
+        if (st == PARSE_OK) {
+            res.values_[pos].source_ = SOURCE_ARGS;
         }
-        return __setup_option(opt, value);
+        return st;
     }
     
-    bool command::__setup_option(option *opt, const std::string &value) {
-        if (opt->type_ == internal::OP_TYPE_BOOL) {
-            if (value.empty() || value == "true" || value == "TRUE") {
-                opt->__set(true);                
+    parse_status command::__setup_option(const option *opt, 
+                                         const internal::string_ref &value, 
+                                         parse_result &res) const {
+        option_value &v = res.values_[opt->pos_];
+        if (opt->type_ == internal::OP_TYPE_TYPED) {
+            parse_status st = opt->typed_->parse(value.data, value.size, res.__typed_value(opt));
+            if (st != PARSE_OK) {
+                return st;
+            }
+            v.found_ = true;
+        } else if (opt->type_ == internal::OP_TYPE_BOOL) {
+            if (value.empty() || value.equal("true", 4) || value.equal("TRUE", 4)) {
+                v.__set(true);                
             } else {
-                opt->__set(false);
+                v.__set(false);
             }
         } else if (opt->type_ == internal::OP_TYPE_INT) {
-            if (!internal::is_int_value(value)) {
-                return false;
+            int i = 0;
+            parse_status st = internal::parse_int(value.data, value.size, i);
+            if (st != PARSE_OK) {
+                return st;
             }
-            opt->__set(atoi(value.c_str()));
+            v.__set(i);
         } else if (opt->type_ == internal::OP_TYPE_FLOAT) {
-            if (!internal::is_float_value(value)) {
-                return false;
+            double f = 0.0;
+            parse_status st = internal::parse_double(value.data, value.size, f);
+            if (st != PARSE_OK) {
+                return st;
             }
-            opt->__set(atof(value.c_str()));
+            v.__set(f);
         } else if (opt->type_ == internal::OP_TYPE_STRING) {
             if (value.empty()) {
-                return false;
+                return PARSE_INVALID;
             }
-            opt->__set(value);
+            v.__set(value.data, value.size);
+        } else if (opt->type_ == internal::OP_TYPE_CHOICE) {
+            int id = opt->choices_->find(value.data, value.size);
+            if (id < 0) {
+                return PARSE_INVALID;
+            }
+            v.__set(id);
         } else {
-            return false;
+            return PARSE_INVALID;
         }
 
-        return true;
+        return PARSE_OK;
     }
 
-    command* command::__get_public_sub_cmd(const std::string &name) {
-        command_map::iterator it = public_sub_cmds_.find(name);
+    command* command::__find_sub_cmd(const std::string &name) const {
+        command_map::const_iterator it = sub_cmds_.find(name);
+        if (it != sub_cmds_.end()) {
+            return it->second;
+        }
+
+        lazy_cmd_map::const_iterator lit = lazy_sub_cmds_.find(name);
+        if (lit != lazy_sub_cmds_.end()) {
+            return __load_lazy_sub_cmd(lit->second);
+        }
+
+        if (def_) {
+            for (int i = 0; i < def_->sub_cmd_count; i++) {
+                if (name == def_->sub_cmds[i]->name) {
+                    return __load_def_sub_cmd(i, false);
+                }
+            }
+        }
+
+        return NULL;
+    }
+
+    command* command::__find_public_sub_cmd(const std::string &name) const {
+        command_map::const_iterator it = public_sub_cmds_.find(name);
         if (it != public_sub_cmds_.end()) {
             return it->second;
         }
 
-        if (parent_cmd_) {
-            return parent_cmd_->__get_public_sub_cmd(name);
+        lazy_cmd_map::const_iterator lit = lazy_public_sub_cmds_.find(name);
+        if (lit != lazy_public_sub_cmds_.end()) {
+            return __load_lazy_sub_cmd(lit->second);
+        }
+
+        if (def_) {
+            for (int i = 0; i < def_->public_sub_cmd_count; i++) {
+                if (name == def_->public_sub_cmds[i]->name) {
+                    return __load_def_sub_cmd(i, true);
+                }
+            }
         }
 
         return NULL;
     }
 
-    void command::__get_public_sub_cmds(command_map &cmds) const {
-        command_map::const_iterator beg;
-        for (beg = public_sub_cmds_.begin(); beg != public_sub_cmds_.end(); beg++) {
-            if (cmds.find(beg->first) == cmds.end()) {
-                cmds[beg->first] = beg->second;
+    command* command::__load_def_sub_cmd(int idx, bool is_public) const {
+        std::atomic<command*> &slot = is_public ? def_public_sub_cmds_[idx] : def_sub_cmds_[idx];
+        command *sub = slot.load(std::memory_order_acquire);
+        if (sub) {
+            return sub;
+        }
+
+        std::lock_guard<std::mutex> lock(arena_->get_mutex());
+        sub = slot.load(std::memory_order_relaxed);
+        if (sub == NULL) {
+            const command_def *def = is_public ? def_->public_sub_cmds[idx] : def_->sub_cmds[idx];
+            sub = arena_->create<command>(arena_, def);
+            sub->parent_cmd_ = const_cast<command*>(this);
+            slot.store(sub, std::memory_order_release);
+        }
+
+        return sub;
+    }
+
+    void command::__add_lazy_sub_cmd(const command_factory &factory, 
+                                     command_map &cmds, 
+                                     lazy_cmd_map &lazy_cmds) {
+        command_map::iterator it = cmds.find(factory.name);
+        if (it != cmds.end()) {
+            if (!it->second->in_arena_) {
+                delete it->second;
             }
+            cmds.erase(it);
+        }
+
+        lazy_cmd *lc = arena_->create<lazy_cmd>();
+        lc->name = arena_->intern(factory.name, strlen(factory.name));
+        lc->desc = arena_->intern(factory.desc, strlen(factory.desc));
+        lc->build = factory.build;
+        lc->cmd.store(NULL);
+        lazy_cmds[lc->name] = lc;
+
+        completion_trie_stale_.store(true);
+        __change_scope();
+    }
+
+    void command::__remove_lazy_sub_cmd(const char *name, lazy_cmd_map &lazy_cmds) {
+        // The replaced sub command, if it was created, is freed with its factory in 
+        // the arena
+        lazy_cmd_map::iterator it = lazy_cmds.find(name);
+        if (it != lazy_cmds.end()) {
+            lazy_cmds.erase(it);
+        }
+    }
+
+    command* command::__load_lazy_sub_cmd(lazy_cmd *lc) const {
+        command *sub = lc->cmd.load(std::memory_order_acquire);
+        if (sub) {
+            return sub;
         }
 
-        if (parent_cmd_) {
-            parent_cmd_->__get_public_sub_cmds(cmds);
+        // The sub command has its own arena, so the builder can create objects in it 
+        // while other threads use the arena of this command
+        std::lock_guard<std::mutex> lock(lc->mutex);
+        sub = lc->cmd.load(std::memory_order_relaxed);
+        if (sub == NULL) {
+            sub = new command();
+            sub->name_ = lc->name;
+            sub->desc_ = lc->desc;
+            sub->parent_cmd_ = const_cast<command*>(this);
+            if (lc->build) {
+                lc->build(sub);
+            }
+            lc->cmd.store(sub, std::memory_order_release);
+        }
+
+        return sub;
+    }
+
+    const command* command::__get_public_sub_cmd(const std::string &name, 
+                                                 const parse_result &res) const {
+        // The current command is the last one of the path
+        for (size_t i = res.path_.size(); i > 0; i--) {
+            const command *sub = res.path_[i - 1]->__find_public_sub_cmd(name);
+            if (sub) {
+                return sub;
+            }
+        }
+
+        return NULL;
+    }
+
+    const command* command::__dispatch_sub_cmd(const char *name, const parse_result &res) const {
+        if (res.scoped_) {
+            const scope_table *table = __get_scope_table();
+            int pos = table->index.find_long(name, strlen(name));
+            return pos < 0 ? NULL : __get_scope_cmd(table->entries[pos], true);
+        }
+
+        // The path has public sub commands reached from another parent
+        std::string n(name);
+        const command *sub = __find_sub_cmd(n);
+        if (sub == NULL) {
+            sub = __get_public_sub_cmd(n, res);
+        }
+        return sub;
+    }
+
+    const command::scope_table* command::__get_scope_table() const {
+        unsigned generation = __get_scope_generation();
+        scope_table *table = scope_table_.load(std::memory_order_acquire);
+        if (table && table->generation.load(std::memory_order_acquire) == generation) {
+            return table;
+        }
+
+        std::lock_guard<std::mutex> lock(arena_->get_mutex());
+        table = scope_table_.load(std::memory_order_relaxed);
+        if (table && table->generation.load(std::memory_order_relaxed) == generation) {
+            return table;
+        }
+
+        // The storage of an older table is reused, nothing reads it while the tree
+        // is changed
+        if (table == NULL) {
+            table = arena_->create<scope_table>();
+        }
+        table->generation.store(0, std::memory_order_relaxed);
+        table->entries.clear();
+        table->index.clear();
+
+        // Same order as sub commands are searched: own sub commands, then public 
+        // sub commands from this command up to the root
+        internal::option_index names;
+        __add_scope_entries(table->entries, names, false);
+        for (const command *cmd = this; cmd != NULL; cmd = cmd->parent_cmd_) {
+            cmd->__add_scope_entries(table->entries, names, true);
+        }
+
+        struct name_less {
+            bool operator()(const scope_entry &a, const scope_entry &b) const {
+                return strcmp(a.name, b.name) < 0;
+            }
+        };
+        std::sort(table->entries.begin(), table->entries.end(), name_less());
+        for (size_t i = 0; i < table->entries.size(); i++) {
+            table->index.add(table->entries[i].name, "", (int)i);
+        }
+
+        table->generation.store(generation, std::memory_order_release);
+        scope_table_.store(table, std::memory_order_release);
+
+        return table;
+    }
+
+    void command::__change_scope() {
+        scope_generation_ = ++scope_generation;
+    }
+
+    unsigned command::__get_scope_generation() const {
+        unsigned generation = scope_generation_;
+        for (const command *cmd = parent_cmd_; cmd != NULL; cmd = cmd->parent_cmd_) {
+            generation = std::max(generation, cmd->scope_generation_);
+        }
+        return generation;
+    }
+
+    void command::__add_scope_entries(std::vector<scope_entry> &entries, 
+                                      internal::option_index &index, 
+                                      bool is_public) const {
+        scope_entry e;
+        e.owner = this;
+        e.is_public = is_public;
+
+        const command_map &cmds = is_public ? public_sub_cmds_ : sub_cmds_;
+        for (command_map::const_iterator it = cmds.begin(); it != cmds.end(); it++) {
+            if (index.find_long(it->first.data(), it->first.size()) < 0) {
+                e.name = it->second->name_;
+                e.desc = it->second->desc_;
+                e.cmd = it->second;
+                e.lazy = NULL;
+                e.def_idx = -1;
+                index.add(e.name, "", (int)entries.size());
+                entries.push_back(e);
+            }
+        }
+
+        const lazy_cmd_map &lazy_cmds = is_public ? lazy_public_sub_cmds_ : lazy_sub_cmds_;
+        for (lazy_cmd_map::const_iterator it = lazy_cmds.begin(); it != lazy_cmds.end(); it++) {
+            if (index.find_long(it->first.data(), it->first.size()) < 0) {
+                e.name = it->second->name;
+                e.desc = it->second->desc;
+                e.cmd = NULL;
+                e.lazy = it->second;
+                e.def_idx = -1;
+                index.add(e.name, "", (int)entries.size());
+                entries.push_back(e);
+            }
+        }
+
+        if (def_) {
+            int cnt = is_public ? def_->public_sub_cmd_count : def_->sub_cmd_count;
+            const command_def *const *defs = is_public ? def_->public_sub_cmds : def_->sub_cmds;
+            for (int i = 0; i < cnt; i++) {
+                if (index.find_long(defs[i]->name, strlen(defs[i]->name)) < 0) {
+                    e.name = defs[i]->name;
+                    e.desc = defs[i]->desc;
+                    e.cmd = NULL;
+                    e.lazy = NULL;
+                    e.def_idx = i;
+                    index.add(e.name, "", (int)entries.size());
+                    entries.push_back(e);
+                }
+            }
+        }
+    }
+
+    command* command::__get_scope_cmd(const scope_entry &e, bool load) {
+        if (e.cmd) {
+            return e.cmd;
+        }
+        if (e.lazy) {
+            return load ? e.owner->__load_lazy_sub_cmd(e.lazy) : e.lazy->cmd.load(std::memory_order_acquire);
+        }
+        if (load) {
+            return e.owner->__load_def_sub_cmd(e.def_idx, e.is_public);
+        }
+        std::atomic<command*> *slots = e.is_public ? e.owner->def_public_sub_cmds_ : e.owner->def_sub_cmds_;
+        return slots[e.def_idx].load(std::memory_order_acquire);
+    }
+
+    bool command::__has_static_scope() const {
+        for (const command *cmd = this; cmd != NULL; cmd = cmd->parent_cmd_) {
+            if (cmd->get_parent_cmd() != cmd->parent_cmd_) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void command::__load_sub_cmds(command_map &subs, command_map &publics) const {
+        subs.insert(sub_cmds_.begin(), sub_cmds_.end());
+        for (lazy_cmd_map::const_iterator it = lazy_sub_cmds_.begin(); it != lazy_sub_cmds_.end(); it++) {
+            subs[it->first] = __load_lazy_sub_cmd(it->second);
+        }
+        publics.insert(public_sub_cmds_.begin(), public_sub_cmds_.end());
+        for (lazy_cmd_map::const_iterator it = lazy_public_sub_cmds_.begin(); it != lazy_public_sub_cmds_.end(); it++) {
+            publics[it->first] = __load_lazy_sub_cmd(it->second);
+        }
+
+        if (def_) {
+            for (int i = 0; i < def_->sub_cmd_count; i++) {
+                if (subs.find(def_->sub_cmds[i]->name) == subs.end()) {
+                    subs[def_->sub_cmds[i]->name] = __load_def_sub_cmd(i, false);
+                }
+            }
+            for (int i = 0; i < def_->public_sub_cmd_count; i++) {
+                if (publics.find(def_->public_sub_cmds[i]->name) == publics.end()) {
+                    publics[def_->public_sub_cmds[i]->name] = __load_def_sub_cmd(i, true);
+                }
+            }
+        }
+    }
+
+    void command::get_memory_report(memory_report &rep) const {
+        rep.clear();
+
+        std::lock_guard<std::mutex> lock(arena_->get_mutex());
+        std::set<const command*> seen;
+        __count_memory(rep, seen);
+
+        rep.arena_footprint = arena_->footprint();
+        rep.arena_used = arena_->used();
+        rep.string_bytes = arena_->intern_requested();
+        rep.interned_bytes = arena_->intern_stored();
+        rep.interned_strings = arena_->intern_count();
+    }
+
+    void command::__count_memory(memory_report &rep, std::set<const command*> &seen) const {
+        if (!seen.insert(this).second) {
+            return;
+        }
+        rep.commands++;
+        rep.options += options_.size();
+        rep.positionals += positionals_.size();
+
+        std::vector<const command*> subs;
+        for (command_map::const_iterator it = sub_cmds_.begin(); it != sub_cmds_.end(); it++) {
+            subs.push_back(it->second);
+        }
+        for (command_map::const_iterator it = public_sub_cmds_.begin(); it != public_sub_cmds_.end(); it++) {
+            subs.push_back(it->second);
+        }
+        for (lazy_cmd_map::const_iterator it = lazy_sub_cmds_.begin(); it != lazy_sub_cmds_.end(); it++) {
+            subs.push_back(it->second->cmd.load(std::memory_order_acquire));
+        }
+        for (lazy_cmd_map::const_iterator it = lazy_public_sub_cmds_.begin(); it != lazy_public_sub_cmds_.end(); it++) {
+            subs.push_back(it->second->cmd.load(std::memory_order_acquire));
+        }
+        if (def_) {
+            for (int i = 0; i < def_->sub_cmd_count; i++) {
+                subs.push_back(def_sub_cmds_[i].load(std::memory_order_acquire));
+            }
+            for (int i = 0; i < def_->public_sub_cmd_count; i++) {
+                subs.push_back(def_public_sub_cmds_[i].load(std::memory_order_acquire));
+            }
+        }
+
+        for (size_t i = 0; i < subs.size(); i++) {
+            if (subs[i] != NULL && subs[i]->arena_ == arena_) {
+                subs[i]->__count_memory(rep, seen);
+            }
+        }
+    }
+
+    void command::__get_sub_cmds(desc_map &descs, const command *self) const {
+        for (command_map::const_iterator it = sub_cmds_.begin(); it != sub_cmds_.end(); it++) {
+            descs.insert(desc_map::value_type(it->first, it->second == self ? NULL : it->second->desc_));
+        }
+        for (lazy_cmd_map::const_iterator it = lazy_sub_cmds_.begin(); it != lazy_sub_cmds_.end(); it++) {
+            const command *sub = it->second->cmd.load(std::memory_order_acquire);
+            descs.insert(desc_map::value_type(it->first, sub == self ? NULL : it->second->desc));
+        }
+
+        if (def_) {
+            for (int i = 0; i < def_->sub_cmd_count; i++) {
+                const command *sub = def_sub_cmds_[i].load(std::memory_order_acquire);
+                descs.insert(desc_map::value_type(def_->sub_cmds[i]->name, 
+                                                  sub == self ? NULL : def_->sub_cmds[i]->desc));
+            }
+        }
+    }
+
+    void command::__get_public_sub_cmds(desc_map &descs, const command *self) const {
+        command_map::const_iterator it = public_sub_cmds_.begin();
+        for (; it != public_sub_cmds_.end(); it++) {
+            descs.insert(desc_map::value_type(it->first, it->second == self ? NULL : it->second->desc_));
+        }
+        lazy_cmd_map::const_iterator lit = lazy_public_sub_cmds_.begin();
+        for (; lit != lazy_public_sub_cmds_.end(); lit++) {
+            const command *sub = lit->second->cmd.load(std::memory_order_acquire);
+            descs.insert(desc_map::value_type(lit->first, sub == self ? NULL : lit->second->desc));
+        }
+
+        if (def_) {
+            for (int i = 0; i < def_->public_sub_cmd_count; i++) {
+                const command *sub = def_public_sub_cmds_[i].load(std::memory_order_acquire);
+                descs.insert(desc_map::value_type(def_->public_sub_cmds[i]->name, 
+                                                  sub == self ? NULL : def_->public_sub_cmds[i]->desc));
+            }
+        }
+
+        const command *parent = get_parent_cmd();
+        if (parent) {
+            parent->__get_public_sub_cmds(descs, self);
         }
     }
 
     std::string command::__get_cmd_path() const {
-        if (parent_cmd_) {
-            return parent_cmd_->__get_cmd_path() + " " + name_;
+        const command *parent = get_parent_cmd();
+        if (parent) {
+            return parent->__get_cmd_path() + " " + name_;
         }
 
 #if defined(WIN32)
-        size_t pos = name_.rfind('\\');
+        const char *pos = strrchr(name_, '\\');
 #else
-        size_t pos = name_.rfind('/');
+        const char *pos = strrchr(name_, '/');
 #endif
-        if (pos == std::string::npos) {
+        if (pos == NULL) {
             return name_;
         }
 
-        return name_.substr(pos+1);
+        return pos + 1;
+    }
+
+    run_error& command::__set_error(parse_result &res, error_code code, const char **arg) const {
+        run_error &e = res.__set_error(code, this);
+        if (arg) {
+            e.arg_ = *arg;
+            e.token_ = res.argv_ ? (int)(arg - res.argv_) : -1;
+        }
+        return e;
     }
 
-    void command::__set_error(command *cmd, const char *format, ...) {
+    void command::__set_option_error(parse_status st, 
+                                     const char *name, 
+                                     size_t len, 
+                                     const char **arg, 
+                                     parse_result &res) const {
+        run_error &e = __set_error(res, st == PARSE_OVERFLOW ? ERR_OUT_OF_RANGE : ERR_INVALID_VALUE, arg);
+        e.opt_ = __find_option(name, len);
+        if (e.opt_ == NULL) {
+            e.code_ = ERR_UNKNOWN_OPTION;
+        }
+    }
+
+    void command::__set_error(std::string &err, const char *format, ...) {
         va_list args;
         va_start(args, format);
 
@@ -523,11 +1270,7 @@ namespace easycmd {
 #else
         vsnprintf(msg, sizeof(msg)-1, format, args);
 #endif
-        command *root = cmd;
-        while (root->parent_cmd_) {
-            root = root->parent_cmd_;
-        }
-        root->err_ = msg;
+        err = msg;
 
         va_end(args);
     }
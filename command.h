@@ -26,13 +26,41 @@
 #define options_h
 
 #include <map>
+#include <set>
+#include <mutex>
+#include <atomic>
+#include <future>
 #include <vector>
+#include <stdio.h>
 #include <string.h>
 
 #include "option.h"
+#include "positional.h"
+#include "typed_option.h"
+#include "command_def.h"
+#include "parse_result.h"
+#include "option_index.h"
+#include "string_ref.h"
+#include "tokenizer.h"
+#include "number.h"
 
 namespace easycmd {
 
+    // Optional parts, include their headers to use them
+    class cancel_token;
+    class usage_writer;
+    struct batch_result;
+    struct batch_stats;
+    struct memory_report;
+
+    // See batch.h
+    typedef void(*batch_callback)(const batch_result&);
+
+    namespace internal {
+        class completion_trie;
+        class config_file;
+    }
+
     /*********************************************************************************
      * Command
      ********************************************************************************/
@@ -44,16 +72,42 @@ namespace easycmd {
          ********************************************************************************/
         typedef int(*action_callback)(const command*);
 
+        /*********************************************************************************
+         * Command action callback with parse result
+         ********************************************************************************/
+        typedef int(*result_action_callback)(const command*, const parse_result&);
+
+        /*********************************************************************************
+         * Command async action callback
+         * Runs on its own thread while run() waits for it, and should return soon after
+         * the token is cancelled.
+         ********************************************************************************/
+        typedef int(*async_action_callback)(const command*, const parse_result&, const cancel_token&);
+
         /*********************************************************************************
          * Command error callback
          ********************************************************************************/
         typedef void(*fault_callback)(const std::string&);
 
+        /*********************************************************************************
+         * Trace callback
+         * Called at the end of each traced run with the parse result, whose stats
+         * have the timings of the run. Runs of many threads call it concurrently.
+         ********************************************************************************/
+        typedef void(*trace_callback)(const command*, const parse_result&);
+
+        /*********************************************************************************
+         * Allocation counter
+         * Returns the allocations of the process so far, the difference is reported.
+         ********************************************************************************/
+        typedef size_t(*alloc_counter)();
+
         /*********************************************************************************
          * Common Types
          ********************************************************************************/
         typedef std::vector<option*> option_vector;
         typedef std::map<std::string, command*> command_map;
+        typedef std::map<std::string, const char*> desc_map;
 
     public:
         /*********************************************************************************
@@ -61,6 +115,13 @@ namespace easycmd {
          ********************************************************************************/
         command();
 
+        /*********************************************************************************
+         * Constructor from static definition
+         * Only the options of the definition are created here, sub commands are
+         * created when they are dispatched to or when usage is required.
+         ********************************************************************************/
+        explicit command(const command_def *def);
+
         /*********************************************************************************
          * Deconstructor
          ********************************************************************************/
@@ -70,7 +131,7 @@ namespace easycmd {
          * Set command name
          ********************************************************************************/
         command* with_name(const std::string &name) { 
-            name_ = name; 
+            name_ = arena_->intern(name.data(), name.size()); 
             return this; 
         }
 
@@ -78,7 +139,19 @@ namespace easycmd {
          * Set command desc
          ********************************************************************************/
         command* with_desc(const std::string &desc) { 
-            desc_ = desc; 
+            desc_ = arena_->intern(desc.data(), desc.size()); 
+            return this;
+        }
+
+        /*********************************************************************************
+         * Set env prefix
+         * Options without env of this command and its sub commands are bound to the env
+         * named by the prefix and the upper cased long name, with '-' replaced by '_'.
+         * For example, --max-count is bound to MYAPP_MAX_COUNT with prefix "MYAPP_".
+         * The nearest prefix on the path of the dispatched command is used.
+         ********************************************************************************/
+        command* with_env_prefix(const std::string &prefix) { 
+            env_prefix_ = arena_->intern(prefix.data(), prefix.size()); 
             return this;
         }
 
@@ -89,6 +162,70 @@ namespace easycmd {
             action_cb_ = action; 
             return this; 
         }
+        command* with_action(result_action_callback action) { 
+            result_action_cb_ = action; 
+            return this; 
+        }
+        command* with_action(async_action_callback action) { 
+            async_action_cb_ = action; 
+            return this; 
+        }
+
+        /*********************************************************************************
+         * Set timeout of async action
+         * The token of the action is cancelled with CANCEL_TIMEOUT after ms milliseconds,
+         * zero means no timeout. Sync actions are not limited.
+         ********************************************************************************/
+        command* with_timeout(unsigned ms) { 
+            timeout_ms_ = ms; 
+            return this; 
+        }
+
+        /*********************************************************************************
+         * Enable response files
+         * Disabled by default, as any arg starting with '@' would be read as a file. If
+         * enabled, an argument "@path" before "--" is replaced by the arguments in the 
+         * file, see internal::expand_response_files. Only the setting of the command
+         * run() is called on is used.
+         ********************************************************************************/
+        command* with_response_files(bool enable) { 
+            response_files_ = enable; 
+            return this; 
+        }
+
+        /*********************************************************************************
+         * Enable shell completion
+         * Disabled by default. If enabled, run(argc, argv) answers a command line whose
+         * first arg is "__complete" by printing completion candidates, see 
+         * get_completion_script. Runs with a parse result never do.
+         ********************************************************************************/
+        command* with_completion(bool enable) { 
+            completion_ = enable; 
+            return this; 
+        }
+
+        /*********************************************************************************
+         * Trace runs
+         * Runs of this command measure per phase timings and call the callback. Only
+         * the setting of the command run() is called on is used. Untraced runs don't
+         * read the clock. Set callback to null to stop tracing.
+         ********************************************************************************/
+        command* with_trace(trace_callback cb, alloc_counter counter = NULL) { 
+            trace_cb_ = cb; 
+            alloc_counter_ = counter;
+            return this; 
+        }
+
+        /*********************************************************************************
+         * Load config file
+         * Options of dispatched commands take values from the section named by the path
+         * of sub commands below this command joined by '.', keys before any section are 
+         * options of this command. Keys are long option names, unknown keys are ignored.
+         * Values of the file override defaults and are overridden by env and args. Only
+         * the file of the command run() is called on is used, and it must be loaded 
+         * before running. Return -1 if the file can't be opened or indexed.
+         ********************************************************************************/
+        int load_config_file(const std::string &path);
 
         /*********************************************************************************
          * Add sub command
@@ -105,6 +242,32 @@ namespace easycmd {
          ********************************************************************************/
         void add_public_sub_cmd(command *gsub);
 
+        /*********************************************************************************
+         * Add sub command by factory
+         * Only the name and desc are kept. The sub command is created with its own 
+         * arena and built by the factory when it is dispatched to, when completion 
+         * walks into it or when its own usage is required. It is freed with the current
+         * command. If there is already a sub command with the same name, it will be 
+         * replaced.
+         ********************************************************************************/
+        void add_sub_cmd(const command_factory &factory);
+        void add_public_sub_cmd(const command_factory &factory);
+
+        /*********************************************************************************
+         * Create sub command
+         * The sub command is placed in the arena of the current command and is freed 
+         * with it. If there is already a sub command with the same name, the new sub 
+         * command will replace the old one.
+         ********************************************************************************/
+        command* create_sub_cmd(const std::string &name);
+
+        /*********************************************************************************
+         * Create public sub command
+         * The public sub command is placed in the arena of the current command and is 
+         * freed with it.
+         ********************************************************************************/
+        command* create_public_sub_cmd(const std::string &name);
+
         /*********************************************************************************
          * Create option
          * If there is an old option with the name, the old option will be remove.
@@ -126,43 +289,322 @@ namespace easycmd {
             return __create_option(internal::OP_TYPE_STRING, long_name, short_name);
         }
 
+        /*********************************************************************************
+         * Create choice option
+         * The value must be one of choices, get_int() returns its id, the position in
+         * choices, and get_choice() returns it. A default is given by value or by id.
+         ********************************************************************************/
+        option* create_option_choice(const std::string &long_name, 
+                                     const std::string &short_name,
+                                     const std::vector<std::string> &choices) {
+            option *opt = __create_option(internal::OP_TYPE_CHOICE, long_name, short_name);
+            if (opt) {
+                std::vector<const char*> values(choices.size());
+                for (size_t i = 0; i < choices.size(); i++) {
+                    values[i] = choices[i].c_str();
+                }
+                opt->__set_choices(values.empty() ? NULL : &values[0], values.size());
+            }
+            return opt;
+        }
+
+        /*********************************************************************************
+         * Create typed option
+         * The value is parsed by option_parser<T>, see typed_option.h for the parsers
+         * of builtin types, durations, byte sizes and endpoints.
+         ********************************************************************************/
+        template <typename T>
+        typed_option<T>* create_option(const std::string &long_name, 
+                                       const std::string &short_name) {
+            static_assert(std::is_trivially_copyable<T>::value, "typed option value must be trivially copyable");
+            static_assert(alignof(T) <= alignof(std::max_align_t), "typed option value is over aligned");
+            if (!__check_option_names(long_name, short_name)) {
+                return nullptr;
+            }
+
+            typed_option<T> *opt = arena_->create<typed_option<T> >(
+                arena_, 
+                this, 
+                (int)options_.size(), 
+                arena_->intern(long_name.data(), long_name.size()), 
+                arena_->intern(short_name.data(), short_name.size()),
+                __add_typed_value(sizeof(T), alignof(T)));
+            __register_option(opt);
+            return opt;
+        }
+
+        /*********************************************************************************
+         * Create positional argument
+         * Positional arguments take operands in order of creation, and a tail takes all
+         * remaining operands. Nothing can be created after a tail. Without positional 
+         * arguments, any operand is an error as before. With them, "--" ends options
+         * and a bool option only takes the next arg as value if it is true or false.
+         ********************************************************************************/
+        positional* create_positional(const std::string &name) {
+            return __create_positional(name, false);
+        }
+        positional* create_positional_tail(const std::string &name) {
+            return __create_positional(name, true);
+        }
+
+        /*********************************************************************************
+         * Get operands
+         * Inside an action callback, these read the command line of the current thread.
+         * Otherwise they read the last run(argc, argv), whose args must still be alive.
+         * get_positional returns null if the positional argument is not given.
+         ********************************************************************************/
+        operand_range get_operands() const;
+        operand_range get_operands(const std::string &name) const;
+        const char* get_positional(const std::string &name) const;
+
         /*********************************************************************************
          * Get option for reading
          ********************************************************************************/
         const option* get_option(const std::string &name) const {
-            return __find_option(name, name);
+            return __find_option(name.data(), name.size());
         }
 
         /*********************************************************************************
          * Get parent command
+         * Inside an action callback, this returns the parent in the dispatched path, 
+         * which is where a public sub command was found.
          ********************************************************************************/
-        const command* get_parent_cmd() const { 
-            return parent_cmd_; 
+        const command* get_parent_cmd() const;
+
+        /*********************************************************************************
+         * Get arena
+         * Options, strings and sub commands created by create_sub_cmd are all placed 
+         * in the arena, so its footprint is the memory used by the command tree.
+         ********************************************************************************/
+        const arena* get_arena() const {
+            return arena_;
         }
 
+        /*********************************************************************************
+         * Get memory report
+         * Counts the commands below this command that are placed in its arena, and the
+         * memory of the arena. Sub commands are not created for this.
+         ********************************************************************************/
+        void get_memory_report(memory_report &rep) const;
+
         /*********************************************************************************
          * Get command usage
          ********************************************************************************/
         void get_usage(std::string &des) const;
 
+        /*********************************************************************************
+         * Write command usage
+         * Usage is streamed to the writer. Descs are wrapped at width columns, if width
+         * is 0 the terminal width of the writer is used, and text isn't wrapped if the
+         * writer is not a terminal or width is negative. Text is flushed before return.
+         ********************************************************************************/
+        void write_usage(usage_writer &w, int width = 0) const;
+
         /*********************************************************************************
          * Print command usage
+         * Usage is written to the stdout file descriptor after stdout is flushed.
          ********************************************************************************/
         void print_usage() const;
 
         /*********************************************************************************
          * Run command
+         * The error is saved for get_err(), and option values of the dispatched command
+         * are kept in the options after the run.
          ********************************************************************************/
         int run(int argc, const char **argv);
 
+        /*********************************************************************************
+         * Run command with parse result
+         * The command tree is not changed, so this can be called by many threads at 
+         * the same time once the tree is set up.
+         ********************************************************************************/
+        int run(int argc, const char **argv, parse_result &res) const;
+
+        /*********************************************************************************
+         * Run command with cancel token
+         * The token is passed to the async action of the dispatched command, so other
+         * threads can cancel it. A cancelled run fails with the reason in the error.
+         ********************************************************************************/
+        int run(int argc, const char **argv, parse_result &res, cancel_token &token) const;
+
+        /*********************************************************************************
+         * Run command on another thread
+         * The args, the parse result and the token must be alive until the future is
+         * ready, which holds the return value of run.
+         ********************************************************************************/
+        std::future<int> run_async(int argc, 
+                                   const char **argv, 
+                                   parse_result &res, 
+                                   cancel_token &token) const;
+
+        /*********************************************************************************
+         * Serve runs on a Unix socket
+         * Listens on path and runs the args of each client forwarded by 
+         * forward_to_daemon with the env, cwd and stdio of the client, so the tree and
+         * whatever the actions set up once are reused by every run. An error of a run
+         * is printed to the stderr of the client. Only clients of the same user are
+         * served, and a client that doesn't send its request in time is dropped.
+         * Serves until the token is cancelled or a signal set by 
+         * cancel_token::cancel_on_signal is received. Return false if the socket can't
+         * be listened on.
+         * Fds 0, 1 and 2 and the cwd of the process are replaced by those of the client
+         * during its run, so clients are served one at a time and serve must be the
+         * only activity of the process: other threads would read and write the stdio
+         * of the client and resolve relative paths in its cwd.
+         ********************************************************************************/
+        bool serve(const std::string &path, cancel_token &token, std::string &err) const;
+
+        /*********************************************************************************
+         * Run command lines in batch
+         * Reads newline separated command lines from the file, or from stdin if path is
+         * null or "-", and runs each of them with the name of the command as argv[0] on
+         * a pool of worker threads. Blank lines and lines starting with '#' are skipped.
+         * If workers is not positive, one worker per hardware thread is used. Return 0 
+         * if all command lines succeeded.
+         ********************************************************************************/
+        int run_batch(const char *path, 
+                      int workers, 
+                      batch_callback cb, 
+                      batch_stats *stats = NULL);
+        int run_batch(FILE *input, 
+                      int workers, 
+                      batch_callback cb, 
+                      batch_stats *stats = NULL) const;
+
+        /*********************************************************************************
+         * Complete command line
+         * argv[0] is the program name and the last arg is the word to complete, which
+         * may be empty. Candidates are the sub commands, public sub commands and options
+         * of the command dispatched by the args before it, sorted and starting with the
+         * word. There is no candidate at the position of an option value. If limit is
+         * not zero, at most limit candidates are returned. Return count of candidates.
+         ********************************************************************************/
+        size_t complete(int argc, 
+                        const char **argv, 
+                        std::vector<const char*> &candidates, 
+                        size_t limit = 0) const;
+
+        /*********************************************************************************
+         * Get shell completion script
+         * Supported shells are bash, zsh and fish. The script calls the program with 
+         * "__complete" and the words of the command line, and run(argc, argv) answers
+         * it by printing the candidates line by line if with_completion is enabled.
+         * Return false if shell is unknown.
+         ********************************************************************************/
+        bool get_completion_script(const std::string &shell, std::string &des) const;
+
+        /*********************************************************************************
+         * Get schema
+         * Serializes this command and all commands below it, with their options, 
+         * positional arguments and public sub commands, to the binary format read by 
+         * schema. Sub commands of definitions and factories are created for this.
+         ********************************************************************************/
+        void get_schema(std::string &des) const;
+
         /*********************************************************************************
          * Get error
+         * The error of run(argc, argv) is formatted when it is asked for.
          ********************************************************************************/
         std::string get_err() const {
-            return err_;
+            return err_.empty() ? last_res_.get_err() : err_;
+        }
+
+        /*********************************************************************************
+         * Get structured error of run(argc, argv)
+         ********************************************************************************/
+        const run_error& get_error() const {
+            return last_res_.get_error();
         }
 
     private:
+        /*********************************************************************************
+         * Sub command of factory
+         ********************************************************************************/
+        struct lazy_cmd
+        {
+            ~lazy_cmd() {
+                delete cmd.load(std::memory_order_relaxed);
+            }
+
+            const char *name;
+            const char *desc;
+            command_factory::builder build;
+            // Created sub command, it has its own arena
+            std::atomic<command*> cmd;
+            // Held while the sub command is built
+            std::mutex mutex;
+        };
+        typedef std::map<std::string, lazy_cmd*> lazy_cmd_map;
+
+        /*********************************************************************************
+         * Sub command visible to a command
+         * A sub command of the command, or a public sub command of it or of one of 
+         * its parents. Sub commands of factories and definitions are created when 
+         * they are dispatched.
+         ********************************************************************************/
+        struct scope_entry
+        {
+            const char *name;
+            const char *desc;
+            // Command the sub command is added to
+            const command *owner;
+            // Sub command, null if it is of a factory or a definition
+            command *cmd;
+            // Sub command of factory
+            lazy_cmd *lazy;
+            // Index in the sub commands of definition
+            int def_idx;
+            bool is_public;
+        };
+
+        /*********************************************************************************
+         * Scope table
+         * All sub commands visible to a command sorted by name, a name shadowed by a 
+         * nearer one is not in it. Built on first dispatch, and rebuilt in place if sub
+         * commands are added to the command or its parents later.
+         ********************************************************************************/
+        struct scope_table
+        {
+            // Scope generation the table is built for
+            std::atomic<unsigned> generation;
+            std::vector<scope_entry> entries;
+            internal::option_index index;
+        };
+
+        /*********************************************************************************
+         * Usage layout
+         * Name widths measured for usage, rebuilt when options, positional arguments or
+         * the scope table change.
+         ********************************************************************************/
+        struct usage_layout
+        {
+            // Scope generation sub commands are measured in, zero if they are not measured
+            unsigned scope_generation;
+            size_t sub_cmd_width;
+            size_t option_width;
+            size_t positional_width;
+            // Name widths of options, room for option_capacity options
+            size_t *option_widths;
+            size_t option_capacity;
+        };
+
+    private:
+        friend class arena;
+        friend class operand_iterator;
+        friend class parse_result;
+
+        /*********************************************************************************
+         * Constructor
+         * If arena is null, the command will create and own an arena.
+         ********************************************************************************/
+        command(arena *a, const command_def *def);
+
+        /*********************************************************************************
+         * Disable copy
+         ********************************************************************************/
+        command(const command&);
+        command& operator=(const command&);
+
         /*********************************************************************************
          * Create option
          ********************************************************************************/
@@ -170,80 +612,392 @@ namespace easycmd {
                                 const std::string &long_name, 
                                 const std::string &short_name);
 
+        /*********************************************************************************
+         * Check option names
+         * One name must be given and no option has the names.
+         ********************************************************************************/
+        bool __check_option_names(const std::string &long_name, 
+                                  const std::string &short_name) const;
+
+        /*********************************************************************************
+         * Add typed value
+         * Places a value of size and align in the typed values of parse results, and
+         * its default and last values in the arena.
+         ********************************************************************************/
+        internal::typed_value* __add_typed_value(size_t size, size_t align);
+
+        /*********************************************************************************
+         * Register option
+         ********************************************************************************/
+        void __register_option(option *opt);
+
+        /*********************************************************************************
+         * Create positional argument
+         ********************************************************************************/
+        positional* __create_positional(const std::string &name, bool tail);
+
+        /*********************************************************************************
+         * Add operand
+         ********************************************************************************/
+        bool __add_operand(const char **arg, parse_result &res) const;
+
+        /*********************************************************************************
+         * Check the option token takes the next arg as its value
+         ********************************************************************************/
+        bool __takes_next(const internal::arg_token &tok, const internal::arg_token &next) const;
+
+        /*********************************************************************************
+         * Get parse result of this command
+         * The active result in an action, or the last run(argc, argv) of the root.
+         ********************************************************************************/
+        const parse_result* __get_result() const;
+
+        /*********************************************************************************
+         * Add option
+         * The names must be stored in the arena or be static strings.
+         ********************************************************************************/
+        option* __add_option(internal::option_type opt_type, 
+                             const char *long_name, 
+                             const char *short_name);
+
         /*********************************************************************************
          * Find option
          ********************************************************************************/
-        option* __find_option(const std::string &long_name, 
-                              const std::string &short_name) const;
+        option* __find_option(const char *long_name, 
+                              const char *short_name) const;
+        option* __find_option(const char *name, size_t len) const;
 
         /*********************************************************************************
          * Run command 
          * This will parse args and call sub command or call action.
          ********************************************************************************/
-        int __run_cmd(const char **argv, int argc, int arg_idx);
+        int __run_cmd(const char **argv, int argc, int arg_idx, parse_result &res) const;
+
+        /*********************************************************************************
+         * Run command line with cleared parse result
+         * Traced if a trace callback is set.
+         ********************************************************************************/
+        int __trace_run(int argc, const char **argv, parse_result &res) const;
+
+        /*********************************************************************************
+         * Run command line with parse result
+         ********************************************************************************/
+        int __run(int argc, const char **argv, parse_result &res) const;
+
+        /*********************************************************************************
+         * Run async action
+         * Waits for the action thread, cancelling the token on timeout or signal.
+         ********************************************************************************/
+        int __run_async_action(parse_result &res) const;
+
+        /*********************************************************************************
+         * Async action worker
+         ********************************************************************************/
+        void __run_async_worker(void *ctx) const;
 
         /*********************************************************************************
          * Handle command
          ********************************************************************************/
-        int __handle_cmd();
+        int __handle_cmd(parse_result &res) const;
+
+        /*********************************************************************************
+         * Batch worker
+         ********************************************************************************/
+        void __run_batch_worker(void *ctx) const;
+
+        /*********************************************************************************
+         * Serve a daemon client
+         * cwd_fd is the directory of the daemon, changed back to after the run.
+         ********************************************************************************/
+        void __serve_client(int fd, int cwd_fd, parse_result &res) const;
+
+        /*********************************************************************************
+         * Reset option values to default values
+         ********************************************************************************/
+        void __reset_options(parse_result &res) const;
+
+        /*********************************************************************************
+         * Setup options from config file
+         ********************************************************************************/
+        bool __setup_options_from_config(parse_result &res) const;
 
         /*********************************************************************************
          * Setup options from environment
          ********************************************************************************/
-        void __setup_options_from_env();
+        void __setup_options_from_env(parse_result &res) const;
 
         /*********************************************************************************
          * Setup options from args
          ********************************************************************************/
-        bool __setup_options_from_args(const char **argv, int argc);
+        bool __setup_options_from_args(const char **argv, int argc, parse_result &res) const;
 
         /*********************************************************************************
          * Setup option
+         * An unknown option or a value not of the option type is invalid.
+         ********************************************************************************/
+        parse_status __setup_option(const char *name, 
+                                    size_t len, 
+                                    const internal::string_ref &value, 
+                                    parse_result &res) const;
+        parse_status __setup_option(const option *opt, 
+                                    const internal::string_ref &value, 
+                                    parse_result &res) const;
+
+        /*********************************************************************************
+         * Find sub command
+         * Sub commands declared by the static definition are created on demand.
+         ********************************************************************************/
+        command* __find_sub_cmd(const std::string &name) const;
+        command* __find_public_sub_cmd(const std::string &name) const;
+
+        /*********************************************************************************
+         * Create sub command from static definition
+         * The sub command is created once even if many threads dispatch to it.
+         ********************************************************************************/
+        command* __load_def_sub_cmd(int idx, bool is_public) const;
+
+        /*********************************************************************************
+         * Add sub command of factory
+         * The sub command with the same name is removed from cmds.
+         ********************************************************************************/
+        void __add_lazy_sub_cmd(const command_factory &factory, 
+                                command_map &cmds, 
+                                lazy_cmd_map &lazy_cmds);
+
+        /*********************************************************************************
+         * Remove sub command of factory
+         ********************************************************************************/
+        void __remove_lazy_sub_cmd(const char *name, lazy_cmd_map &lazy_cmds);
+
+        /*********************************************************************************
+         * Create sub command of factory
+         * The sub command is created and built once even if many threads use it. The
+         * builder runs under the mutex of the factory, not the arena mutex.
          ********************************************************************************/
-        bool __setup_option(const std::string &name, const std::string &value);
-        bool __setup_option(option *opt, const std::string &value);
+        command* __load_lazy_sub_cmd(lazy_cmd *lc) const;
 
         /*********************************************************************************
          * Get public sub command
+         * Searches public sub commands of the dispatched path from the current command 
+         * up to the root.
          ********************************************************************************/
-        command* __get_public_sub_cmd(const std::string &name);
+        const command* __get_public_sub_cmd(const std::string &name, const parse_result &res) const;
 
         /*********************************************************************************
-         * Get public sub commands
+         * Enter dispatched path
          ********************************************************************************/
-        void __get_public_sub_cmds(command_map &cmds) const;
+        void __enter_path(parse_result &res) const {
+            res.scoped_ = res.path_.empty() ? 
+                parent_cmd_ == NULL : 
+                res.scoped_ && parent_cmd_ == res.path_.back();
+            res.path_.push_back(this);
+        }
+
+        /*********************************************************************************
+         * Dispatch sub command
+         * Finds a sub command of this command, or a public sub command of the path.
+         * The current command is the last one of the path.
+         ********************************************************************************/
+        const command* __dispatch_sub_cmd(const char *name, const parse_result &res) const;
+
+        /*********************************************************************************
+         * Get scope table
+         ********************************************************************************/
+        const scope_table* __get_scope_table() const;
+
+        /*********************************************************************************
+         * Scope generation
+         * Changed when sub commands are added to the command or it gets a parent. The
+         * scope generation of a command is the newest one of it and its parents.
+         ********************************************************************************/
+        void __change_scope();
+        unsigned __get_scope_generation() const;
+
+        /*********************************************************************************
+         * Add sub commands to scope entries
+         * Names already in the index are skipped, added ones are put in it.
+         ********************************************************************************/
+        void __add_scope_entries(std::vector<scope_entry> &entries, 
+                                 internal::option_index &index, 
+                                 bool is_public) const;
+
+        /*********************************************************************************
+         * Get command of scope entry
+         * If load is false, a sub command not created yet is null.
+         ********************************************************************************/
+        static command* __get_scope_cmd(const scope_entry &e, bool load);
+
+        /*********************************************************************************
+         * Scope is the static one
+         * Parents of this command in the dispatched path are its parent links, so the
+         * scope table shows what usage shows.
+         ********************************************************************************/
+        bool __has_static_scope() const;
+
+        /*********************************************************************************
+         * Get usage layout
+         * Sub commands are measured if the table is not null.
+         ********************************************************************************/
+        const usage_layout* __get_usage_layout(const scope_table *table) const;
+
+        /*********************************************************************************
+         * Load sub commands
+         * All sub commands and public sub commands added to this command, including 
+         * the ones of definitions and factories, which are created.
+         ********************************************************************************/
+        void __load_sub_cmds(command_map &subs, command_map &publics) const;
+
+        /*********************************************************************************
+         * Count commands, options and positional arguments for memory report
+         * Only created commands in the same arena are counted, each once.
+         ********************************************************************************/
+        void __count_memory(memory_report &rep, std::set<const command*> &seen) const;
+
+        /*********************************************************************************
+         * Get desc of sub commands
+         * Sub commands are not created for this. The name of self is mapped to null.
+         ********************************************************************************/
+        void __get_sub_cmds(desc_map &descs, const command *self) const;
+
+        /*********************************************************************************
+         * Get desc of public sub commands
+         ********************************************************************************/
+        void __get_public_sub_cmds(desc_map &descs, const command *self) const;
+
+        /*********************************************************************************
+         * Get completion trie
+         * Built on first completion over the names of sub commands, public sub commands
+         * and options, and rebuilt if any of them is added later.
+         ********************************************************************************/
+        const internal::completion_trie* __get_completion_trie() const;
+
+        /*********************************************************************************
+         * Check the option token takes the next arg as value
+         ********************************************************************************/
+        bool __takes_value(const internal::arg_token &tok) const;
+
+        /*********************************************************************************
+         * Print completion candidates
+         ********************************************************************************/
+        int __print_completion(int argc, const char **argv) const;
+
+        /*********************************************************************************
+         * Suggest names close to an unknown command or option
+         * Commands are suggested from sub commands and public sub commands of the 
+         * dispatched path, options from long names and multiple characters short names.
+         ********************************************************************************/
+        void __suggest_cmd(const std::string &name, 
+                           const parse_result &res, 
+                           std::string &hint) const;
+        void __suggest_option(const internal::string_ref &name, std::string &hint) const;
 
         /*********************************************************************************
          * Get command path
          ********************************************************************************/
         std::string __get_cmd_path() const;
 
+        /*********************************************************************************
+         * Set error of run
+         * The offending arg is given by its place in the args of the run.
+         ********************************************************************************/
+        run_error& __set_error(parse_result &res, error_code code, const char **arg = NULL) const;
+
+        /*********************************************************************************
+         * Set error of option arg
+         * The option is unknown, or its value is invalid or out of range.
+         ********************************************************************************/
+        void __set_option_error(parse_status st, 
+                                const char *name, 
+                                size_t len, 
+                                const char **arg, 
+                                parse_result &res) const;
+
         /*********************************************************************************
          * Set error
          ********************************************************************************/
-        static void __set_error(command *cmd, const char *format, ...);
+        static void __set_error(std::string &err, const char *format, ...);
 
     private:
+        // Arena of command tree
+        arena *arena_;
+        // The arena is owned by this command
+        bool own_arena_;
+        // This command is placed in the arena of its parent
+        bool in_arena_;
+
         // Command name
-        std::string name_;
+        const char *name_;
         // Command desc
-        std::string desc_;
+        const char *desc_;
+
+        // Env prefix of options
+        const char *env_prefix_;
+
+        // Static definition
+        const command_def *def_;
+
+        // Sub commands of static definition
+        // Created on demand, slots are indexed as the sub commands of definition.
+        std::atomic<command*> *def_sub_cmds_;
+        std::atomic<command*> *def_public_sub_cmds_;
 
         // Parent command
+        // Public sub command's parent is the command it is added to.
         command *parent_cmd_;
         // Sub commands
         command_map sub_cmds_;
         // Public sub commands
         command_map public_sub_cmds_;
+        // Sub commands and public sub commands of factories
+        lazy_cmd_map lazy_sub_cmds_;
+        lazy_cmd_map lazy_public_sub_cmds_;
 
         // Command action callback
         action_callback action_cb_;
+        result_action_callback result_action_cb_;
+        async_action_callback async_action_cb_;
+        // Timeout of async action in milliseconds
+        unsigned timeout_ms_;
+
+        // Response files enabled
+        bool response_files_;
+        // Shell completion enabled
+        bool completion_;
+
+        // Run trace
+        trace_callback trace_cb_;
+        alloc_counter alloc_counter_;
+
+        // Config file
+        internal::config_file *config_;
+
+        // Positional arguments
+        std::vector<positional*> positionals_;
 
         // Command options
         option_vector options_;
 
-        // Command error
-        // Just root command will be setted.
+        // Bytes of typed values in parse results
+        size_t typed_size_;
+        // Command options index
+        internal::option_index options_index_;
+
+        // Completion trie, rebuilt in place once stale
+        mutable std::atomic<internal::completion_trie*> completion_trie_;
+        mutable std::atomic<bool> completion_trie_stale_;
+
+        // Scope table of sub commands
+        unsigned scope_generation_;
+        mutable std::atomic<scope_table*> scope_table_;
+
+        // Usage layout, rebuilt in place once stale
+        mutable std::atomic<usage_layout*> usage_layout_;
+        mutable std::atomic<bool> usage_layout_stale_;
+
+        // Parse result of run(argc, argv), kept for reusing its buffers
+        parse_result last_res_;
+
+        // Command error of run(argc, argv)
         std::string err_;
     };
 
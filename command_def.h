@@ -0,0 +1,339 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef easycmd_command_def_h
+#define easycmd_command_def_h
+
+#include "option.h"
+
+namespace easycmd {
+
+    class command;
+
+    /*********************************************************************************
+     * Option definition
+     * All members are literal, so a table of option definitions declared as static
+     * const data is constant initialized and needs no code to run at startup.
+     ********************************************************************************/
+    struct option_def
+    {
+        /*********************************************************************************
+         * Constructor
+         ********************************************************************************/
+        constexpr option_def(internal::option_type ot,
+                             const char *lname,
+                             const char *sname)
+          : type(ot),
+            required(true),
+            long_name(lname),
+            short_name(sname),
+            env(""),
+            desc(""),
+            i(0),
+            b(false),
+            f(0.0),
+            s(""),
+            choices(nullptr),
+            choice_count(0) {
+        }
+
+        /*********************************************************************************
+         * Set environmnet
+         ********************************************************************************/
+        constexpr option_def with_env(const char *e) const {
+            return option_def(type, required, long_name, short_name, e, desc, 
+                              i, b, f, s, choices, choice_count);
+        }
+
+        /*********************************************************************************
+         * Set desc
+         ********************************************************************************/
+        constexpr option_def with_desc(const char *d) const {
+            return option_def(type, required, long_name, short_name, env, d, 
+                              i, b, f, s, choices, choice_count);
+        }
+
+        /*********************************************************************************
+         * Set default value
+         ********************************************************************************/
+        constexpr option_def with_default(int value) const {
+            return option_def(type, false, long_name, short_name, env, desc,
+                              value, value != 0, (double)value, s, choices, choice_count);
+        }
+        constexpr option_def with_default(bool value) const {
+            return option_def(type, false, long_name, short_name, env, desc,
+                              value ? 1 : 0, value, value ? 1.0 : 0.0, s, choices, choice_count);
+        }
+        constexpr option_def with_default(double value) const {
+            return option_def(type, false, long_name, short_name, env, desc,
+                              (int)value, value != 0.0, value, s, choices, choice_count);
+        }
+        constexpr option_def with_default(const char *value) const {
+            return option_def(type, false, long_name, short_name, env, desc,
+                              i, b, f, value, choices, choice_count);
+        }
+
+        /*********************************************************************************
+         * Set accepted values of choice option
+         ********************************************************************************/
+        template <size_t N>
+        constexpr option_def with_choices(const char *const (&values)[N]) const {
+            return option_def(type, required, long_name, short_name, env, desc, 
+                              i, b, f, s, values, (int)N);
+        }
+
+        // Option type
+        internal::option_type type;
+        // Required status
+        bool required;
+        // Option long name
+        const char *long_name;
+        // Option short name
+        const char *short_name;
+        // Option env
+        const char *env;
+        // Option desc
+        const char *desc;
+        // Default values
+        int i;
+        bool b;
+        double f;
+        const char *s;
+        // Accepted values of choice option
+        const char *const *choices;
+        int choice_count;
+
+      private:
+        constexpr option_def(internal::option_type ot,
+                             bool req,
+                             const char *lname,
+                             const char *sname,
+                             const char *e,
+                             const char *d,
+                             int iv,
+                             bool bv,
+                             double fv,
+                             const char *sv,
+                             const char *const *cv,
+                             int ccnt)
+          : type(ot),
+            required(req),
+            long_name(lname),
+            short_name(sname),
+            env(e),
+            desc(d),
+            i(iv),
+            b(bv),
+            f(fv),
+            s(sv),
+            choices(cv),
+            choice_count(ccnt) {
+        }
+    };
+
+    /*********************************************************************************
+     * Command definition
+     * Sub commands are referenced through static arrays of pointers, so a whole
+     * command tree can be declared as read-only data. A command constructed from
+     * a definition only materializes the sub commands that are actually used.
+     ********************************************************************************/
+    struct command_def
+    {
+        /*********************************************************************************
+         * Command action callback
+         * This is the same type as command::action_callback.
+         ********************************************************************************/
+        typedef int(*action_callback)(const command*);
+
+        /*********************************************************************************
+         * Constructor
+         ********************************************************************************/
+        constexpr explicit command_def(const char *n)
+          : name(n),
+            desc(""),
+            action(nullptr),
+            options(nullptr),
+            option_count(0),
+            sub_cmds(nullptr),
+            sub_cmd_count(0),
+            public_sub_cmds(nullptr),
+            public_sub_cmd_count(0) {
+        }
+
+        /*********************************************************************************
+         * Set command desc
+         ********************************************************************************/
+        constexpr command_def with_desc(const char *d) const {
+            return command_def(name, d, action,
+                               options, option_count,
+                               sub_cmds, sub_cmd_count,
+                               public_sub_cmds, public_sub_cmd_count);
+        }
+
+        /*********************************************************************************
+         * Set command action function
+         ********************************************************************************/
+        constexpr command_def with_action(action_callback a) const {
+            return command_def(name, desc, a,
+                               options, option_count,
+                               sub_cmds, sub_cmd_count,
+                               public_sub_cmds, public_sub_cmd_count);
+        }
+
+        /*********************************************************************************
+         * Set command options
+         ********************************************************************************/
+        template <int N>
+        constexpr command_def with_options(const option_def (&opts)[N]) const {
+            return command_def(name, desc, action,
+                               opts, N,
+                               sub_cmds, sub_cmd_count,
+                               public_sub_cmds, public_sub_cmd_count);
+        }
+
+        /*********************************************************************************
+         * Set sub commands
+         ********************************************************************************/
+        template <int N>
+        constexpr command_def with_sub_cmds(const command_def *const (&subs)[N]) const {
+            return command_def(name, desc, action,
+                               options, option_count,
+                               subs, N,
+                               public_sub_cmds, public_sub_cmd_count);
+        }
+
+        /*********************************************************************************
+         * Set public sub commands
+         ********************************************************************************/
+        template <int N>
+        constexpr command_def with_public_sub_cmds(const command_def *const (&subs)[N]) const {
+            return command_def(name, desc, action,
+                               options, option_count,
+                               sub_cmds, sub_cmd_count,
+                               subs, N);
+        }
+
+        // Command name
+        const char *name;
+        // Command desc
+        const char *desc;
+        // Command action callback
+        action_callback action;
+        // Command options
+        const option_def *options;
+        int option_count;
+        // Sub commands
+        const command_def *const *sub_cmds;
+        int sub_cmd_count;
+        // Public sub commands
+        const command_def *const *public_sub_cmds;
+        int public_sub_cmd_count;
+
+      private:
+        constexpr command_def(const char *n,
+                              const char *d,
+                              action_callback a,
+                              const option_def *opts,
+                              int opt_cnt,
+                              const command_def *const *subs,
+                              int sub_cnt,
+                              const command_def *const *psubs,
+                              int psub_cnt)
+          : name(n),
+            desc(d),
+            action(a),
+            options(opts),
+            option_count(opt_cnt),
+            sub_cmds(subs),
+            sub_cmd_count(sub_cnt),
+            public_sub_cmds(psubs),
+            public_sub_cmd_count(psub_cnt) {
+        }
+    };
+
+    /*********************************************************************************
+     * Command factory
+     * Name and desc of a sub command with the function building its options and sub
+     * commands. The sub command is created and built the first time it is used, so
+     * commands set up in code only cost the ones on the dispatched path.
+     ********************************************************************************/
+    struct command_factory
+    {
+        /*********************************************************************************
+         * Command builder
+         * Called once with the created command, whose name and desc are already set.
+         * It may use the rest of the tree, such as usage or other sub commands, but 
+         * must not load the command being built, which waits for the builder.
+         ********************************************************************************/
+        typedef void(*builder)(command*);
+
+        /*********************************************************************************
+         * Constructor
+         ********************************************************************************/
+        constexpr command_factory(const char *n, const char *d, builder b)
+          : name(n),
+            desc(d),
+            build(b) {
+        }
+
+        // Command name
+        const char *name;
+        // Command desc
+        const char *desc;
+        // Command builder
+        builder build;
+    };
+
+    /*********************************************************************************
+     * Option definition helpers
+     ********************************************************************************/
+    constexpr option_def def_option_int(const char *long_name, const char *short_name) {
+        return option_def(internal::OP_TYPE_INT, long_name, short_name);
+    }
+    constexpr option_def def_option_bool(const char *long_name, const char *short_name) {
+        return option_def(internal::OP_TYPE_BOOL, long_name, short_name);
+    }
+    constexpr option_def def_option_float(const char *long_name, const char *short_name) {
+        return option_def(internal::OP_TYPE_FLOAT, long_name, short_name);
+    }
+    constexpr option_def def_option_string(const char *long_name, const char *short_name) {
+        return option_def(internal::OP_TYPE_STRING, long_name, short_name);
+    }
+    template <size_t N>
+    constexpr option_def def_option_choice(const char *long_name, 
+                                           const char *short_name, 
+                                           const char *const (&choices)[N]) {
+        return option_def(internal::OP_TYPE_CHOICE, long_name, short_name).with_choices(choices);
+    }
+
+    /*********************************************************************************
+     * Command definition helper
+     ********************************************************************************/
+    constexpr command_def def_command(const char *name) {
+        return command_def(name);
+    }
+
+}
+
+#endif
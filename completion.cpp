@@ -0,0 +1,421 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "command.h"
+#include "tokenizer.h"
+#include "completion.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+namespace easycmd {
+
+    namespace internal {
+
+        completion_trie::completion_trie() {
+            nodes_.push_back(__make_node(0));
+        }
+
+        void completion_trie::add(const char *str, completion_kind kind) {
+            word w;
+            w.str = str;
+            w.kind = kind;
+            words_.push_back(w);
+        }
+
+        void completion_trie::build() {
+            nodes_.resize(1);
+            nodes_[0] = __make_node(0);
+            nodes_.reserve(words_.size() * 2 + 1);
+
+            // Insert words, children are kept in character order. The path of the 
+            // previous word is kept, so the common prefix is not walked again and 
+            // words added in order are appended without scanning children.
+            std::vector<int> path(1, 0);
+            const char *prev = "";
+            for (size_t i = 0; i < words_.size(); i++) {
+                const char *str = words_[i].str;
+                size_t common = 0;
+                while (prev[common] != 0 && prev[common] == str[common]) {
+                    common++;
+                }
+
+                // Child of the previous word right after the common prefix
+                int hint = path.size() > common + 1 ? path[common + 1] : -1;
+                path.resize(common + 1);
+
+                int cur = path[common];
+                for (const char *p = str + common; *p != 0; p++) {
+                    unsigned char ch = (unsigned char)*p;
+                    int prev_child = -1;
+                    int child = nodes_[cur].child;
+                    if (hint >= 0 && (unsigned char)nodes_[hint].ch < ch) {
+                        prev_child = hint;
+                        child = nodes_[hint].sibling;
+                    }
+                    hint = -1;
+
+                    while (child >= 0 && (unsigned char)nodes_[child].ch < ch) {
+                        prev_child = child;
+                        child = nodes_[child].sibling;
+                    }
+                    if (child < 0 || (unsigned char)nodes_[child].ch != ch) {
+                        node n = __make_node(*p);
+                        n.sibling = child;
+                        child = (int)nodes_.size();
+                        nodes_.push_back(n);
+                        if (prev_child < 0) {
+                            nodes_[cur].child = child;
+                        } else {
+                            nodes_[prev_child].sibling = child;
+                        }
+                    }
+                    cur = child;
+                    path.push_back(cur);
+                }
+                prev = str;
+
+                // A word added with several kinds is kept once with all kinds
+                if (nodes_[cur].word < 0) {
+                    nodes_[cur].word = (int)i;
+                } else {
+                    words_[nodes_[cur].word].kind |= words_[i].kind;
+                }
+            }
+
+            // Words in trie order are sorted, and the words under a node are a range
+            std::vector<word> sorted;
+            sorted.reserve(words_.size());
+            __collect(0, sorted);
+            words_.swap(sorted);
+        }
+
+        void completion_trie::clear() {
+            words_.clear();
+            nodes_.resize(1);
+            nodes_[0] = __make_node(0);
+        }
+
+        completion_trie::node completion_trie::__make_node(char ch) {
+            node n;
+            n.ch = ch;
+            n.child = -1;
+            n.sibling = -1;
+            n.word = -1;
+            n.beg = 0;
+            n.end = 0;
+            return n;
+        }
+
+        void completion_trie::__collect(int idx, std::vector<word> &sorted) {
+            nodes_[idx].beg = (int)sorted.size();
+            if (nodes_[idx].word >= 0) {
+                sorted.push_back(words_[nodes_[idx].word]);
+            }
+            for (int child = nodes_[idx].child; child >= 0; child = nodes_[child].sibling) {
+                __collect(child, sorted);
+            }
+            nodes_[idx].end = (int)sorted.size();
+        }
+
+        size_t completion_trie::find(const char *prefix, 
+                                     size_t len, 
+                                     int kinds, 
+                                     size_t limit,
+                                     std::vector<const char*> &words) const {
+            int cur = 0;
+            for (size_t i = 0; i < len && cur >= 0; i++) {
+                int child = nodes_[cur].child;
+                while (child >= 0 && nodes_[child].ch != prefix[i]) {
+                    child = nodes_[child].sibling;
+                }
+                cur = child;
+            }
+            if (cur < 0) {
+                return 0;
+            }
+
+            size_t cnt = 0;
+            const node &n = nodes_[cur];
+            for (int i = n.beg; i < n.end; i++) {
+                if ((words_[i].kind & kinds) == 0) {
+                    continue;
+                }
+                if (limit > 0 && cnt >= limit) {
+                    break;
+                }
+                words.push_back(words_[i].str);
+                cnt++;
+            }
+
+            return cnt;
+        }
+
+    }
+
+    namespace internal {
+
+        static bool candidate_less(const char *a, const char *b) {
+            return strcmp(a, b) < 0;
+        }
+
+        static bool candidate_equal(const char *a, const char *b) {
+            return strcmp(a, b) == 0;
+        }
+
+        static std::string script_func_name(const std::string &name) {
+            std::string func(name);
+            for (size_t i = 0; i < func.size(); i++) {
+                if (!isalnum((unsigned char)func[i])) {
+                    func[i] = '_';
+                }
+            }
+            return func;
+        }
+
+    }
+
+    size_t command::complete(int argc, 
+                             const char **argv, 
+                             std::vector<const char*> &candidates, 
+                             size_t limit) const {
+        candidates.clear();
+        if (argc < 2) {
+            return 0;
+        }
+
+        // Walk the args as run() does, the path is kept for public sub commands
+        parse_result res;
+        __enter_path(res);
+        const command *cur = this;
+        bool opts_seen = false;
+
+        internal::arg_token tok;
+        internal::arg_token next;
+        for (int i = 1; i < argc - 1; i++) {
+            internal::tokenize_arg(argv[i], tok);
+            if (!opts_seen && tok.type == internal::ARG_COMMAND) {
+                const command *sub = cur->__dispatch_sub_cmd(argv[i], res);
+                if (sub == NULL) {
+                    return 0;
+                }
+                cur = sub;
+                cur->__enter_path(res);
+                continue;
+            }
+
+            opts_seen = true;
+            if (!cur->__takes_value(tok)) {
+                continue;
+            }
+
+            internal::tokenize_arg(argv[i + 1], next);
+            if (i + 1 == argc - 1) {
+                if (internal::is_option_token(next)) {
+                    break;
+                }
+                // Option value is completed by shell
+                return 0;
+            }
+            if (!internal::is_option_token(next)) {
+                i++;
+            }
+        }
+
+        const char *word = argv[argc - 1];
+        size_t len = strlen(word);
+        if (word[0] == '-' && strchr(word, '=') != NULL) {
+            return 0;
+        }
+
+        if (opts_seen) {
+            cur->__get_completion_trie()->find(word, len, internal::COMPLETE_OPTION, limit, candidates);
+            return candidates.size();
+        }
+
+        cur->__get_completion_trie()->find(word, len, internal::COMPLETE_ALL, limit, candidates);
+        for (size_t i = res.path_.size() - 1; i > 0; i--) {
+            size_t beg = candidates.size();
+            res.path_[i - 1]->__get_completion_trie()->find(
+                word, len, internal::COMPLETE_PUBLIC_SUB_CMD, limit, candidates);
+
+            // A public sub command doesn't complete itself
+            for (size_t j = beg; j < candidates.size(); j++) {
+                if (strcmp(candidates[j], cur->name_) == 0) {
+                    candidates.erase(candidates.begin() + j);
+                    break;
+                }
+            }
+
+            // Each trie gives sorted words, so the runs are only merged
+            std::inplace_merge(candidates.begin(), 
+                               candidates.begin() + beg, 
+                               candidates.end(), 
+                               internal::candidate_less);
+        }
+
+        candidates.erase(
+            std::unique(candidates.begin(), candidates.end(), internal::candidate_equal), 
+            candidates.end());
+        if (limit > 0 && candidates.size() > limit) {
+            candidates.resize(limit);
+        }
+
+        return candidates.size();
+    }
+
+    bool command::get_completion_script(const std::string &shell, std::string &des) const {
+        const command *root = this;
+        while (root->parent_cmd_) {
+            root = root->parent_cmd_;
+        }
+        std::string name = root->__get_cmd_path();
+        std::string func = internal::script_func_name(name);
+
+        if (shell == "bash") {
+            des.append("# bash completion for ").append(name).append("\n")
+               .append("_easycmd_").append(func).append("() {\n")
+               .append("    local IFS=$'\\n'\n")
+               .append("    COMPREPLY=($(").append(name)
+               .append(" __complete \"${COMP_WORDS[@]:1:COMP_CWORD}\" 2>/dev/null))\n")
+               .append("}\n")
+               .append("complete -o default -F _easycmd_").append(func)
+               .append(" ").append(name).append("\n");
+        } else if (shell == "zsh") {
+            des.append("#compdef ").append(name).append("\n")
+               .append("# zsh completion for ").append(name).append("\n")
+               .append("_easycmd_").append(func).append("() {\n")
+               .append("    local out\n")
+               .append("    out=\"$(").append(name)
+               .append(" __complete \"${(@)words[2,CURRENT]}\" 2>/dev/null)\"\n")
+               .append("    if [[ -n \"$out\" ]]; then\n")
+               .append("        compadd -- \"${(@f)out}\"\n")
+               .append("    else\n")
+               .append("        _files\n")
+               .append("    fi\n")
+               .append("}\n")
+               .append("compdef _easycmd_").append(func)
+               .append(" ").append(name).append("\n");
+        } else if (shell == "fish") {
+            des.append("# fish completion for ").append(name).append("\n")
+               .append("function __easycmd_").append(func).append("\n")
+               .append("    set -l words (commandline -opc) (commandline -ct)\n")
+               .append("    ").append(name)
+               .append(" __complete $words[2..-1] 2>/dev/null\n")
+               .append("end\n")
+               .append("complete -c ").append(name)
+               .append(" -f -a '(__easycmd_").append(func).append(")'\n");
+        } else {
+            return false;
+        }
+
+        return true;
+    }
+
+    const internal::completion_trie* command::__get_completion_trie() const {
+        internal::completion_trie *trie = completion_trie_.load(std::memory_order_acquire);
+        if (trie && !completion_trie_stale_.load(std::memory_order_acquire)) {
+            return trie;
+        }
+
+        std::lock_guard<std::mutex> lock(arena_->get_mutex());
+        trie = completion_trie_.load(std::memory_order_relaxed);
+        if (trie && !completion_trie_stale_.load(std::memory_order_relaxed)) {
+            return trie;
+        }
+
+        // A stale trie is refilled, nothing reads it while the command is changed
+        if (trie == NULL) {
+            trie = arena_->create<internal::completion_trie>();
+        } else {
+            trie->clear();
+        }
+        for (command_map::const_iterator it = sub_cmds_.begin(); it != sub_cmds_.end(); it++) {
+            trie->add(it->second->name_, internal::COMPLETE_SUB_CMD);
+        }
+        for (command_map::const_iterator it = public_sub_cmds_.begin(); it != public_sub_cmds_.end(); it++) {
+            trie->add(it->second->name_, internal::COMPLETE_PUBLIC_SUB_CMD);
+        }
+        for (lazy_cmd_map::const_iterator it = lazy_sub_cmds_.begin(); it != lazy_sub_cmds_.end(); it++) {
+            trie->add(it->second->name, internal::COMPLETE_SUB_CMD);
+        }
+        for (lazy_cmd_map::const_iterator it = lazy_public_sub_cmds_.begin(); it != lazy_public_sub_cmds_.end(); it++) {
+            trie->add(it->second->name, internal::COMPLETE_PUBLIC_SUB_CMD);
+        }
+        if (def_) {
+            for (int i = 0; i < def_->sub_cmd_count; i++) {
+                trie->add(def_->sub_cmds[i]->name, internal::COMPLETE_SUB_CMD);
+            }
+            for (int i = 0; i < def_->public_sub_cmd_count; i++) {
+                trie->add(def_->public_sub_cmds[i]->name, internal::COMPLETE_PUBLIC_SUB_CMD);
+            }
+        }
+
+        std::string buf;
+        for (size_t i = 0; i < options_.size(); i++) {
+            const option *opt = options_[i];
+            if (opt->long_name_[0] != 0) {
+                buf.assign("--").append(opt->long_name_);
+                trie->add(arena_->intern(buf.data(), buf.size()), internal::COMPLETE_OPTION);
+            }
+            if (opt->short_name_[0] != 0) {
+                buf.assign("-").append(opt->short_name_);
+                trie->add(arena_->intern(buf.data(), buf.size()), internal::COMPLETE_OPTION);
+            }
+        }
+
+        trie->build();
+        completion_trie_stale_.store(false, std::memory_order_release);
+        completion_trie_.store(trie, std::memory_order_release);
+
+        return trie;
+    }
+
+    bool command::__takes_value(const internal::arg_token &tok) const {
+        const option *opt = NULL;
+        if (tok.type == internal::ARG_LONG_OPTION && !tok.has_value) {
+            opt = __find_option(tok.name.data, tok.name.size);
+        } else if (tok.type == internal::ARG_SHORT_OPTION && !tok.name.empty()) {
+            // Only the last one of bundled short options takes the value
+            opt = __find_option(tok.name.data + tok.name.size - 1, 1);
+        }
+        return opt != NULL && opt->type_ != internal::OP_TYPE_BOOL;
+    }
+
+    int command::__print_completion(int argc, const char **argv) const {
+        std::vector<const char*> candidates;
+        complete(argc, argv, candidates);
+
+        std::string out;
+        for (size_t i = 0; i < candidates.size(); i++) {
+            out.append(candidates[i]).append("\n");
+        }
+        fwrite(out.data(), 1, out.size(), stdout);
+
+        return 0;
+    }
+
+}
@@ -0,0 +1,138 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef easycmd_completion_h
+#define easycmd_completion_h
+
+#include <vector>
+#include <stddef.h>
+
+namespace easycmd {
+
+    namespace internal {
+
+        /*********************************************************************************
+         * Completion word kinds
+         ********************************************************************************/
+        enum completion_kind
+        {
+            COMPLETE_SUB_CMD = 1,
+            COMPLETE_PUBLIC_SUB_CMD = 2,
+            COMPLETE_OPTION = 4,
+            COMPLETE_ALL = 7
+        };
+
+        /*********************************************************************************
+         * Completion trie
+         * Prefix trie over the words that can follow a command. After the words are
+         * inserted, they are reordered as the trie is walked, so the words under a node
+         * are a contiguous range of the sorted list and a prefix query only walks the
+         * prefix, then copies the range.
+         ********************************************************************************/
+        class completion_trie
+        {
+        public:
+            /*********************************************************************************
+             * Constructor
+             ********************************************************************************/
+            completion_trie();
+
+            /*********************************************************************************
+             * Add word
+             * The word must stay alive and unchanged while the trie is used. Words are
+             * only added before build().
+             ********************************************************************************/
+            void add(const char *word, completion_kind kind);
+
+            /*********************************************************************************
+             * Build trie
+             ********************************************************************************/
+            void build();
+
+            /*********************************************************************************
+             * Clear trie
+             * Remove all words, the storage is kept for adding words again.
+             ********************************************************************************/
+            void clear();
+
+            /*********************************************************************************
+             * Find words with prefix
+             * Only words of the kinds in the mask are appended. If limit is not zero, at
+             * most limit words are appended. Return count of appended words.
+             ********************************************************************************/
+            size_t find(const char *prefix, 
+                        size_t len, 
+                        int kinds, 
+                        size_t limit,
+                        std::vector<const char*> &words) const;
+
+            /*********************************************************************************
+             * Get word count
+             ********************************************************************************/
+            size_t size() const {
+                return words_.size();
+            }
+
+        private:
+            /*********************************************************************************
+             * Word
+             ********************************************************************************/
+            struct word {
+                const char *str;
+                int kind;
+            };
+
+            /*********************************************************************************
+             * Trie node
+             * Children are linked in character order. Once built, words of the node and 
+             * its children are words_[beg, end).
+             ********************************************************************************/
+            struct node {
+                char ch;
+                int child;
+                int sibling;
+                // Word ending at the node, -1 if none
+                int word;
+                int beg;
+                int end;
+            };
+
+            /*********************************************************************************
+             * Build helpers
+             ********************************************************************************/
+            static node __make_node(char ch);
+            void __collect(int idx, std::vector<word> &sorted);
+
+        private:
+            // Words, sorted once built
+            std::vector<word> words_;
+            // Nodes, the first one is the root
+            std::vector<node> nodes_;
+        };
+
+    }
+
+}
+
+#endif
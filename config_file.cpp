@@ -0,0 +1,243 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "config_file.h"
+
+#include <stdio.h>
+#include <stdarg.h>
+
+namespace easycmd {
+
+    namespace internal {
+
+        static void __format_error(std::string &err, const char *format, ...) {
+            va_list args;
+            va_start(args, format);
+
+            char msg[1024] = {0};
+            vsnprintf(msg, sizeof(msg) - 1, format, args);
+            err = msg;
+
+            va_end(args);
+        }
+
+        static inline bool __is_space(char c) {
+            return c == ' ' || c == '\t' || c == '\r';
+        }
+
+        static inline bool __is_comment(char c) {
+            return c == '#' || c == ';';
+        }
+
+        config_file::config_file() {
+        }
+
+        config_file::~config_file() {
+            for (size_t i = 0; i < sections_.size(); i++) {
+                delete sections_[i];
+            }
+        }
+
+        bool config_file::open(const std::string &path, std::string &err) {
+            path_ = path;
+            if (!file_.open(path.c_str())) {
+                __format_error(err, "open config file %s failed\n", path.c_str());
+                return false;
+            }
+            return __index(err);
+        }
+
+        bool config_file::__index(std::string &err) {
+            const char *data = file_.data();
+            size_t size = file_.size();
+
+            // Keys before any section header
+            config_section *sec = new config_section;
+            sec->name = string_ref();
+            sec->hash = hash_init();
+            sec->beg = 0;
+            sec->line = 1;
+            sec->parsed.store(false);
+            sections_.push_back(sec);
+
+            int line = 1;
+            for (size_t pos = 0; pos < size; line++) {
+                const char *eol = (const char*)memchr(data + pos, '\n', size - pos);
+                size_t next = eol ? (size_t)(eol - data) + 1 : size;
+                size_t end = eol ? next - 1 : size;
+
+                size_t p = pos;
+                while (p < end && __is_space(data[p])) {
+                    p++;
+                }
+                if (p == end || data[p] != '[') {
+                    pos = next;
+                    continue;
+                }
+
+                // Only a comment may follow the header
+                const char *close = (const char*)memchr(data + p, ']', end - p);
+                size_t q = close ? (size_t)(close - data) + 1 : end;
+                while (q < end && __is_space(data[q])) {
+                    q++;
+                }
+                if (close == NULL || (q < end && !__is_comment(data[q]))) {
+                    __format_error(err, "invalid section at line %d of config file %s\n", line, path_.c_str());
+                    return false;
+                }
+
+                size_t nbeg = p + 1;
+                size_t nend = (size_t)(close - data);
+                while (nbeg < nend && __is_space(data[nbeg])) {
+                    nbeg++;
+                }
+                while (nend > nbeg && __is_space(data[nend - 1])) {
+                    nend--;
+                }
+                string_ref name(data + nbeg, nend - nbeg);
+                if (name.empty()) {
+                    __format_error(err, "invalid section at line %d of config file %s\n", line, path_.c_str());
+                    return false;
+                }
+
+                size_t hash = hash_append(hash_init(), false, name);
+                for (size_t i = 0; i < sections_.size(); i++) {
+                    if (sections_[i]->hash == hash && sections_[i]->name.equal(name.data, name.size)) {
+                        __format_error(err, "duplicate section %.*s at line %d of config file %s\n", 
+                                       (int)name.size, name.data, line, path_.c_str());
+                        return false;
+                    }
+                }
+
+                sec->end = pos;
+                sec = new config_section;
+                sec->name = name;
+                sec->hash = hash;
+                sec->beg = next;
+                sec->line = line + 1;
+                sec->parsed.store(false);
+                sections_.push_back(sec);
+
+                pos = next;
+            }
+            sec->end = size;
+
+            return true;
+        }
+
+        bool config_file::__get(config_section *sec, std::string &err) {
+            if (!sec->parsed.load(std::memory_order_acquire)) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!sec->parsed.load(std::memory_order_relaxed)) {
+                    __parse(sec);
+                    sec->parsed.store(true, std::memory_order_release);
+                }
+            }
+
+            if (!sec->err.empty()) {
+                err = sec->err;
+                return false;
+            }
+            return true;
+        }
+
+        void config_file::__parse(config_section *sec) {
+            char *data = file_.data();
+
+            int line = sec->line;
+            for (size_t pos = sec->beg; pos < sec->end; line++) {
+                const char *eol = (const char*)memchr(data + pos, '\n', sec->end - pos);
+                size_t next = eol ? (size_t)(eol - data) + 1 : sec->end;
+                size_t end = eol ? next - 1 : sec->end;
+                size_t p = pos;
+                pos = next;
+
+                while (p < end && __is_space(data[p])) {
+                    p++;
+                }
+                if (p == end || __is_comment(data[p])) {
+                    continue;
+                }
+
+                const char *eq = (const char*)memchr(data + p, '=', end - p);
+                size_t kend = eq ? (size_t)(eq - data) : p;
+                while (kend > p && __is_space(data[kend - 1])) {
+                    kend--;
+                }
+                if (kend == p) {
+                    __format_error(sec->err, "invalid line %d of config file %s\n", line, path_.c_str());
+                    return;
+                }
+
+                size_t vbeg = (size_t)(eq - data) + 1;
+                while (vbeg < end && __is_space(data[vbeg])) {
+                    vbeg++;
+                }
+                size_t vend = end;
+                if (vbeg < end && (data[vbeg] == '"' || data[vbeg] == '\'')) {
+                    // Quoted value keeps all characters, there are no escapes
+                    const char *quote = (const char*)memchr(data + vbeg + 1, data[vbeg], end - vbeg - 1);
+                    if (quote == NULL) {
+                        __format_error(sec->err, "unterminated quote at line %d of config file %s\n", line, path_.c_str());
+                        return;
+                    }
+                    vbeg++;
+                    vend = (size_t)(quote - data);
+
+                    size_t q = vend + 1;
+                    while (q < end && __is_space(data[q])) {
+                        q++;
+                    }
+                    if (q < end && !__is_comment(data[q])) {
+                        __format_error(sec->err, "invalid line %d of config file %s\n", line, path_.c_str());
+                        return;
+                    }
+                } else {
+                    // A '#' after a space starts a comment
+                    for (size_t q = vbeg; q < end; q++) {
+                        if (data[q] == '#' && (q == vbeg || __is_space(data[q - 1]))) {
+                            vend = q;
+                            break;
+                        }
+                    }
+                    while (vend > vbeg && __is_space(data[vend - 1])) {
+                        vend--;
+                    }
+                }
+
+                // Terminate in place, the bytes after key and value are not used
+                data[kend] = 0;
+                data[vend] = 0;
+
+                config_entry entry;
+                entry.key = string_ref(data + p, kend - p);
+                entry.value = string_ref(data + vbeg, vend - vbeg);
+                entry.line = line;
+                sec->entries.push_back(entry);
+            }
+        }
+
+    }
+
+}
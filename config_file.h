@@ -0,0 +1,212 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef easycmd_config_file_h
+#define easycmd_config_file_h
+
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <stddef.h>
+#include <string.h>
+
+#include "string_ref.h"
+#include "response_file.h"
+
+namespace easycmd {
+
+    namespace internal {
+
+        /*********************************************************************************
+         * Config entry
+         * Key and value point into the mapped file and are null terminated.
+         ********************************************************************************/
+        struct config_entry
+        {
+            string_ref key;
+            string_ref value;
+            int line;
+        };
+
+        /*********************************************************************************
+         * Config section
+         * Entries are parsed when the section is used the first time.
+         ********************************************************************************/
+        struct config_section
+        {
+            // Sub command path joined by '.', empty for keys before any section
+            string_ref name;
+            size_t hash;
+            // Content after the header line
+            size_t beg;
+            size_t end;
+            int line;
+
+            std::atomic<bool> parsed;
+            std::vector<config_entry> entries;
+            std::string err;
+        };
+
+        /*********************************************************************************
+         * Config file
+         * INI file, or the TOML subset of tables and plain key/value pairs:
+         *
+         *   # comment
+         *   key = value
+         *   [sub.sub2]
+         *   key = "quoted value"
+         *
+         * The file is mapped and only the section headers are indexed when it is 
+         * opened. The entries of a section are parsed in place once, when a command 
+         * line dispatched to it is run. A section can be used by concurrent runs.
+         ********************************************************************************/
+        class config_file
+        {
+        public:
+            /*********************************************************************************
+             * Constructor
+             ********************************************************************************/
+            config_file();
+
+            /*********************************************************************************
+             * Deconstructor
+             ********************************************************************************/
+            ~config_file();
+
+            /*********************************************************************************
+             * Open file
+             ********************************************************************************/
+            bool open(const std::string &path, std::string &err);
+
+            /*********************************************************************************
+             * Get path
+             ********************************************************************************/
+            const std::string& path() const {
+                return path_;
+            }
+
+            /*********************************************************************************
+             * Find section
+             * The name is given as cnt parts which are joined by '.', parts[i] must be
+             * a string_ref. The section is null if it is not in the file. Return false 
+             * if the entries of the section are invalid.
+             ********************************************************************************/
+            template <typename Parts>
+            bool find(const Parts &parts, 
+                      size_t cnt, 
+                      const config_section *&sec, 
+                      std::string &err) {
+                size_t hash = hash_init();
+                for (size_t i = 0; i < cnt; i++) {
+                    hash = hash_append(hash, i > 0, parts[i]);
+                }
+
+                config_section *match = NULL;
+                for (size_t i = 0; i < sections_.size() && match == NULL; i++) {
+                    if (sections_[i]->hash != hash) {
+                        continue;
+                    }
+                    // Compare the parts with the dotted name
+                    string_ref name = sections_[i]->name;
+                    size_t off = 0;
+                    size_t j = 0;
+                    for (; j < cnt; j++) {
+                        string_ref part = parts[j];
+                        if (j > 0 && (off == name.size || name.data[off++] != '.')) {
+                            break;
+                        }
+                        if (name.size - off < part.size || 
+                            memcmp(name.data + off, part.data, part.size) != 0) {
+                            break;
+                        }
+                        off += part.size;
+                    }
+                    if (j == cnt && off == name.size) {
+                        match = sections_[i];
+                    }
+                }
+
+                sec = match;
+                return match == NULL || __get(match, err);
+            }
+
+            /*********************************************************************************
+             * Hash section name
+             ********************************************************************************/
+            static size_t hash_init() {
+                return (size_t)14695981039346656037ULL;
+            }
+            static size_t hash_append(size_t hash, bool dot, const string_ref &part) {
+                if (dot) {
+                    hash = (hash ^ (unsigned char)'.') * (size_t)1099511628211ULL;
+                }
+                for (size_t i = 0; i < part.size; i++) {
+                    hash = (hash ^ (unsigned char)part.data[i]) * (size_t)1099511628211ULL;
+                }
+                return hash;
+            }
+
+        private:
+            /*********************************************************************************
+             * Disable copy
+             ********************************************************************************/
+            config_file(const config_file&);
+            config_file& operator=(const config_file&);
+
+            /*********************************************************************************
+             * Index section headers
+             ********************************************************************************/
+            bool __index(std::string &err);
+
+            /*********************************************************************************
+             * Get section entries
+             * Entries are parsed by the first caller. Return false if they are invalid.
+             ********************************************************************************/
+            bool __get(config_section *sec, std::string &err);
+
+            /*********************************************************************************
+             * Parse section entries
+             ********************************************************************************/
+            void __parse(config_section *sec);
+
+        private:
+            // File path
+            std::string path_;
+
+            // Content
+            mapped_file file_;
+
+            // Sections in file order
+            std::vector<config_section*> sections_;
+
+            // Parse mutex
+            std::mutex mutex_;
+        };
+
+    }
+
+}
+
+#endif
@@ -0,0 +1,401 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "async.h"
+#include "daemon.h"
+#include "command.h"
+
+#if !defined(WIN32)
+#include <poll.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/un.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#if !defined(__APPLE__) && !defined(__FreeBSD__) && !defined(__NetBSD__) && \
+    !defined(__OpenBSD__) && !defined(__DragonFly__)
+#include <stdio_ext.h>
+#endif
+
+extern char **environ;
+#endif
+
+namespace easycmd {
+
+#if !defined(WIN32)
+    namespace internal
+    {
+        // Interval of checking the cancel token while waiting for clients
+        static const int daemon_poll_ms = 100;
+
+        // A client must send each part of its request within this time, the daemon
+        // serves one client at a time
+        static const int daemon_recv_timeout_ms = 5000;
+
+        // A client gone away must not kill the daemon with SIGPIPE
+#if defined(MSG_NOSIGNAL)
+        static const int daemon_send_flags = MSG_NOSIGNAL;
+#else
+        static const int daemon_send_flags = 0;
+#endif
+
+#if defined(MSG_CMSG_CLOEXEC)
+        static const int daemon_recv_flags = MSG_CMSG_CLOEXEC;
+#else
+        static const int daemon_recv_flags = 0;
+#endif
+
+        static int daemon_socket(const std::string &path, sockaddr_un &addr) {
+            if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+                errno = ENAMETOOLONG;
+                return -1;
+            }
+            memset(&addr, 0, sizeof(addr));
+            addr.sun_family = AF_UNIX;
+            memcpy(addr.sun_path, path.data(), path.size());
+
+            int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+            if (fd >= 0) {
+                fcntl(fd, F_SETFD, FD_CLOEXEC);
+            }
+            return fd;
+        }
+
+        // Only processes of the user running the daemon are served, the runs get the
+        // rights of the daemon
+        static bool daemon_peer_allowed(int fd) {
+#if defined(SO_PEERCRED)
+            ucred cred;
+            socklen_t len = sizeof(cred);
+            if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) != 0 || len != sizeof(cred)) {
+                return false;
+            }
+            return cred.uid == geteuid();
+#else
+            uid_t uid;
+            gid_t gid;
+            return getpeereid(fd, &uid, &gid) == 0 && uid == geteuid();
+#endif
+        }
+
+        static bool daemon_set_recv_timeout(int fd, int ms) {
+            timeval tv;
+            tv.tv_sec = ms / 1000;
+            tv.tv_usec = (ms % 1000) * 1000;
+            return setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) == 0;
+        }
+
+        // Input of a client left in the buffer of stdin must not be read by the run of
+        // the next client
+        static void daemon_purge_stdin() {
+#if defined(__APPLE__) || defined(__FreeBSD__) || defined(__NetBSD__) || \
+    defined(__OpenBSD__) || defined(__DragonFly__)
+            fpurge(stdin);
+#else
+            __fpurge(stdin);
+#endif
+            clearerr(stdin);
+        }
+
+        static bool daemon_send(int fd, const void *data, size_t len) {
+            const char *p = (const char*)data;
+            while (len > 0) {
+                ssize_t n = send(fd, p, len, daemon_send_flags);
+                if (n < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    return false;
+                }
+                p += n;
+                len -= (size_t)n;
+            }
+            return true;
+        }
+
+        static bool daemon_recv(int fd, void *data, size_t len) {
+            char *p = (char*)data;
+            while (len > 0) {
+                ssize_t n = recv(fd, p, len, 0);
+                if (n < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (n <= 0) {
+                    return false;
+                }
+                p += n;
+                len -= (size_t)n;
+            }
+            return true;
+        }
+    }
+
+    bool forward_to_daemon(const std::string &path, int argc, const char **argv, int &ret) {
+        sockaddr_un addr;
+        int fd = internal::daemon_socket(path, addr);
+        if (fd < 0) {
+            return false;
+        }
+        if (connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+            close(fd);
+            return false;
+        }
+
+        char cwd[PATH_MAX];
+        if (getcwd(cwd, sizeof(cwd)) == NULL) {
+            cwd[0] = 0;
+        }
+        std::string body;
+        body.append(cwd, strlen(cwd) + 1);
+        for (int i = 0; i < argc; i++) {
+            body.append(argv[i], strlen(argv[i]) + 1);
+        }
+        uint32_t envc = 0;
+        for (char **env = environ; env != NULL && *env != NULL; env++, envc++) {
+            body.append(*env, strlen(*env) + 1);
+        }
+
+        internal::daemon_request req;
+        req.magic = internal::DAEMON_MAGIC;
+        req.argc = (uint32_t)argc;
+        req.envc = envc;
+        req.size = (uint32_t)body.size();
+
+        // Stdio of the process is attached to the header
+        int fds[3] = { STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO };
+        union {
+            char buf[CMSG_SPACE(sizeof(fds))];
+            cmsghdr align;
+        } ctrl;
+        memset(&ctrl, 0, sizeof(ctrl));
+        iovec iov;
+        iov.iov_base = &req;
+        iov.iov_len = sizeof(req);
+        msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = ctrl.buf;
+        msg.msg_controllen = sizeof(ctrl.buf);
+        cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+        memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+        ssize_t n;
+        do {
+            n = sendmsg(fd, &msg, internal::daemon_send_flags);
+        } while (n < 0 && errno == EINTR);
+        bool ok = n > 0 && 
+                  internal::daemon_send(fd, (const char*)&req + n, sizeof(req) - (size_t)n) &&
+                  internal::daemon_send(fd, body.data(), body.size());
+        if (!ok) {
+            close(fd);
+            return false;
+        }
+
+        int32_t r = 0;
+        ret = internal::daemon_recv(fd, &r, sizeof(r)) ? r : -1;
+        close(fd);
+
+        return true;
+    }
+
+    bool command::serve(const std::string &path, cancel_token &token, std::string &err) const {
+        sockaddr_un addr;
+        int fd = internal::daemon_socket(path, addr);
+        if (fd < 0) {
+            __set_error(err, "create socket %s failed: %s", path.c_str(), strerror(errno));
+            return false;
+        }
+
+        // A socket file nobody listens on is left by a daemon gone away
+        if (connect(fd, (sockaddr*)&addr, sizeof(addr)) == 0) {
+            close(fd);
+            __set_error(err, "a daemon is listening on %s", path.c_str());
+            return false;
+        }
+        close(fd);
+        unlink(path.c_str());
+
+        fd = internal::daemon_socket(path, addr);
+        if (fd < 0 || bind(fd, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, 64) != 0) {
+            __set_error(err, "listen on %s failed: %s", path.c_str(), strerror(errno));
+            if (fd >= 0) {
+                close(fd);
+            }
+            return false;
+        }
+
+        int cwd_fd = open(".", O_RDONLY | O_CLOEXEC);
+        internal::signal_scope signals;
+        parse_result res;
+        while (!token.is_cancelled()) {
+            pollfd pfd;
+            pfd.fd = fd;
+            pfd.events = POLLIN;
+            pfd.revents = 0;
+            int n = poll(&pfd, 1, internal::daemon_poll_ms);
+            if (signals.is_received()) {
+                token.cancel(CANCEL_SIGNAL);
+                break;
+            }
+            if (n <= 0) {
+                continue;
+            }
+
+            int client = accept(fd, NULL, NULL);
+            if (client >= 0) {
+                fcntl(client, F_SETFD, FD_CLOEXEC);
+                if (internal::daemon_peer_allowed(client) && 
+                    internal::daemon_set_recv_timeout(client, internal::daemon_recv_timeout_ms)) {
+                    __serve_client(client, cwd_fd, res);
+                }
+                close(client);
+            }
+        }
+
+        if (cwd_fd >= 0) {
+            close(cwd_fd);
+        }
+        close(fd);
+        unlink(path.c_str());
+
+        return true;
+    }
+
+    void command::__serve_client(int fd, int cwd_fd, parse_result &res) const {
+        internal::daemon_request req;
+        int fds[3] = { -1, -1, -1 };
+        union {
+            char buf[CMSG_SPACE(sizeof(fds))];
+            cmsghdr align;
+        } ctrl;
+        iovec iov;
+        iov.iov_base = &req;
+        iov.iov_len = sizeof(req);
+        msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = ctrl.buf;
+        msg.msg_controllen = sizeof(ctrl.buf);
+
+        ssize_t n;
+        do {
+            n = recvmsg(fd, &msg, internal::daemon_recv_flags);
+        } while (n < 0 && errno == EINTR);
+        if (n > 0) {
+            for (cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+                if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+                    size_t cnt = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+                    memcpy(fds, CMSG_DATA(cmsg), (cnt < 3 ? cnt : 3) * sizeof(int));
+                }
+            }
+        }
+
+        bool ok = n > 0 && 
+                  internal::daemon_recv(fd, (char*)&req + n, sizeof(req) - (size_t)n) &&
+                  req.magic == internal::DAEMON_MAGIC && 
+                  req.argc > 0 &&
+                  req.size <= internal::DAEMON_MAX_REQUEST &&
+                  fds[0] >= 0 && fds[1] >= 0 && fds[2] >= 0;
+
+        // cwd, args and env
+        std::vector<char> body;
+        std::vector<const char*> strs;
+        if (ok) {
+            body.resize(req.size + 1);
+            ok = internal::daemon_recv(fd, &body[0], req.size);
+            body[req.size] = 0;
+            for (size_t i = 0; ok && i < req.size; i += strlen(&body[i]) + 1) {
+                strs.push_back(&body[i]);
+            }
+            ok = ok && strs.size() == 1 + (size_t)req.argc + req.envc;
+        }
+        if (!ok) {
+            for (int i = 0; i < 3; i++) {
+                if (fds[i] >= 0) {
+                    close(fds[i]);
+                }
+            }
+            return;
+        }
+        strs.push_back(NULL);
+
+        // Stdio and cwd are process wide, so one client is served at a time
+        fflush(stdout);
+        fflush(stderr);
+        int saved[3];
+        for (int i = 0; i < 3; i++) {
+            saved[i] = fcntl(i, F_DUPFD_CLOEXEC, 3);
+            dup2(fds[i], i);
+            close(fds[i]);
+        }
+
+        int32_t ret = -1;
+        if (chdir(strs[0]) != 0) {
+            fprintf(stderr, "change directory to %s failed: %s\n", strs[0], strerror(errno));
+        } else {
+            res.set_env(&strs[1 + req.argc]);
+            ret = run((int)req.argc, &strs[1], res);
+            if (ret != 0 && res.get_error().get_code() != ERR_NONE) {
+                fputs(res.get_err().c_str(), stderr);
+            }
+            res.set_env(NULL);
+            res.clear();
+        }
+        fflush(stdout);
+        fflush(stderr);
+        internal::daemon_purge_stdin();
+
+        if (cwd_fd >= 0 && fchdir(cwd_fd) != 0) {
+            fprintf(stderr, "change back to served directory failed: %s\n", strerror(errno));
+        }
+        for (int i = 0; i < 3; i++) {
+            if (saved[i] >= 0) {
+                dup2(saved[i], i);
+                close(saved[i]);
+            } else {
+                close(i);
+            }
+        }
+
+        internal::daemon_send(fd, &ret, sizeof(ret));
+    }
+#else
+    bool forward_to_daemon(const std::string &path, int argc, const char **argv, int &ret) {
+        return false;
+    }
+
+    bool command::serve(const std::string &path, cancel_token &token, std::string &err) const {
+        err = "daemon is not supported on windows";
+        return false;
+    }
+#endif
+
+}
@@ -0,0 +1,70 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef easycmd_daemon_h
+#define easycmd_daemon_h
+
+#include <string>
+#include <stdint.h>
+
+namespace easycmd {
+
+    namespace internal {
+
+        /*********************************************************************************
+         * Daemon protocol
+         * The client sends a request header with its stdin, stdout and stderr attached
+         * as SCM_RIGHTS, then cwd, args and env as null terminated strings. The server
+         * runs the args with them and answers with the return value as int32.
+         ********************************************************************************/
+        enum
+        {
+            DAEMON_MAGIC = 0x31444345, // "ECD1"
+            DAEMON_MAX_REQUEST = 16 * 1024 * 1024
+        };
+
+        struct daemon_request
+        {
+            uint32_t magic;
+            uint32_t argc;
+            uint32_t envc;
+            // Bytes of strings following the header
+            uint32_t size;
+        };
+
+    }
+
+    /*********************************************************************************
+     * Forward a run to a daemon
+     * Sends the args, the process environment, the cwd and the stdio of the process
+     * to the command served on the Unix socket path, see command::serve, and waits
+     * for the return value. Return false if no daemon is listening there, so the
+     * caller can run the command itself. If the daemon goes away during the run, 
+     * ret is -1.
+     ********************************************************************************/
+    bool forward_to_daemon(const std::string &path, int argc, const char **argv, int &ret);
+
+}
+
+#endif
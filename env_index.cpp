@@ -0,0 +1,125 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "env_index.h"
+
+#include <string.h>
+#include <stdlib.h>
+
+#if defined(WIN32)
+#define environ _environ
+#else
+extern char **environ;
+#endif
+
+namespace easycmd {
+
+    namespace internal {
+
+        env_index::env_index()
+          : mask_(0),
+            size_(0),
+            built_(false) {
+        }
+
+        void env_index::build(const char *const *envp) {
+            if (envp == NULL) {
+                envp = environ;
+            }
+
+            size_t cnt = 0;
+            for (const char *const *env = envp; env != NULL && *env != NULL; env++) {
+                cnt++;
+            }
+
+            // Keep the load factor at most one half
+            size_t cap = 16;
+            while (cap < cnt * 2) {
+                cap *= 2;
+            }
+            slot empty = { NULL, 0, 0 };
+            if (slots_.size() != cap) {
+                slots_.resize(cap);
+            }
+            for (size_t i = 0; i < cap; i++) {
+                slots_[i] = empty;
+            }
+            mask_ = cap - 1;
+            size_ = 0;
+
+            for (const char *const *env = envp; env != NULL && *env != NULL; env++) {
+                const char *entry = *env;
+                const char *eq = strchr(entry, '=');
+                if (eq == NULL) {
+                    continue;
+                }
+
+                size_t len = (size_t)(eq - entry);
+                size_t h = hash(entry, len);
+                size_t i = h & mask_;
+                for (; slots_[i].entry != NULL; i = (i + 1) & mask_) {
+                    if (slots_[i].hash == h && 
+                        slots_[i].name_len == len && 
+                        memcmp(slots_[i].entry, entry, len) == 0) {
+                        break;
+                    }
+                }
+                if (slots_[i].entry == NULL) {
+                    slots_[i].entry = entry;
+                    slots_[i].name_len = len;
+                    slots_[i].hash = h;
+                    size_++;
+                }
+            }
+
+            built_ = true;
+        }
+
+        const char* env_index::find(const char *name, size_t len) const {
+            if (slots_.empty()) {
+                return NULL;
+            }
+
+            size_t h = hash(name, len);
+            for (size_t i = h & mask_; slots_[i].entry != NULL; i = (i + 1) & mask_) {
+                const slot &s = slots_[i];
+                if (s.hash == h && s.name_len == len && memcmp(s.entry, name, len) == 0) {
+                    return s.entry + len + 1;
+                }
+            }
+
+            return NULL;
+        }
+
+        size_t env_index::hash(const char *name, size_t len) {
+            size_t h = (size_t)14695981039346656037ULL;
+            for (size_t i = 0; i < len; i++) {
+                h = (h ^ (unsigned char)name[i]) * (size_t)1099511628211ULL;
+            }
+            return h;
+        }
+
+    }
+
+}
@@ -0,0 +1,113 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef easycmd_env_index_h
+#define easycmd_env_index_h
+
+#include <vector>
+#include <stddef.h>
+
+namespace easycmd {
+
+    namespace internal {
+
+        /*********************************************************************************
+         * Environment index
+         * Hashed snapshot of the environment. Names and values point into the env 
+         * strings, so the environment must not be changed while the index is used. 
+         * Storage is kept by reset for the next build.
+         ********************************************************************************/
+        class env_index
+        {
+        public:
+            /*********************************************************************************
+             * Constructor
+             ********************************************************************************/
+            env_index();
+
+            /*********************************************************************************
+             * Build index of environment
+             * env is a null terminated array of "name=value" strings, the process 
+             * environment if env is null. The first one of duplicated names is used, 
+             * like getenv.
+             ********************************************************************************/
+            void build(const char *const *env = NULL);
+
+            /*********************************************************************************
+             * Check the index is built
+             ********************************************************************************/
+            bool is_built() const {
+                return built_;
+            }
+
+            /*********************************************************************************
+             * Get count of indexed names
+             ********************************************************************************/
+            size_t size() const {
+                return size_;
+            }
+
+            /*********************************************************************************
+             * Reset index
+             ********************************************************************************/
+            void reset() {
+                built_ = false;
+            }
+
+            /*********************************************************************************
+             * Find value of name
+             * Return null if the name is not in the environment.
+             ********************************************************************************/
+            const char* find(const char *name, size_t len) const;
+
+            /*********************************************************************************
+             * Hash name
+             ********************************************************************************/
+            static size_t hash(const char *name, size_t len);
+
+        private:
+            struct slot
+            {
+                // Env string "name=value", null for empty slot
+                const char *entry;
+                size_t name_len;
+                size_t hash;
+            };
+
+        private:
+            // Open addressing slots, the count is a power of 2
+            std::vector<slot> slots_;
+            size_t mask_;
+            // Count of indexed names
+            size_t size_;
+
+            // Built status
+            bool built_;
+        };
+
+    }
+
+}
+
+#endif
@@ -0,0 +1,80 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "memory_report.h"
+
+#include <stdio.h>
+
+namespace easycmd {
+
+    void memory_report::clear() {
+        commands = 0;
+        options = 0;
+        positionals = 0;
+        arena_footprint = 0;
+        arena_used = 0;
+        string_bytes = 0;
+        interned_bytes = 0;
+        interned_strings = 0;
+    }
+
+    void memory_report::to_json(std::string &des) const {
+        char buf[128];
+        const struct {
+            const char *name;
+            size_t value;
+        } counts[] = {
+            { "commands", commands },
+            { "options", options },
+            { "positionals", positionals },
+            { "arena_footprint", arena_footprint },
+            { "arena_used", arena_used },
+            { "string_bytes", string_bytes },
+            { "interned_bytes", interned_bytes },
+            { "interned_strings", interned_strings },
+        };
+        des.append("{");
+        for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+            snprintf(buf, sizeof(buf), "%s\"%s\": %llu", 
+                     i > 0 ? ", " : "", counts[i].name, (unsigned long long)counts[i].value);
+            des.append(buf);
+        }
+
+        const struct {
+            const char *name;
+            size_t cnt;
+        } per[] = {
+            { "bytes_per_command", commands },
+            { "bytes_per_option", options },
+        };
+        for (size_t i = 0; i < sizeof(per) / sizeof(per[0]); i++) {
+            double cnt = per[i].cnt > 0 ? (double)per[i].cnt : 1.0;
+            snprintf(buf, sizeof(buf), ", \"%s\": {\"before\": %.1f, \"after\": %.1f}", 
+                     per[i].name, used_without_interning() / cnt, arena_used / cnt);
+            des.append(buf);
+        }
+        des.append("}");
+    }
+
+}
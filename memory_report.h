@@ -0,0 +1,85 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef easycmd_memory_report_h
+#define easycmd_memory_report_h
+
+#include <string>
+#include <stddef.h>
+
+namespace easycmd {
+
+    /*********************************************************************************
+     * Memory report
+     * Memory of the commands placed in one arena. Names, descs and defaults are 
+     * interned, string_bytes is what they would take stored one by one and 
+     * interned_bytes is what they take. Commands of definitions and factories that
+     * are not created yet are not counted.
+     ********************************************************************************/
+    struct memory_report
+    {
+        // Commands, options and positional arguments in the arena
+        size_t commands;
+        size_t options;
+        size_t positionals;
+
+        // Bytes of arena blocks, and bytes handed out of them
+        size_t arena_footprint;
+        size_t arena_used;
+
+        // Bytes of strings before and after interning
+        size_t string_bytes;
+        size_t interned_bytes;
+        // Count of distinct strings
+        size_t interned_strings;
+
+        /*********************************************************************************
+         * Constructor
+         ********************************************************************************/
+        memory_report() {
+            clear();
+        }
+
+        /*********************************************************************************
+         * Clear
+         ********************************************************************************/
+        void clear();
+
+        /*********************************************************************************
+         * Get arena bytes without interning
+         ********************************************************************************/
+        size_t used_without_interning() const {
+            return arena_used + string_bytes - interned_bytes;
+        }
+
+        /*********************************************************************************
+         * Append report as JSON object
+         * Bytes per command and per option are given before and after interning.
+         ********************************************************************************/
+        void to_json(std::string &des) const;
+    };
+
+}
+
+#endif
@@ -0,0 +1,356 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "number.h"
+
+#include <errno.h>
+#include <math.h>
+#include <locale.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+
+// Eight digits are checked and converted at once in a 64 bit word, the byte 
+// order must be little endian.
+#if (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) || \
+    defined(_M_IX86) || defined(_M_X64) || defined(_M_ARM64)
+#define EASYCMD_SWAR_DIGITS 1
+#endif
+
+namespace easycmd {
+
+    namespace internal {
+
+        // Decimal digits of uint64_t that can never overflow
+        static const int MAX_SAFE_DIGITS = 19;
+
+#if defined(EASYCMD_SWAR_DIGITS)
+        static inline bool __is_eight_digits(uint64_t v) {
+            return ((v & 0xF0F0F0F0F0F0F0F0ULL) | 
+                    (((v + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) == 0x3333333333333333ULL;
+        }
+
+        static inline uint32_t __eight_digits(uint64_t v) {
+            v -= 0x3030303030303030ULL;
+            v = (v * 10) + (v >> 8);
+            v = (((v & 0x000000FF000000FFULL) * 0x000F424000000064ULL) + 
+                 (((v >> 16) & 0x000000FF000000FFULL) * 0x0000271000000001ULL)) >> 32;
+            return (uint32_t)v;
+        }
+#endif
+
+        static inline int __digit_value(char c) {
+            if (c >= '0' && c <= '9') {
+                return c - '0';
+            }
+            c |= 0x20;
+            if (c >= 'a' && c <= 'f') {
+                return c - 'a' + 10;
+            }
+            return 16;
+        }
+
+        /*********************************************************************************
+         * Parse decimal digits from s[i], the first MAX_SAFE_DIGITS digits are 
+         * accumulated and the others are only counted.
+         ********************************************************************************/
+        static inline size_t __parse_decimal(const char *s, 
+                                             size_t len, 
+                                             size_t i, 
+                                             uint64_t &acc, 
+                                             int &digits) {
+#if defined(EASYCMD_SWAR_DIGITS)
+            while (i + 8 <= len) {
+                uint64_t v;
+                memcpy(&v, s + i, 8);
+                if (digits + 8 > MAX_SAFE_DIGITS || !__is_eight_digits(v)) {
+                    break;
+                }
+                acc = acc * 100000000 + __eight_digits(v);
+                digits += 8;
+                i += 8;
+            }
+#endif
+            for (; i < len; i++) {
+                unsigned d = (unsigned)(s[i] - '0');
+                if (d > 9) {
+                    break;
+                }
+                if (++digits <= MAX_SAFE_DIGITS) {
+                    acc = acc * 10 + d;
+                }
+            }
+            return i;
+        }
+
+        static parse_status __parse_uint64(const char *s, size_t len, uint64_t limit, uint64_t &value) {
+            if (len == 0) {
+                return PARSE_INVALID;
+            }
+
+            size_t i = 0;
+            int base = 10;
+            if (len > 2 && s[0] == '0') {
+                char c = s[1] | 0x20;
+                base = c == 'x' ? 16 : (c == 'o' ? 8 : (c == 'b' ? 2 : 10));
+                i = base == 10 ? 0 : 2;
+            }
+
+            uint64_t acc = 0;
+            bool overflow = false;
+            if (base != 10) {
+                for (; i < len; i++) {
+                    int d = __digit_value(s[i]);
+                    if (d >= base) {
+                        return PARSE_INVALID;
+                    }
+                    if (acc > (limit - (uint64_t)d) / (uint64_t)base) {
+                        overflow = true;
+                    } else {
+                        acc = acc * (uint64_t)base + (uint64_t)d;
+                    }
+                }
+            } else {
+                // Leading zeros are not significant
+                while (i < len && s[i] == '0') {
+                    i++;
+                }
+                int digits = 0;
+                size_t sig = i;
+                if (__parse_decimal(s, len, i, acc, digits) != len) {
+                    return PARSE_INVALID;
+                }
+                if (digits == MAX_SAFE_DIGITS + 1) {
+                    // The last digit of a 20 digit number may still fit
+                    uint64_t d = (uint64_t)(s[sig + MAX_SAFE_DIGITS] - '0');
+                    overflow = acc > (limit - d) / 10;
+                    acc = acc * 10 + d;
+                } else {
+                    overflow = digits > MAX_SAFE_DIGITS + 1 || acc > limit;
+                }
+            }
+            if (overflow) {
+                return PARSE_OVERFLOW;
+            }
+
+            value = acc;
+            return PARSE_OK;
+        }
+
+        parse_status parse_int64(const char *s, size_t len, int64_t &value) {
+            bool neg = false;
+            if (len > 0 && (s[0] == '-' || s[0] == '+')) {
+                neg = s[0] == '-';
+                s++;
+                len--;
+            }
+
+            const uint64_t max = (uint64_t)INT64_MAX;
+            uint64_t mag = 0;
+            parse_status st = __parse_uint64(s, len, neg ? max + 1 : max, mag);
+            if (st != PARSE_OK) {
+                return st;
+            }
+
+            if (!neg) {
+                value = (int64_t)mag;
+            } else if (mag == max + 1) {
+                value = INT64_MIN;
+            } else {
+                value = -(int64_t)mag;
+            }
+            return PARSE_OK;
+        }
+
+        parse_status parse_uint64(const char *s, size_t len, uint64_t &value) {
+            if (len > 0 && s[0] == '+') {
+                s++;
+                len--;
+            }
+            return __parse_uint64(s, len, UINT64_MAX, value);
+        }
+
+        parse_status parse_int(const char *s, size_t len, int &value) {
+            int64_t v = 0;
+            parse_status st = parse_int64(s, len, v);
+            if (st != PARSE_OK) {
+                return st;
+            }
+            if (v < INT32_MIN || v > INT32_MAX) {
+                return PARSE_OVERFLOW;
+            }
+
+            value = (int)v;
+            return PARSE_OK;
+        }
+
+        static bool __equal_nocase(const char *s, size_t len, const char *word) {
+            size_t n = strlen(word);
+            if (len != n) {
+                return false;
+            }
+            for (size_t i = 0; i < n; i++) {
+                if ((s[i] | 0x20) != word[i]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /*********************************************************************************
+         * Convert a validated number that can't be converted exactly
+         * strtod uses the decimal point of the locale, so the point is replaced.
+         ********************************************************************************/
+        static parse_status __convert_slow(const char *s, size_t len, double &value) {
+            const char *point = localeconv()->decimal_point;
+            std::string buf;
+            buf.reserve(len + 4);
+            for (size_t i = 0; i < len; i++) {
+                if (s[i] == '.') {
+                    buf.append(point);
+                } else {
+                    buf.push_back(s[i]);
+                }
+            }
+
+            errno = 0;
+            double v = strtod(buf.c_str(), NULL);
+            if (errno == ERANGE && isinf(v)) {
+                return PARSE_OVERFLOW;
+            }
+
+            value = v;
+            return PARSE_OK;
+        }
+
+        parse_status parse_double(const char *s, size_t len, double &value) {
+            static const double pow10[] = {
+                1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+            };
+
+            size_t i = 0;
+            bool neg = false;
+            if (len > 0 && (s[0] == '-' || s[0] == '+')) {
+                neg = s[0] == '-';
+                i++;
+            }
+
+            if (i < len && s[i] != '.' && (s[i] < '0' || s[i] > '9')) {
+                if (__equal_nocase(s + i, len - i, "inf") || 
+                    __equal_nocase(s + i, len - i, "infinity")) {
+                    value = neg ? -HUGE_VAL : HUGE_VAL;
+                    return PARSE_OK;
+                }
+                if (__equal_nocase(s + i, len - i, "nan")) {
+                    value = NAN;
+                    return PARSE_OK;
+                }
+                return PARSE_INVALID;
+            }
+
+            // Significant digits are accumulated into the mantissa, the exponent 
+            // counts the dropped integer digits and the kept fraction digits.
+            uint64_t mant = 0;
+            int digits = 0;
+            int64_t exp10 = 0;
+            size_t beg = i;
+            while (i < len && s[i] == '0') {
+                i++;
+            }
+            i = __parse_decimal(s, len, i, mant, digits);
+            if (digits > MAX_SAFE_DIGITS) {
+                exp10 += digits - MAX_SAFE_DIGITS;
+            }
+            bool any = i > beg;
+
+            if (i < len && s[i] == '.') {
+                i++;
+                size_t p = i;
+                if (digits == 0) {
+                    while (i < len && s[i] == '0') {
+                        i++;
+                    }
+                    exp10 -= (int64_t)(i - p);
+                }
+                int before = digits;
+                i = __parse_decimal(s, len, i, mant, digits);
+                int kept_before = before < MAX_SAFE_DIGITS ? before : MAX_SAFE_DIGITS;
+                int kept_after = digits < MAX_SAFE_DIGITS ? digits : MAX_SAFE_DIGITS;
+                exp10 -= kept_after - kept_before;
+                any = any || i > p;
+            }
+            if (!any) {
+                return PARSE_INVALID;
+            }
+
+            if (i < len && (s[i] | 0x20) == 'e') {
+                i++;
+                bool eneg = false;
+                if (i < len && (s[i] == '-' || s[i] == '+')) {
+                    eneg = s[i] == '-';
+                    i++;
+                }
+                if (i == len) {
+                    return PARSE_INVALID;
+                }
+                int64_t e = 0;
+                for (; i < len; i++) {
+                    unsigned d = (unsigned)(s[i] - '0');
+                    if (d > 9) {
+                        return PARSE_INVALID;
+                    }
+                    if (e < 100000) {
+                        e = e * 10 + d;
+                    }
+                }
+                exp10 += eneg ? -e : e;
+            }
+            if (i != len) {
+                return PARSE_INVALID;
+            }
+
+            if (mant == 0) {
+                value = neg ? -0.0 : 0.0;
+                return PARSE_OK;
+            }
+
+            // Both the mantissa and the power of ten are exact doubles, so one 
+            // multiplication or division is correctly rounded.
+            if (digits <= MAX_SAFE_DIGITS && 
+                mant <= (1ULL << 53) && 
+                exp10 >= -22 && exp10 <= 22) {
+                double d = (double)mant;
+                d = exp10 < 0 ? d / pow10[-exp10] : d * pow10[exp10];
+                value = neg ? -d : d;
+                return PARSE_OK;
+            }
+
+            return __convert_slow(s, len, value);
+        }
+
+    }
+
+}
@@ -0,0 +1,75 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef easycmd_number_h
+#define easycmd_number_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace easycmd {
+
+    /*********************************************************************************
+     * Parse status of option values
+     ********************************************************************************/
+    enum parse_status
+    {
+        PARSE_OK = 0,
+        // Not a value of the type
+        PARSE_INVALID,
+        // A value out of the range of the type
+        PARSE_OVERFLOW
+    };
+
+    namespace internal {
+
+        /*********************************************************************************
+         * Parse integer
+         * Accepts an optional sign, then decimal digits, or 0x hex, 0o octal and 0b 
+         * binary digits. A leading zero doesn't make the number octal. The whole 
+         * string must be the number. It is validated and converted in one pass 
+         * without locale, eight decimal digits at a time where possible.
+         ********************************************************************************/
+        parse_status parse_int64(const char *s, size_t len, int64_t &value);
+        parse_status parse_int(const char *s, size_t len, int &value);
+
+        /*********************************************************************************
+         * Parse unsigned integer
+         * Same as parse_int64 but a '-' sign is invalid.
+         ********************************************************************************/
+        parse_status parse_uint64(const char *s, size_t len, uint64_t &value);
+
+        /*********************************************************************************
+         * Parse floating point number
+         * Accepts an optional sign, decimal digits with an optional point and exponent,
+         * or inf, infinity and nan in any case. The point is always '.', whatever the
+         * locale is. A finite number too large for double is an overflow.
+         ********************************************************************************/
+        parse_status parse_double(const char *s, size_t len, double &value);
+
+    }
+
+}
+
+#endif
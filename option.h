@@ -26,9 +26,16 @@
 #define easycmd_option_h
 
 #include <string>
+#include <string.h>
+
+#include "arena.h"
+#include "choice.h"
+#include "number.h"
 
 namespace easycmd {
 
+    class command;
+
     namespace internal {
 
         /*********************************************************************************
@@ -39,37 +46,154 @@ namespace easycmd {
             OP_TYPE_BOOL = 0,
             OP_TYPE_INT,
             OP_TYPE_FLOAT,
-            OP_TYPE_STRING
+            OP_TYPE_STRING,
+            OP_TYPE_TYPED,
+            OP_TYPE_CHOICE
+        };
+
+        /*********************************************************************************
+         * Typed value parser
+         * Parses value into out, which is the value of the typed option.
+         ********************************************************************************/
+        typedef parse_status(*value_parser)(const char *value, size_t len, void *out);
+
+        /*********************************************************************************
+         * Typed value
+         * Values of typed options are stored in the typed values of parse result at 
+         * offset, the default value and the value of the last run(argc, argv) are 
+         * stored in the arena.
+         ********************************************************************************/
+        struct typed_value
+        {
+            value_parser parse;
+            size_t size;
+            size_t offset;
+            void *def;
+            void *last;
         };
     }
 
     /*********************************************************************************
-     * Option
+     * Option value sources
+     * Later sources take precedence: default < config file < env < args.
      ********************************************************************************/
-    class option {
+    enum option_source
+    {
+        SOURCE_NONE = 0,
+        SOURCE_DEFAULT,
+        SOURCE_CONFIG,
+        SOURCE_ENV,
+        SOURCE_ARGS
+    };
+
+    /*********************************************************************************
+     * Option value
+     * Values parsed by a run are stored in parse_result, not in the option.
+     ********************************************************************************/
+    class option_value {
       protected:
+        friend class option;
         friend class command;
+        template <typename T> friend class typed_option;
 
       public:
         /*********************************************************************************
          * Constructor
          ********************************************************************************/
-        option(internal::option_type ot, 
-               const std::string &lname, 
-               const std::string &sname)
-          : type_(ot),
-            required_(true),
-            long_name_(lname),
-            short_name_(sname),
-            found_value_(false) {
+        option_value()
+          : found_(false),
+            source_(SOURCE_NONE) {
             val_.f = 0.0;
         }
 
+        /*********************************************************************************
+         * Get value
+         ********************************************************************************/
+        int get_int() const { 
+            return val_.i; 
+        }
+        bool get_bool() const { 
+            return val_.b; 
+        }
+        double get_float() const { 
+            return val_.f; 
+        }
+        const std::string& get_string() const { 
+            return val_s_; 
+        }
+
+        /*********************************************************************************
+         * Get found status
+         * The value is found if the option has default value or is set by env or args.
+         ********************************************************************************/
+        bool is_found() const {
+            return found_;
+        }
+
+        /*********************************************************************************
+         * Get source of the value
+         ********************************************************************************/
+        option_source get_source() const {
+            return source_;
+        }
+
+      private:
+        /*********************************************************************************
+         * Set value
+         ********************************************************************************/
+        void __set(int value)  { 
+            found_ = true; 
+            val_.i = value; 
+        }
+        void __set(bool value) { 
+            found_ = true; 
+            val_.b = value; 
+        }
+        void __set(double value) { 
+            found_ = true; 
+            val_.f = value; 
+        }
+        void __set(const std::string &value) { 
+            found_ = true; 
+            val_s_ = value; 
+        }
+        void __set(const char *value, size_t len) { 
+            found_ = true; 
+            val_s_.assign(value, len); 
+        }
+
+      private:
+        // Found value status
+        bool found_;
+
+        // Value source
+        option_source source_;
+
+        // Values
+        union value {
+            int i;
+            bool b;
+            double f;
+        } val_;
+        std::string val_s_;
+    };
+
+    /*********************************************************************************
+     * Option
+     ********************************************************************************/
+    class option {
+      protected:
+        friend class arena;
+        friend class command;
+        friend class parse_result;
+        template <typename T> friend class typed_option;
+
+      public:
         /*********************************************************************************
          * Set environmnet
          ********************************************************************************/
         option* with_env(const std::string &env) { 
-            env_ = env; 
+            env_ = arena_->intern(env.data(), env.size()); 
             return this; 
         }
 
@@ -77,7 +201,7 @@ namespace easycmd {
          * Set desc
          ********************************************************************************/
         option* with_desc(const std::string &usage) { 
-            desc_ = usage; 
+            desc_ = arena_->intern(usage.data(), usage.size()); 
             return this; 
         }
 
@@ -86,68 +210,164 @@ namespace easycmd {
          ********************************************************************************/
         option* with_default(int value) { 
             required_ = false;
-            __set(value); 
+            val_.source_ = SOURCE_DEFAULT;
+            val_.__set(value); 
+            def_val_ = val_.val_;
             return this; 
         }
         option* with_default(bool value) {
             required_ = false;
-            __set(value); 
+            val_.source_ = SOURCE_DEFAULT;
+            val_.__set(value); 
+            def_val_ = val_.val_;
             return this;
         }
         option* with_default(double value) {
             required_ = false;
-            __set(value); 
+            val_.source_ = SOURCE_DEFAULT;
+            val_.__set(value); 
+            def_val_ = val_.val_;
             return this;
         }
         option* with_default(const char *value) {
+            if (choices_) {
+                return __with_default_choice(value, strlen(value));
+            }
             required_ = false;
-            __set(value);
+            val_.source_ = SOURCE_DEFAULT;
+            val_.__set(value, strlen(value));
+            def_val_s_ = arena_->intern(value, strlen(value));
             return this;
         }
         option* with_default(const std::string &value) {
+            if (choices_) {
+                return __with_default_choice(value.data(), value.size());
+            }
             required_ = false;
-            __set(value); 
+            val_.source_ = SOURCE_DEFAULT;
+            val_.__set(value); 
+            def_val_s_ = arena_->intern(value.data(), value.size());
             return this; 
         }
 
         /*********************************************************************************
          * Get value
+         * Inside an action callback, this returns the value parsed by the running 
+         * command line of the current thread. Otherwise it returns the value of the 
+         * last run(argc, argv), or the default value.
          ********************************************************************************/
         int get_int() const { 
-            return val_.i; 
+            return __value().get_int(); 
         }
         bool get_bool() const { 
-            return val_.b; 
+            return __value().get_bool(); 
         }
         double get_float() const { 
-            return val_.f; 
+            return __value().get_float(); 
         }
         const std::string& get_string() const { 
-            return val_s_; 
+            return __value().get_string(); 
+        }
+
+        /*********************************************************************************
+         * Get value of choice option
+         * get_int() returns the id of the value, its position in the accepted values.
+         * Return empty string if the option is not a choice option.
+         ********************************************************************************/
+        const char* get_choice() const {
+            return choices_ ? choices_->get(__value().get_int()) : "";
+        }
+
+        /*********************************************************************************
+         * Get accepted values of choice option
+         * Return null if the option is not a choice option.
+         ********************************************************************************/
+        const internal::choice_table* get_choices() const {
+            return choices_;
+        }
+
+        /*********************************************************************************
+         * Get source of the value
+         ********************************************************************************/
+        option_source get_source() const { 
+            return __value().get_source(); 
         }
 
       private:
         /*********************************************************************************
-         * Set value
+         * Constructor
+         * Options are created by command in the arena of the command tree. The names 
+         * must be stored in the arena or be static strings.
          ********************************************************************************/
-        void __set(int value)  { 
-            found_value_ = true; 
-            val_.i = value; 
+        option(arena *a,
+               const command *owner,
+               int pos,
+               internal::option_type ot, 
+               const char *lname, 
+               const char *sname)
+          : arena_(a),
+            owner_(owner),
+            pos_(pos),
+            type_(ot),
+            required_(true),
+            long_name_(lname),
+            short_name_(sname),
+            env_(""),
+            desc_(""),
+            def_val_s_(""),
+            typed_(NULL),
+            choices_(NULL) {
+            def_val_.f = 0.0;
         }
-        void __set(bool value) { 
-            found_value_ = true; 
-            val_.b = value; 
+
+        /*********************************************************************************
+         * Set accepted values of choice option
+         ********************************************************************************/
+        void __set_choices(const char *const *values, size_t cnt) {
+            choices_ = arena_->create<internal::choice_table>();
+            choices_->build(arena_, values, cnt);
         }
-        void __set(double value) { 
-            found_value_ = true; 
-            val_.f = value; 
+
+        /*********************************************************************************
+         * Set default value of choice option
+         * The option stays required if the value is not accepted.
+         ********************************************************************************/
+        option* __with_default_choice(const char *value, size_t len) {
+            int id = choices_->find(value, len);
+            return id < 0 ? this : with_default(id);
         }
-        void __set(const std::string &value) { 
-            found_value_ = true; 
-            val_s_ = value; 
+
+        /*********************************************************************************
+         * Reset value to default
+         ********************************************************************************/
+        void __reset(option_value &v) const {
+            v.found_ = !required_;
+            v.source_ = required_ ? SOURCE_NONE : SOURCE_DEFAULT;
+            v.val_ = def_val_;
+            if (type_ == internal::OP_TYPE_STRING) {
+                v.val_s_.assign(def_val_s_);
+            }
         }
 
+        /*********************************************************************************
+         * Get value of the active parse result, or the option's own value
+         ********************************************************************************/
+        const option_value& __value() const;
+
+        /*********************************************************************************
+         * Get typed value of the active parse result, or the option's own value
+         ********************************************************************************/
+        const void* __typed_value() const;
+
       private:
+        // Arena of strings
+        arena *arena_;
+
+        // Owner command
+        const command *owner_;
+        // Position in owner options
+        int pos_;
+
         // Option type
         int type_;
 
@@ -155,29 +375,30 @@ namespace easycmd {
         bool required_;
 
         // Option long name
-        std::string long_name_;
+        const char *long_name_;
         // Option short name
-        std::string short_name_;
+        const char *short_name_;
 
         // Option env
-        std::string env_;
+        const char *env_;
 
         // Option desc
-        std::string desc_;
+        const char *desc_;
 
-        // Found value status
-        // If has default value, thie will be true.
-        bool found_value_;
+        // Default values
+        option_value::value def_val_;
+        const char *def_val_s_;
 
-        // Values
-        union {
-            int i;
-            bool b;
-            double f;
-        } val_;
-        std::string val_s_;
+        // Value of the last run(argc, argv)
+        option_value val_;
+
+        // Typed value, null if the option is not typed
+        internal::typed_value *typed_;
+
+        // Accepted values, null if the option is not a choice option
+        internal::choice_table *choices_;
     };
 
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,167 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "option_index.h"
+
+#include <string.h>
+#include <algorithm>
+
+namespace easycmd {
+
+    namespace internal {
+
+        static uint32_t hash_name(const char *name, size_t len) {
+            // FNV-1a
+            uint32_t h = 2166136261u;
+            for (size_t i = 0; i < len; i++) {
+                h ^= (unsigned char)name[i];
+                h *= 16777619u;
+            }
+            return h;
+        }
+
+        option_index::option_index()
+          : long_cnt_(0),
+            short_cnt_(0) {
+            memset(short_table_, 0, sizeof(short_table_));
+        }
+
+        void option_index::add(const char *long_name, const char *short_name, int pos) {
+            size_t long_len = strlen(long_name);
+            if (long_len > 0) {
+                __add(long_slots_, long_cnt_, long_name, long_len, pos);
+            }
+
+            size_t short_len = strlen(short_name);
+            if (short_len == 1) {
+                int &ent = short_table_[(unsigned char)short_name[0]];
+                if (ent == 0) {
+                    ent = pos + 1;
+                }
+            } else if (short_len > 0) {
+                __add(short_slots_, short_cnt_, short_name, short_len, pos);
+            }
+        }
+
+        int option_index::find_long(const char *name, size_t len) const {
+            if (len == 0) {
+                return -1;
+            }
+            return __find(long_slots_, name, len);
+        }
+
+        int option_index::find_short(const char *name, size_t len) const {
+            if (len == 1) {
+                return short_table_[(unsigned char)name[0]] - 1;
+            } else if (len == 0) {
+                return -1;
+            }
+            return __find(short_slots_, name, len);
+        }
+
+        int option_index::find(const char *name, size_t len) const {
+            int lpos = find_long(name, len);
+            int spos = find_short(name, len);
+            if (lpos < 0 || (spos >= 0 && spos < lpos)) {
+                return spos;
+            }
+            return lpos;
+        }
+
+        void option_index::clear() {
+            slot empty;
+            memset(&empty, 0, sizeof(empty));
+            std::fill(long_slots_.begin(), long_slots_.end(), empty);
+            std::fill(short_slots_.begin(), short_slots_.end(), empty);
+            long_cnt_ = 0;
+            short_cnt_ = 0;
+            memset(short_table_, 0, sizeof(short_table_));
+        }
+
+        int option_index::__find(const slot_vector &slots, const char *name, size_t len) {
+            if (slots.empty()) {
+                return -1;
+            }
+
+            uint32_t h = hash_name(name, len);
+            size_t mask = slots.size() - 1;
+            for (size_t i = h & mask; ; i = (i + 1) & mask) {
+                const slot &s = slots[i];
+                if (s.name == NULL) {
+                    return -1;
+                }
+                if (s.hash == h && s.len == len && (s.name == name || memcmp(s.name, name, len) == 0)) {
+                    return s.pos;
+                }
+            }
+        }
+
+        void option_index::__add(slot_vector &slots, int &cnt, const char *name, size_t len, int pos) {
+            // Keep load factor under 1/2
+            if ((size_t)(cnt + 1) * 2 > slots.size()) {
+                __grow(slots);
+            }
+
+            uint32_t h = hash_name(name, len);
+            size_t mask = slots.size() - 1;
+            for (size_t i = h & mask; ; i = (i + 1) & mask) {
+                slot &s = slots[i];
+                if (s.name == NULL) {
+                    s.hash = h;
+                    s.len = (uint32_t)len;
+                    s.name = name;
+                    s.pos = pos;
+                    cnt++;
+                    return;
+                }
+                if (s.hash == h && s.len == len && (s.name == name || memcmp(s.name, name, len) == 0)) {
+                    return;
+                }
+            }
+        }
+
+        void option_index::__grow(slot_vector &slots) {
+            slot empty;
+            memset(&empty, 0, sizeof(empty));
+
+            slot_vector old;
+            old.swap(slots);
+            slots.assign(old.empty() ? 16 : old.size() * 2, empty);
+
+            size_t mask = slots.size() - 1;
+            for (size_t j = 0; j < old.size(); j++) {
+                if (old[j].name == NULL) {
+                    continue;
+                }
+                size_t i = old[j].hash & mask;
+                while (slots[i].name != NULL) {
+                    i = (i + 1) & mask;
+                }
+                slots[i] = old[j];
+            }
+        }
+
+    }
+
+}
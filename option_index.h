@@ -0,0 +1,114 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef easycmd_option_index_h
+#define easycmd_option_index_h
+
+#include <vector>
+#include <stdint.h>
+#include <stddef.h>
+
+namespace easycmd {
+
+    namespace internal {
+
+        /*********************************************************************************
+         * Option index
+         * Maps option long and short names to the option position in the command.
+         * Single character short names are found through a 256 entries table, other
+         * names through an open addressing hash table. Entries are added when options
+         * are created, so lookup never scans the option list.
+         ********************************************************************************/
+        class option_index
+        {
+        public:
+            /*********************************************************************************
+             * Constructor
+             ********************************************************************************/
+            option_index();
+
+            /*********************************************************************************
+             * Add option names
+             * The names must stay alive and unchanged while the index is used. A name
+             * already in the index keeps its old position.
+             ********************************************************************************/
+            void add(const char *long_name, const char *short_name, int pos);
+
+            /*********************************************************************************
+             * Find option position by long name or short name
+             * Return -1 if not found.
+             ********************************************************************************/
+            int find_long(const char *name, size_t len) const;
+            int find_short(const char *name, size_t len) const;
+
+            /*********************************************************************************
+             * Find option position by long name or short name
+             * If both match, the option created first is returned.
+             ********************************************************************************/
+            int find(const char *name, size_t len) const;
+
+            /*********************************************************************************
+             * Remove all names
+             * The hash tables keep their size for the names added next.
+             ********************************************************************************/
+            void clear();
+
+        private:
+            /*********************************************************************************
+             * Hash slot
+             ********************************************************************************/
+            struct slot {
+                uint32_t hash;
+                uint32_t len;
+                const char *name;
+                int pos;
+            };
+            typedef std::vector<slot> slot_vector;
+
+            /*********************************************************************************
+             * Hash table helpers
+             ********************************************************************************/
+            static int __find(const slot_vector &slots, const char *name, size_t len);
+            static void __add(slot_vector &slots, int &cnt, const char *name, size_t len, int pos);
+            static void __grow(slot_vector &slots);
+
+        private:
+            // Single character short names
+            // Stores option position plus one, zero means empty.
+            int short_table_[256];
+
+            // Long names
+            slot_vector long_slots_;
+            int long_cnt_;
+
+            // Multiple characters short names
+            slot_vector short_slots_;
+            int short_cnt_;
+        };
+
+    }
+
+}
+
+#endif
@@ -0,0 +1,250 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "command.h"
+#include "config_file.h"
+
+namespace easycmd {
+
+    namespace internal {
+
+        static thread_local const parse_result *active_result = NULL;
+
+        const parse_result* get_active_result() {
+            return active_result;
+        }
+
+        active_result_scope::active_result_scope(const parse_result *res)
+          : prev_(active_result) {
+            active_result = res;
+        }
+
+        active_result_scope::~active_result_scope() {
+            active_result = prev_;
+        }
+
+    }
+
+    parse_result::parse_result()
+      : cmd_(NULL),
+        scoped_(false),
+        cmd_argv_(NULL),
+        cmd_argc_(0),
+        operand_cnt_(0),
+        error_(&path_),
+        err_formatted_(true),
+        argv_(NULL),
+        envp_(NULL),
+        token_(NULL),
+        trace_(false),
+        trace_mark_(0) {
+    }
+
+    parse_result::~parse_result() {
+        __release_files();
+    }
+
+    const command* parse_result::get_parent_cmd(const command *cmd) const {
+        for (size_t i = path_.size(); i > 1; i--) {
+            if (path_[i - 1] == cmd) {
+                return path_[i - 2];
+            }
+        }
+        return NULL;
+    }
+
+    const option_value* parse_result::get_option(const std::string &name) const {
+        if (cmd_ == NULL) {
+            return NULL;
+        }
+
+        const option *opt = cmd_->get_option(name);
+        if (opt == NULL || opt->pos_ >= (int)values_.size()) {
+            return NULL;
+        }
+
+        return &values_[opt->pos_];
+    }
+
+    operand_range parse_result::get_operands() const {
+        if (cmd_ == NULL) {
+            return operand_range();
+        }
+
+        return operand_range(operand_iterator(cmd_, cmd_argv_, cmd_argc_, 0), 
+                             operand_iterator(cmd_, cmd_argv_, cmd_argc_, cmd_argc_), 
+                             operand_cnt_);
+    }
+
+    operand_range parse_result::get_operands(const std::string &name) const {
+        if (cmd_ == NULL) {
+            return operand_range();
+        }
+
+        // Positional arguments take operands in order
+        const std::vector<positional*> &positionals = cmd_->positionals_;
+        for (size_t i = 0; i < positionals.size() && i < operand_cnt_; i++) {
+            if (name != positionals[i]->name_) {
+                continue;
+            }
+
+            operand_iterator beg(cmd_, cmd_argv_, cmd_argc_, 0);
+            for (size_t j = 0; j < i; j++) {
+                ++beg;
+            }
+            if (positionals[i]->tail_) {
+                return operand_range(beg, 
+                                     operand_iterator(cmd_, cmd_argv_, cmd_argc_, cmd_argc_), 
+                                     operand_cnt_ - i);
+            }
+
+            operand_iterator end = beg;
+            return operand_range(beg, ++end, 1);
+        }
+
+        return operand_range();
+    }
+
+    const char* parse_result::get_positional(const std::string &name) const {
+        operand_range operands = get_operands(name);
+        return operands.empty() ? NULL : *operands.begin();
+    }
+
+    void parse_result::clear() {
+        cmd_ = NULL;
+        cmd_argv_ = NULL;
+        cmd_argc_ = 0;
+        operand_cnt_ = 0;
+        path_.clear();
+        scoped_ = false;
+        error_.__clear();
+        err_.clear();
+        err_formatted_ = true;
+        argv_ = NULL;
+        args_.clear();
+        env_.reset();
+        token_ = NULL;
+        stats_.clear();
+        trace_ = false;
+        __release_files();
+    }
+
+    void parse_result::__format_choices(const option *opt, std::string &des) {
+        if (opt != NULL && opt->choices_ != NULL) {
+            des.append("accepted values: ");
+            opt->choices_->join(", ", des);
+            des.append("\n");
+        }
+    }
+
+    void parse_result::__format_error(std::string &des) const {
+        const run_error &e = error_;
+        const command *cmd = e.cmd_;
+        std::string hint;
+        switch (e.code_) {
+        case ERR_NONE:
+            des.clear();
+            break;
+        case ERR_NO_ARGUMENTS:
+            command::__set_error(des, "no arguments");
+            break;
+        case ERR_RESPONSE_FILE:
+        case ERR_UNTERMINATED_QUOTE:
+        case ERR_CONFIG_FILE:
+            des = e.text_;
+            break;
+        case ERR_UNKNOWN_COMMAND:
+            cmd->__suggest_cmd(e.arg_, *this, hint);
+            command::__set_error(des, "no found command: %s\n%s", e.arg_, hint.c_str());
+            break;
+        case ERR_CONFIG_INVALID:
+        case ERR_CONFIG_OUT_OF_RANGE:
+            command::__set_error(des, "%s value of %s at line %d of config file %s\n", 
+                                 e.code_ == ERR_CONFIG_OUT_OF_RANGE ? "out of range" : "invalid",
+                                 e.arg_, e.line_, path_[0]->config_->path().c_str());
+            __format_choices(e.opt_, des);
+            break;
+        case ERR_UNEXPECTED_ARGUMENT:
+            command::__set_error(des, "unexpected argument: %s\n", e.arg_);
+            break;
+        case ERR_UNKNOWN_OPTION:
+        case ERR_INVALID_VALUE:
+            if (!e.name_.empty()) {
+                cmd->__suggest_option(e.name_, hint);
+            }
+            command::__set_error(des, "invalid option: %s\n%s", e.arg_, hint.c_str());
+            __format_choices(e.opt_, des);
+            break;
+        case ERR_OUT_OF_RANGE:
+            command::__set_error(des, "out of range value of option: %s\n", e.arg_);
+            break;
+        case ERR_OPTION_REQUIRED:
+            if (e.opt_->long_name_[0] != 0) {
+                command::__set_error(des, "option --%s required\n", e.opt_->long_name_);
+            } else {
+                command::__set_error(des, "option -%s required\n", e.opt_->short_name_);
+            }
+            break;
+        case ERR_ARGUMENT_REQUIRED:
+            command::__set_error(des, "argument %s required\n", e.pos_->name_);
+            break;
+        case ERR_ACTION_FAILED:
+            command::__set_error(des, "process command %s failed\n", cmd->name_);
+            break;
+        case ERR_TIMEOUT:
+            command::__set_error(des, "command %s timed out after %u ms\n", cmd->name_, cmd->timeout_ms_);
+            break;
+        case ERR_SIGNAL:
+            command::__set_error(des, "command %s interrupted by signal\n", cmd->name_);
+            break;
+        case ERR_CANCELLED:
+            command::__set_error(des, "command %s cancelled\n", cmd->name_);
+            break;
+        }
+    }
+
+    void parse_result::__release_files() {
+        for (size_t i = 0; i < files_.size(); i++) {
+            delete files_[i];
+        }
+        files_.clear();
+    }
+
+    const option_value& option::__value() const {
+        const parse_result *res = internal::get_active_result();
+        if (res && res->cmd_ == owner_ && pos_ < (int)res->values_.size()) {
+            return res->values_[pos_];
+        }
+        return val_;
+    }
+
+    const void* option::__typed_value() const {
+        const parse_result *res = internal::get_active_result();
+        if (res && res->cmd_ == owner_ && !res->typed_values_.empty()) {
+            return res->__typed_value(this);
+        }
+        return typed_->last;
+    }
+
+}
@@ -0,0 +1,299 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef easycmd_parse_result_h
+#define easycmd_parse_result_h
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+#include "option.h"
+#include "env_index.h"
+#include "positional.h"
+#include "run_error.h"
+#include "run_stats.h"
+#include "typed_option.h"
+#include "response_file.h"
+
+namespace easycmd {
+
+    class command;
+    class cancel_token;
+
+    /*********************************************************************************
+     * Parse result
+     * Everything a run produces: the dispatched command path, the option values of
+     * the dispatched command and the error. The command tree is not changed by a 
+     * run, so one tree can be run by many threads, each with its own parse result.
+     * A parse result can be reused, so buffers of previous runs are kept. Response
+     * files read by a run are kept until the result is cleared.
+     ********************************************************************************/
+    class parse_result
+    {
+    public:
+        /*********************************************************************************
+         * Constructor
+         ********************************************************************************/
+        parse_result();
+
+        /*********************************************************************************
+         * Deconstructor
+         ********************************************************************************/
+        ~parse_result();
+
+        /*********************************************************************************
+         * Get dispatched command
+         * Null if the run failed before a command was dispatched.
+         ********************************************************************************/
+        const command* get_cmd() const {
+            return cmd_;
+        }
+
+        /*********************************************************************************
+         * Get dispatched command path
+         * From the root command to the dispatched command.
+         ********************************************************************************/
+        const std::vector<const command*>& get_path() const {
+            return path_;
+        }
+
+        /*********************************************************************************
+         * Get parent of command in the dispatched path
+         * Public sub commands have a different parent in each path they are used.
+         * Return null if the command is the root or not in the path.
+         ********************************************************************************/
+        const command* get_parent_cmd(const command *cmd) const;
+
+        /*********************************************************************************
+         * Get option value of the dispatched command
+         * Return null if the option is not found.
+         ********************************************************************************/
+        const option_value* get_option(const std::string &name) const;
+
+        /*********************************************************************************
+         * Get operands of the dispatched command
+         * All operands, or the operands taken by the positional argument name. Operands
+         * are found by walking the args, nothing is copied.
+         ********************************************************************************/
+        operand_range get_operands() const;
+        operand_range get_operands(const std::string &name) const;
+
+        /*********************************************************************************
+         * Get positional argument
+         * Return null if it is not given.
+         ********************************************************************************/
+        const char* get_positional(const std::string &name) const;
+
+        /*********************************************************************************
+         * Get value of typed option
+         * Return null if the option is not of the dispatched command.
+         ********************************************************************************/
+        template <typename T>
+        const T* get(const typed_option<T> *opt) const {
+            if (opt == NULL || opt->owner_ != cmd_ || typed_values_.empty()) {
+                return NULL;
+            }
+            return (const T*)__typed_value(opt);
+        }
+
+        /*********************************************************************************
+         * Get error
+         * The text is formatted from the structured error on first call.
+         ********************************************************************************/
+        const std::string& get_err() const {
+            if (!err_formatted_) {
+                __format_error(err_);
+                err_formatted_ = true;
+            }
+            return err_;
+        }
+
+        /*********************************************************************************
+         * Get structured error
+         ********************************************************************************/
+        const run_error& get_error() const {
+            return error_;
+        }
+
+        /*********************************************************************************
+         * Get stats of the run
+         * Counts are always kept, timings only if the run is traced.
+         ********************************************************************************/
+        const run_stats& get_stats() const {
+            return stats_;
+        }
+
+        /*********************************************************************************
+         * Set environment of runs
+         * Options bound to env read this null terminated array of "name=value" strings
+         * instead of the process environment, null restores it. The strings must be
+         * alive while the result is run, clear doesn't reset it.
+         ********************************************************************************/
+        void set_env(const char *const *env) {
+            envp_ = env;
+        }
+
+        /*********************************************************************************
+         * Clear for reuse
+         ********************************************************************************/
+        void clear();
+
+    private:
+        friend class option;
+        friend class command;
+
+        /*********************************************************************************
+         * Disable copy
+         * Args may point into response files owned by the result.
+         ********************************************************************************/
+        parse_result(const parse_result&);
+        parse_result& operator=(const parse_result&);
+
+        /*********************************************************************************
+         * End phase
+         * The time since the end of the previous phase is added to the phase.
+         ********************************************************************************/
+        void __trace(int phase) {
+            if (trace_) {
+                uint64_t now = internal::trace_clock_ns();
+                stats_.phase_ns[phase] += now - trace_mark_;
+                trace_mark_ = now;
+            }
+        }
+
+        /*********************************************************************************
+         * Get typed value of option
+         ********************************************************************************/
+        void* __typed_value(const option *opt) {
+            return (char*)&typed_values_[0] + opt->typed_->offset;
+        }
+        const void* __typed_value(const option *opt) const {
+            return (const char*)&typed_values_[0] + opt->typed_->offset;
+        }
+
+        /*********************************************************************************
+         * Set error
+         * The previous error is replaced.
+         ********************************************************************************/
+        run_error& __set_error(error_code code, const command *cmd) {
+            error_.__clear();
+            error_.code_ = code;
+            error_.cmd_ = cmd;
+            err_formatted_ = false;
+            return error_;
+        }
+
+        /*********************************************************************************
+         * Format error text
+         ********************************************************************************/
+        void __format_error(std::string &des) const;
+
+        /*********************************************************************************
+         * Format accepted values of choice option
+         * Nothing is appended if the option is not a choice option.
+         ********************************************************************************/
+        static void __format_choices(const option *opt, std::string &des);
+
+        /*********************************************************************************
+         * Release response files
+         ********************************************************************************/
+        void __release_files();
+
+    private:
+        // Dispatched command
+        const command *cmd_;
+        // Dispatched command path
+        std::vector<const command*> path_;
+        // The path starts at a root command and follows parent links, so sub 
+        // commands are found in scope tables
+        bool scoped_;
+
+        // Args of dispatched command
+        const char **cmd_argv_;
+        int cmd_argc_;
+        // Operand count of dispatched command
+        size_t operand_cnt_;
+
+        // Option values of dispatched command
+        // Indexed as the options of the command.
+        std::vector<option_value> values_;
+        // Typed option values of dispatched command
+        std::vector<std::max_align_t> typed_values_;
+
+        // Error
+        run_error error_;
+        // Text of error, formatted on demand
+        mutable std::string err_;
+        mutable bool err_formatted_;
+
+        // Args of the run
+        const char **argv_;
+        // Args with response files expanded
+        std::vector<const char*> args_;
+        // Response files the args point into
+        std::vector<internal::mapped_file*> files_;
+
+        // Environment snapshot, built when an option reads env
+        internal::env_index env_;
+        // Environment of runs, null for the process environment
+        const char *const *envp_;
+
+        // Cancel token of the run, null if not given
+        cancel_token *token_;
+
+        // Stats of the run
+        run_stats stats_;
+        // Timings are measured
+        bool trace_;
+        // End of the previous phase
+        uint64_t trace_mark_;
+    };
+
+    namespace internal {
+
+        /*********************************************************************************
+         * Active parse result of current thread
+         * While an action runs, option getters read the values of this result.
+         ********************************************************************************/
+        const parse_result* get_active_result();
+
+        /*********************************************************************************
+         * Active parse result scope
+         ********************************************************************************/
+        class active_result_scope
+        {
+        public:
+            explicit active_result_scope(const parse_result *res);
+            ~active_result_scope();
+
+        private:
+            const parse_result *prev_;
+        };
+
+    }
+
+}
+
+#endif
@@ -0,0 +1,69 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "command.h"
+#include "tokenizer.h"
+#include "positional.h"
+
+#include <string.h>
+
+namespace easycmd {
+
+    operand_iterator::operand_iterator(const command *cmd, const char **argv, int argc, int pos)
+      : cmd_(cmd),
+        argv_(argv),
+        argc_(argc),
+        pos_(pos),
+        operands_only_(false) {
+        __advance(pos);
+    }
+
+    void operand_iterator::__advance(int pos) {
+        internal::arg_token tok;
+        internal::arg_token next;
+        for (; pos < argc_ && !operands_only_; pos++) {
+            const char *arg = argv_[pos];
+            if (strcmp(arg, "--") == 0) {
+                operands_only_ = true;
+                pos++;
+                break;
+            }
+
+            internal::tokenize_arg(arg, tok);
+            if (tok.type != internal::ARG_LONG_OPTION && 
+                tok.type != internal::ARG_SHORT_OPTION) {
+                break;
+            }
+
+            if (!tok.has_value && pos + 1 < argc_) {
+                internal::tokenize_arg(argv_[pos + 1], next);
+                if (cmd_->__takes_next(tok, next)) {
+                    pos++;
+                }
+            }
+        }
+        pos_ = pos < argc_ ? pos : argc_;
+    }
+
+}
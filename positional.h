@@ -0,0 +1,235 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef easycmd_positional_h
+#define easycmd_positional_h
+
+#include <string>
+#include <iterator>
+#include <stddef.h>
+
+#include "arena.h"
+
+namespace easycmd {
+
+    class command;
+    class parse_result;
+
+    /*********************************************************************************
+     * Positional argument
+     * Operands are the args of the dispatched command that are neither options nor
+     * option values. Positional arguments name them in order, the last one may be a
+     * tail taking all remaining operands.
+     ********************************************************************************/
+    class positional {
+      protected:
+        friend class arena;
+        friend class command;
+        friend class parse_result;
+
+      public:
+        /*********************************************************************************
+         * Set desc
+         ********************************************************************************/
+        positional* with_desc(const std::string &desc) { 
+            desc_ = arena_->intern(desc.data(), desc.size()); 
+            return this; 
+        }
+
+        /*********************************************************************************
+         * Set required
+         * A positional argument is required by default, a tail is optional. A required
+         * tail needs at least one operand.
+         ********************************************************************************/
+        positional* with_required(bool required) { 
+            required_ = required; 
+            return this; 
+        }
+
+      private:
+        /*********************************************************************************
+         * Constructor
+         ********************************************************************************/
+        positional(arena *a, const char *name, bool tail)
+          : arena_(a),
+            name_(name),
+            desc_(""),
+            required_(!tail),
+            tail_(tail) {
+        }
+
+      private:
+        // Arena of strings
+        arena *arena_;
+
+        // Name
+        const char *name_;
+        // Desc
+        const char *desc_;
+
+        // Required status
+        bool required_;
+        // Takes all remaining operands
+        bool tail_;
+    };
+
+    /*********************************************************************************
+     * Operand iterator
+     * Walks the args of the dispatched command and stops at operands, options and 
+     * their values are skipped with the same rules as parsing. Nothing is stored, so
+     * any number of operands is visited with constant memory. The args must be alive
+     * while the iterator is used.
+     ********************************************************************************/
+    class operand_iterator {
+      public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef const char* value_type;
+        typedef ptrdiff_t difference_type;
+        typedef const char* const* pointer;
+        typedef const char* reference;
+
+      public:
+        /*********************************************************************************
+         * Constructor
+         ********************************************************************************/
+        operand_iterator()
+          : cmd_(NULL),
+            argv_(NULL),
+            argc_(0),
+            pos_(0),
+            operands_only_(false) {
+        }
+
+        /*********************************************************************************
+         * Access
+         ********************************************************************************/
+        const char* operator*() const {
+            return argv_[pos_];
+        }
+
+        /*********************************************************************************
+         * Move to next operand
+         ********************************************************************************/
+        operand_iterator& operator++() {
+            __advance(pos_ + 1);
+            return *this;
+        }
+        operand_iterator operator++(int) {
+            operand_iterator it = *this;
+            __advance(pos_ + 1);
+            return it;
+        }
+
+        /*********************************************************************************
+         * Compare
+         ********************************************************************************/
+        bool operator==(const operand_iterator &it) const {
+            return pos_ == it.pos_;
+        }
+        bool operator!=(const operand_iterator &it) const {
+            return pos_ != it.pos_;
+        }
+
+      private:
+        friend class parse_result;
+
+        /*********************************************************************************
+         * Constructor
+         * Starts at the first operand from pos.
+         ********************************************************************************/
+        operand_iterator(const command *cmd, const char **argv, int argc, int pos);
+
+        /*********************************************************************************
+         * Move to the first operand from pos
+         ********************************************************************************/
+        void __advance(int pos);
+
+      private:
+        // Dispatched command
+        const command *cmd_;
+
+        // Args of the dispatched command
+        const char **argv_;
+        int argc_;
+
+        // Current arg
+        int pos_;
+
+        // After "--" all args are operands
+        bool operands_only_;
+    };
+
+    /*********************************************************************************
+     * Operand range
+     ********************************************************************************/
+    class operand_range {
+      public:
+        /*********************************************************************************
+         * Constructor
+         ********************************************************************************/
+        operand_range()
+          : size_(0) {
+        }
+
+        /*********************************************************************************
+         * Iterate
+         ********************************************************************************/
+        operand_iterator begin() const {
+            return beg_;
+        }
+        operand_iterator end() const {
+            return end_;
+        }
+
+        /*********************************************************************************
+         * Get operand count
+         ********************************************************************************/
+        size_t size() const {
+            return size_;
+        }
+        bool empty() const {
+            return size_ == 0;
+        }
+
+      private:
+        friend class parse_result;
+
+        /*********************************************************************************
+         * Constructor
+         ********************************************************************************/
+        operand_range(const operand_iterator &beg, const operand_iterator &end, size_t size)
+          : beg_(beg),
+            end_(end),
+            size_(size) {
+        }
+
+      private:
+        operand_iterator beg_;
+        operand_iterator end_;
+        size_t size_;
+    };
+
+}
+
+#endif
@@ -0,0 +1,246 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "tokenizer.h"
+#include "response_file.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#if !defined(WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace easycmd {
+
+    namespace internal {
+
+        mapped_file::mapped_file()
+          : data_(NULL),
+            size_(0),
+            map_size_(0) {
+        }
+
+        mapped_file::~mapped_file() {
+            __release();
+        }
+
+        bool mapped_file::open(const char *path) {
+            __release();
+
+#if !defined(WIN32)
+            int fd = ::open(path, O_RDONLY);
+            if (fd < 0) {
+                return false;
+            }
+
+            struct stat st;
+            if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+                close(fd);
+                return __read(path);
+            }
+
+            // Reserve one more byte than the file, pages past the end of the file 
+            // are anonymous and the tail of the last file page is zero filled.
+            size_t page = (size_t)sysconf(_SC_PAGESIZE);
+            size_t size = (size_t)st.st_size;
+            size_t map_size = (size + 1 + page - 1) / page * page;
+            void *base = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (base == MAP_FAILED) {
+                close(fd);
+                return __read(path);
+            }
+            if (size > 0 && 
+                mmap(base, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+                munmap(base, map_size);
+                close(fd);
+                return __read(path);
+            }
+            close(fd);
+
+            data_ = (char*)base;
+            size_ = size;
+            map_size_ = map_size;
+
+            return true;
+#else
+            return __read(path);
+#endif
+        }
+
+        bool mapped_file::__read(const char *path) {
+            FILE *f = fopen(path, "rb");
+            if (f == NULL) {
+                return false;
+            }
+
+            // One byte is always left for the terminator
+            size_t cap = 4096;
+            size_t size = 0;
+            char *buf = (char*)malloc(cap);
+            while (buf != NULL) {
+                if (size + 1 == cap) {
+                    char *nbuf = (char*)realloc(buf, cap * 2);
+                    if (nbuf == NULL) {
+                        free(buf);
+                    }
+                    buf = nbuf;
+                    cap *= 2;
+                    continue;
+                }
+                size_t n = fread(buf + size, 1, cap - size - 1, f);
+                if (n == 0) {
+                    break;
+                }
+                size += n;
+            }
+            bool ok = buf != NULL && ferror(f) == 0;
+            fclose(f);
+            if (!ok) {
+                free(buf);
+                return false;
+            }
+
+            buf[size] = 0;
+            data_ = buf;
+            size_ = size;
+
+            return true;
+        }
+
+        void mapped_file::__release() {
+            if (data_ == NULL) {
+                return;
+            }
+
+#if !defined(WIN32)
+            if (map_size_ > 0) {
+                munmap(data_, map_size_);
+            } else {
+                free(data_);
+            }
+#else
+            free(data_);
+#endif
+            data_ = NULL;
+            size_ = 0;
+            map_size_ = 0;
+        }
+
+        static inline bool is_response_file(const char *arg) {
+            return arg[0] == '@' && arg[1] != 0;
+        }
+
+        static inline bool is_end_of_options(const char *arg) {
+            return arg[0] == '-' && arg[1] == '-' && arg[2] == 0;
+        }
+
+        // Position of the first response file, cnt if there is none. Args after "--"
+        // are not response files, ended is set if "--" comes first.
+        static size_t find_response_file(const char *const *args, size_t cnt, bool &ended) {
+            for (size_t i = 0; i < cnt; i++) {
+                if (is_end_of_options(args[i])) {
+                    ended = true;
+                    return cnt;
+                }
+                if (is_response_file(args[i])) {
+                    return i;
+                }
+            }
+            return cnt;
+        }
+
+        bool has_response_file(int argc, const char **argv) {
+            bool ended = false;
+            return argc > 1 && find_response_file(argv + 1, (size_t)argc - 1, ended) < (size_t)argc - 1;
+        }
+
+        static bool expand_args(const char **argv, 
+                                size_t argc, 
+                                int depth,
+                                bool &ended,
+                                std::vector<const char*> &args, 
+                                std::vector<mapped_file*> &files,
+                                std::string &err) {
+            for (size_t i = 0; i < argc; i++) {
+                const char *arg = argv[i];
+                if (ended || !is_response_file(arg)) {
+                    ended = ended || is_end_of_options(arg);
+                    args.push_back(arg);
+                    continue;
+                }
+
+                const char *path = arg + 1;
+                if (depth >= MAX_RESPONSE_FILE_DEPTH) {
+                    err.assign("response file ").append(path).append(" nested too deep\n");
+                    return false;
+                }
+
+                mapped_file *file = new mapped_file();
+                files.push_back(file);
+                if (!file->open(path)) {
+                    err.assign("open response file ").append(path).append(" failed\n");
+                    return false;
+                }
+
+                // Arguments of the file are appended then expanded in place
+                size_t beg = args.size();
+                if (!split_command_line(file->data(), args, true)) {
+                    err.assign("unterminated quote in response file ").append(path).append("\n");
+                    return false;
+                }
+                size_t cnt = args.size() - beg;
+                if (cnt > 0 && find_response_file(&args[beg], cnt, ended) < cnt) {
+                    std::vector<const char*> nested(args.begin() + beg, args.end());
+                    args.resize(beg);
+                    if (!expand_args(&nested[0], cnt, depth + 1, ended, args, files, err)) {
+                        return false;
+                    }
+                }
+            }
+
+            return true;
+        }
+
+        bool expand_response_files(int argc, 
+                                   const char **argv, 
+                                   std::vector<const char*> &args, 
+                                   std::vector<mapped_file*> &files,
+                                   std::string &err) {
+            args.clear();
+            if (argc <= 0) {
+                return true;
+            }
+
+            args.push_back(argv[0]);
+            bool ended = false;
+            return expand_args(argv + 1, (size_t)argc - 1, 0, ended, args, files, err);
+        }
+
+    }
+
+}
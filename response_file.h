@@ -0,0 +1,129 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef easycmd_response_file_h
+#define easycmd_response_file_h
+
+#include <string>
+#include <vector>
+#include <stddef.h>
+
+namespace easycmd {
+
+    namespace internal {
+
+        /*********************************************************************************
+         * Mapped file
+         * Private writable mapping of a file followed by a zero byte, so the content
+         * can be tokenized in place. Pages are only copied when they are written. Files
+         * that can't be mapped, such as pipes, are read into memory instead.
+         ********************************************************************************/
+        class mapped_file
+        {
+        public:
+            /*********************************************************************************
+             * Constructor
+             ********************************************************************************/
+            mapped_file();
+
+            /*********************************************************************************
+             * Deconstructor
+             ********************************************************************************/
+            ~mapped_file();
+
+            /*********************************************************************************
+             * Open file
+             ********************************************************************************/
+            bool open(const char *path);
+
+            /*********************************************************************************
+             * Get content
+             * The content is always followed by a zero byte.
+             ********************************************************************************/
+            char* data() {
+                return data_;
+            }
+            size_t size() const {
+                return size_;
+            }
+
+        private:
+            /*********************************************************************************
+             * Disable copy
+             ********************************************************************************/
+            mapped_file(const mapped_file&);
+            mapped_file& operator=(const mapped_file&);
+
+            /*********************************************************************************
+             * Read file into memory
+             ********************************************************************************/
+            bool __read(const char *path);
+
+            /*********************************************************************************
+             * Release content
+             ********************************************************************************/
+            void __release();
+
+        private:
+            // Content
+            char *data_;
+            size_t size_;
+
+            // Bytes of mapping, zero if the content is read into memory
+            size_t map_size_;
+        };
+
+        /*********************************************************************************
+         * Max nested response files
+         ********************************************************************************/
+        enum { MAX_RESPONSE_FILE_DEPTH = 8 };
+
+        /*********************************************************************************
+         * Check args have response file
+         * argv[0] is the program name and is never a response file, neither are args 
+         * after "--".
+         ********************************************************************************/
+        bool has_response_file(int argc, const char **argv);
+
+        /*********************************************************************************
+         * Expand response files
+         * Each "@path" argument is replaced by the arguments in the file. They are split
+         * like a command line and '#' starts a comment to the end of the line. Response
+         * files can name other response files down to MAX_RESPONSE_FILE_DEPTH levels.
+         * Expansion stops at the first "--", on the command line or in a file, so the
+         * args after it are kept as they are.
+         * The arguments point into the opened files, which are appended to files and
+         * must be kept while the arguments are used.
+         ********************************************************************************/
+        bool expand_response_files(int argc, 
+                                   const char **argv, 
+                                   std::vector<const char*> &args, 
+                                   std::vector<mapped_file*> &files,
+                                   std::string &err);
+
+    }
+
+}
+
+#endif
@@ -0,0 +1,193 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef easycmd_run_error_h
+#define easycmd_run_error_h
+
+#include <string>
+#include <vector>
+
+#include "string_ref.h"
+
+namespace easycmd {
+
+    class command;
+    class option;
+    class positional;
+
+    /*********************************************************************************
+     * Error codes of run
+     ********************************************************************************/
+    enum error_code
+    {
+        ERR_NONE = 0,
+        // Run without args
+        ERR_NO_ARGUMENTS,
+        // Response file can't be read or parsed
+        ERR_RESPONSE_FILE,
+        // Batch line with unterminated quote
+        ERR_UNTERMINATED_QUOTE,
+        // Arg is not a sub command
+        ERR_UNKNOWN_COMMAND,
+        // Config file section can't be parsed
+        ERR_CONFIG_FILE,
+        // Config value is invalid or out of range
+        ERR_CONFIG_INVALID,
+        ERR_CONFIG_OUT_OF_RANGE,
+        // Operand beyond the positional arguments
+        ERR_UNEXPECTED_ARGUMENT,
+        // Arg is not an option of the command
+        ERR_UNKNOWN_OPTION,
+        // Option value is invalid or out of range
+        ERR_INVALID_VALUE,
+        ERR_OUT_OF_RANGE,
+        // Required option or positional argument is not given
+        ERR_OPTION_REQUIRED,
+        ERR_ARGUMENT_REQUIRED,
+        // Action returned non zero
+        ERR_ACTION_FAILED,
+        // Async action was cancelled
+        ERR_TIMEOUT,
+        ERR_SIGNAL,
+        ERR_CANCELLED
+    };
+
+    /*********************************************************************************
+     * Run error
+     * What failed and where, kept by the parse result. Nothing is formatted when the
+     * error is set: parse_result::get_err() formats the text on first call, from the
+     * args of the run, which must still be alive.
+     ********************************************************************************/
+    class run_error
+    {
+    public:
+        /*********************************************************************************
+         * Constructor
+         ********************************************************************************/
+        explicit run_error(const std::vector<const command*> *path)
+          : path_(path) {
+            __clear();
+        }
+
+        /*********************************************************************************
+         * Get error code
+         ********************************************************************************/
+        error_code get_code() const {
+            return code_;
+        }
+
+        /*********************************************************************************
+         * Get offending arg
+         * Index in the args of the run, after response files are expanded, and the arg
+         * itself. The index is -1 and the arg is null if no arg is involved.
+         ********************************************************************************/
+        int get_token() const {
+            return token_;
+        }
+        const char* get_arg() const {
+            return arg_;
+        }
+
+        /*********************************************************************************
+         * Get command reporting the error
+         ********************************************************************************/
+        const command* get_cmd() const {
+            return cmd_;
+        }
+
+        /*********************************************************************************
+         * Get command path
+         * From the root command to the command reporting the error.
+         ********************************************************************************/
+        const std::vector<const command*>& get_path() const {
+            return *path_;
+        }
+
+        /*********************************************************************************
+         * Get option or positional argument involved
+         * Null if there is none, such as for an unknown option.
+         ********************************************************************************/
+        const option* get_option() const {
+            return opt_;
+        }
+        const positional* get_positional() const {
+            return pos_;
+        }
+
+        /*********************************************************************************
+         * Get line of config file
+         * Zero if the error is not of a config value.
+         ********************************************************************************/
+        int get_line() const {
+            return line_;
+        }
+
+    private:
+        friend class command;
+        friend class parse_result;
+
+        /*********************************************************************************
+         * Clear
+         ********************************************************************************/
+        void __clear() {
+            code_ = ERR_NONE;
+            token_ = -1;
+            arg_ = NULL;
+            cmd_ = NULL;
+            opt_ = NULL;
+            pos_ = NULL;
+            line_ = 0;
+            name_ = internal::string_ref();
+            text_.clear();
+        }
+
+    private:
+        // Error code
+        error_code code_;
+
+        // Offending arg
+        int token_;
+        const char *arg_;
+
+        // Command reporting the error and its path
+        const command *cmd_;
+        const std::vector<const command*> *path_;
+
+        // Option or positional argument involved
+        const option *opt_;
+        const positional *pos_;
+
+        // Line of config file
+        int line_;
+
+        // Unknown name that names close to it are suggested for
+        internal::string_ref name_;
+
+        // Text of errors formatted by file readers
+        std::string text_;
+    };
+
+}
+
+#endif
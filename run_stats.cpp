@@ -0,0 +1,83 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "run_stats.h"
+
+#include <stdio.h>
+#include <string.h>
+
+namespace easycmd {
+
+    void run_stats::clear() {
+        memset(phase_ns, 0, sizeof(phase_ns));
+        total_ns = 0;
+        tokens = 0;
+        option_lookups = 0;
+        env_probes = 0;
+        env_vars = 0;
+        allocations = 0;
+        ret = 0;
+    }
+
+    const char* run_stats::phase_name(int phase) {
+        static const char *names[PHASE_COUNT] = {
+            "expand", "dispatch", "defaults", "config", "env", "args", "validate", "action"
+        };
+        return phase >= 0 && phase < PHASE_COUNT ? names[phase] : "";
+    }
+
+    void run_stats::to_json(std::string &des) const {
+        char buf[64];
+        des.append("{\"ret\": ");
+        snprintf(buf, sizeof(buf), "%d", ret);
+        des.append(buf);
+        snprintf(buf, sizeof(buf), ", \"total_ns\": %llu", (unsigned long long)total_ns);
+        des.append(buf);
+
+        des.append(", \"phases_ns\": {");
+        for (int i = 0; i < PHASE_COUNT; i++) {
+            snprintf(buf, sizeof(buf), "%s\"%s\": %llu", 
+                     i > 0 ? ", " : "", phase_name(i), (unsigned long long)phase_ns[i]);
+            des.append(buf);
+        }
+        des.append("}");
+
+        const struct {
+            const char *name;
+            size_t value;
+        } counts[] = {
+            { "tokens", tokens },
+            { "option_lookups", option_lookups },
+            { "env_probes", env_probes },
+            { "env_vars", env_vars },
+            { "allocations", allocations },
+        };
+        for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+            snprintf(buf, sizeof(buf), ", \"%s\": %llu", counts[i].name, (unsigned long long)counts[i].value);
+            des.append(buf);
+        }
+        des.append("}");
+    }
+
+}
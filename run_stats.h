@@ -0,0 +1,120 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef easycmd_run_stats_h
+#define easycmd_run_stats_h
+
+#include <string>
+#include <chrono>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace easycmd {
+
+    /*********************************************************************************
+     * Run phases
+     * Phases of a run in the order they happen.
+     ********************************************************************************/
+    enum run_phase
+    {
+        // Response file expansion
+        PHASE_EXPAND = 0,
+        // Sub command dispatch
+        PHASE_DISPATCH,
+        // Default values
+        PHASE_DEFAULTS,
+        // Config file
+        PHASE_CONFIG,
+        // Environment
+        PHASE_ENV,
+        // Option args
+        PHASE_ARGS,
+        // Required options and arguments
+        PHASE_VALIDATE,
+        // Action callback or usage
+        PHASE_ACTION,
+        PHASE_COUNT
+    };
+
+    /*********************************************************************************
+     * Run stats
+     * Timings are only measured when the run is traced, see command::with_trace.
+     ********************************************************************************/
+    struct run_stats
+    {
+        // Nanoseconds of each phase and of the whole run
+        uint64_t phase_ns[PHASE_COUNT];
+        uint64_t total_ns;
+
+        // Args tokenized
+        size_t tokens;
+        // Options looked up by name
+        size_t option_lookups;
+        // Env names probed, and vars in the env index if it is built
+        size_t env_probes;
+        size_t env_vars;
+        // Allocations counted by the alloc counter of the trace
+        size_t allocations;
+
+        // Return value of the run
+        int ret;
+
+        /*********************************************************************************
+         * Constructor
+         ********************************************************************************/
+        run_stats() {
+            clear();
+        }
+
+        /*********************************************************************************
+         * Clear
+         ********************************************************************************/
+        void clear();
+
+        /*********************************************************************************
+         * Append stats as JSON object
+         ********************************************************************************/
+        void to_json(std::string &des) const;
+
+        /*********************************************************************************
+         * Get phase name
+         ********************************************************************************/
+        static const char* phase_name(int phase);
+    };
+
+    namespace internal {
+
+        /*********************************************************************************
+         * Monotonic clock in nanoseconds
+         ********************************************************************************/
+        inline uint64_t trace_clock_ns() {
+            return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+    }
+
+}
+
+#endif
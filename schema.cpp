@@ -0,0 +1,516 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "schema.h"
+#include "command.h"
+#include "response_file.h"
+
+#include <map>
+#include <vector>
+#include <string.h>
+#include <algorithm>
+
+namespace easycmd {
+
+    namespace internal
+    {
+        static const char schema_magic[8] = { 'E', 'C', 'S', 'C', 'H', 'E', 'M', 'A' };
+
+        /*********************************************************************************
+         * String table of schema
+         * Offset 0 is the empty string, equal strings are stored once.
+         ********************************************************************************/
+        class schema_strings
+        {
+        public:
+            schema_strings() 
+              : data_(1, '\0') {
+            }
+
+            uint32_t add(const char *str) {
+                if (str == NULL || str[0] == 0) {
+                    return 0;
+                }
+                std::map<std::string, uint32_t>::iterator it = index_.find(str);
+                if (it != index_.end()) {
+                    return it->second;
+                }
+                uint32_t off = (uint32_t)data_.size();
+                data_.append(str, strlen(str) + 1);
+                index_[str] = off;
+                return off;
+            }
+
+            uint32_t add_bytes(const void *bytes, size_t size) {
+                uint32_t off = (uint32_t)data_.size();
+                data_.append((const char*)bytes, size);
+                data_.push_back('\0');
+                return off;
+            }
+
+            const std::string& data() const {
+                return data_;
+            }
+
+        private:
+            std::string data_;
+            std::map<std::string, uint32_t> index_;
+        };
+
+        static size_t align8(size_t off) {
+            return (off + 7) & ~(size_t)7;
+        }
+
+        static bool check_table(const schema_header *hdr, uint32_t off, uint32_t cnt, size_t rec_size, size_t align) {
+            return off % align == 0 && off >= sizeof(schema_header) && 
+                   (uint64_t)off + (uint64_t)cnt * rec_size <= hdr->size;
+        }
+
+        // The string at off must end within the string table
+        static bool check_str(const char *strs, uint32_t str_size, uint32_t off) {
+            return off < str_size && memchr(strs + off, 0, str_size - off) != NULL;
+        }
+
+        // Long names of the options of a command, for sorting the option index
+        struct option_name_less
+        {
+            const schema_opt_rec *opts;
+            const char *strs;
+            bool operator()(uint32_t a, uint32_t b) const {
+                return strcmp(strs + opts[a].long_name, strs + opts[b].long_name) < 0;
+            }
+        };
+    }
+
+    void command::get_schema(std::string &des) const {
+        // Commands are numbered breadth first from this one, all sub commands of 
+        // definitions and factories are created on the way.
+        std::vector<const command*> cmds(1, this);
+        std::vector<bool> is_public(1, false);
+        std::vector<command_map> subs;
+        std::vector<command_map> publics;
+        std::map<const command*, uint32_t> ids;
+        ids[this] = 0;
+        for (size_t i = 0; i < cmds.size(); i++) {
+            subs.push_back(command_map());
+            publics.push_back(command_map());
+            cmds[i]->__load_sub_cmds(subs[i], publics[i]);
+            for (int p = 0; p < 2; p++) {
+                const command_map &m = p ? publics[i] : subs[i];
+                for (command_map::const_iterator it = m.begin(); it != m.end(); it++) {
+                    if (ids.find(it->second) == ids.end()) {
+                        ids[it->second] = (uint32_t)cmds.size();
+                        cmds.push_back(it->second);
+                        is_public.push_back(p == 1);
+                    }
+                }
+            }
+        }
+
+        internal::schema_strings strs;
+        std::vector<internal::schema_cmd_rec> cmd_recs(cmds.size());
+        std::vector<internal::schema_opt_rec> opt_recs;
+        std::vector<internal::schema_pos_rec> pos_recs;
+        std::vector<uint32_t> refs;
+        for (size_t i = 0; i < cmds.size(); i++) {
+            const command *cmd = cmds[i];
+            internal::schema_cmd_rec &rec = cmd_recs[i];
+            memset(&rec, 0, sizeof(rec));
+            rec.name = strs.add(cmd->name_);
+            rec.desc = strs.add(cmd->desc_);
+            rec.env_prefix = strs.add(cmd->env_prefix_);
+            rec.parent = internal::SCHEMA_NONE;
+            if (cmd != this && ids.find(cmd->parent_cmd_) != ids.end()) {
+                rec.parent = ids[cmd->parent_cmd_];
+            }
+            if (is_public[i]) {
+                rec.flags |= internal::SCHEMA_CMD_PUBLIC;
+            }
+            if (cmd->action_cb_ || cmd->result_action_cb_ || cmd->async_action_cb_) {
+                rec.flags |= internal::SCHEMA_CMD_ACTION;
+            }
+
+            rec.opts = (uint32_t)opt_recs.size();
+            rec.opt_count = (uint32_t)cmd->options_.size();
+            for (size_t j = 0; j < cmd->options_.size(); j++) {
+                const option *opt = cmd->options_[j];
+                internal::schema_opt_rec orec;
+                memset(&orec, 0, sizeof(orec));
+                orec.long_name = strs.add(opt->long_name_);
+                orec.short_name = strs.add(opt->short_name_);
+                orec.env = strs.add(opt->env_);
+                orec.desc = strs.add(opt->desc_);
+                orec.type = (uint32_t)opt->type_;
+                orec.flags = opt->required_ ? internal::SCHEMA_OPT_REQUIRED : 0;
+                if (opt->type_ == internal::OP_TYPE_BOOL) {
+                    orec.def_int = opt->def_val_.b ? 1 : 0;
+                } else if (opt->type_ == internal::OP_TYPE_INT) {
+                    orec.def_int = opt->def_val_.i;
+                } else if (opt->type_ == internal::OP_TYPE_FLOAT) {
+                    orec.def_float = opt->def_val_.f;
+                } else if (opt->type_ == internal::OP_TYPE_STRING) {
+                    orec.def_str = strs.add(opt->def_val_s_);
+                } else if (opt->choices_) {
+                    std::string choices;
+                    opt->choices_->join("|", choices);
+                    orec.def_int = opt->def_val_.i;
+                    orec.def_str = strs.add(choices.c_str());
+                } else if (opt->typed_) {
+                    orec.def_str = strs.add_bytes(opt->typed_->def, opt->typed_->size);
+                    orec.def_size = (uint32_t)opt->typed_->size;
+                }
+                opt_recs.push_back(orec);
+            }
+
+            rec.opt_index = (uint32_t)refs.size();
+            for (size_t j = 0; j < cmd->options_.size(); j++) {
+                if (cmd->options_[j]->long_name_[0] != 0) {
+                    refs.push_back(rec.opts + (uint32_t)j);
+                }
+            }
+            rec.opt_index_count = (uint32_t)refs.size() - rec.opt_index;
+
+            rec.positionals = (uint32_t)pos_recs.size();
+            rec.pos_count = (uint32_t)cmd->positionals_.size();
+            for (size_t j = 0; j < cmd->positionals_.size(); j++) {
+                const positional *pos = cmd->positionals_[j];
+                internal::schema_pos_rec prec;
+                prec.name = strs.add(pos->name_);
+                prec.desc = strs.add(pos->desc_);
+                prec.flags = (pos->required_ ? internal::SCHEMA_POS_REQUIRED : 0) | 
+                             (pos->tail_ ? internal::SCHEMA_POS_TAIL : 0);
+                pos_recs.push_back(prec);
+            }
+
+            // Maps are ordered by name, as the reader searches them
+            rec.subs = (uint32_t)refs.size();
+            rec.sub_count = (uint32_t)subs[i].size();
+            for (command_map::const_iterator it = subs[i].begin(); it != subs[i].end(); it++) {
+                refs.push_back(ids[it->second]);
+            }
+            rec.publics = (uint32_t)refs.size();
+            rec.public_count = (uint32_t)publics[i].size();
+            for (command_map::const_iterator it = publics[i].begin(); it != publics[i].end(); it++) {
+                refs.push_back(ids[it->second]);
+            }
+        }
+
+        // Option index is sorted once all strings are placed
+        const std::string &str_data = strs.data();
+        internal::option_name_less less = { opt_recs.empty() ? NULL : &opt_recs[0], str_data.data() };
+        for (size_t i = 0; i < cmd_recs.size(); i++) {
+            std::vector<uint32_t>::iterator beg = refs.begin() + cmd_recs[i].opt_index;
+            std::sort(beg, beg + cmd_recs[i].opt_index_count, less);
+        }
+
+        internal::schema_header hdr;
+        memset(&hdr, 0, sizeof(hdr));
+        memcpy(hdr.magic, internal::schema_magic, sizeof(hdr.magic));
+        hdr.version = internal::SCHEMA_VERSION;
+        hdr.byte_order = internal::SCHEMA_BYTE_ORDER;
+        size_t off = internal::align8(sizeof(hdr));
+        hdr.cmd_count = (uint32_t)cmd_recs.size();
+        hdr.cmds = (uint32_t)off;
+        off = internal::align8(off + cmd_recs.size() * sizeof(internal::schema_cmd_rec));
+        hdr.opt_count = (uint32_t)opt_recs.size();
+        hdr.opts = (uint32_t)off;
+        off = internal::align8(off + opt_recs.size() * sizeof(internal::schema_opt_rec));
+        hdr.pos_count = (uint32_t)pos_recs.size();
+        hdr.positionals = (uint32_t)off;
+        off = internal::align8(off + pos_recs.size() * sizeof(internal::schema_pos_rec));
+        hdr.ref_count = (uint32_t)refs.size();
+        hdr.refs = (uint32_t)off;
+        off = off + refs.size() * sizeof(uint32_t);
+        hdr.str_size = (uint32_t)str_data.size();
+        hdr.strs = (uint32_t)off;
+        off = internal::align8(off + str_data.size());
+        hdr.size = (uint32_t)off;
+
+        des.assign(off, '\0');
+        memcpy(&des[0], &hdr, sizeof(hdr));
+        memcpy(&des[hdr.cmds], &cmd_recs[0], cmd_recs.size() * sizeof(internal::schema_cmd_rec));
+        if (!opt_recs.empty()) {
+            memcpy(&des[hdr.opts], &opt_recs[0], opt_recs.size() * sizeof(internal::schema_opt_rec));
+        }
+        if (!pos_recs.empty()) {
+            memcpy(&des[hdr.positionals], &pos_recs[0], pos_recs.size() * sizeof(internal::schema_pos_rec));
+        }
+        if (!refs.empty()) {
+            memcpy(&des[hdr.refs], &refs[0], refs.size() * sizeof(uint32_t));
+        }
+        memcpy(&des[hdr.strs], str_data.data(), str_data.size());
+    }
+
+    const char* schema_command::get_name() const {
+        return schema_->__strs() + rec_->name;
+    }
+
+    const char* schema_command::get_desc() const {
+        return schema_->__strs() + rec_->desc;
+    }
+
+    const char* schema_command::get_env_prefix() const {
+        return schema_->__strs() + rec_->env_prefix;
+    }
+
+    schema_command schema_command::get_parent() const {
+        if (rec_->parent == internal::SCHEMA_NONE) {
+            return schema_command();
+        }
+        return schema_command(schema_, schema_->__cmd(rec_->parent));
+    }
+
+    schema_option schema_command::get_option(size_t i) const {
+        if (i >= rec_->opt_count) {
+            return schema_option();
+        }
+        return schema_option(schema_->__opt(rec_->opts + (uint32_t)i), schema_->__strs());
+    }
+
+    schema_option schema_command::find_option(const char *name) const {
+        const char *strs = schema_->__strs();
+        size_t lo = 0;
+        size_t hi = rec_->opt_index_count;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            const internal::schema_opt_rec *opt = schema_->__opt(schema_->__ref(rec_->opt_index + (uint32_t)mid));
+            int cmp = strcmp(strs + opt->long_name, name);
+            if (cmp == 0) {
+                return schema_option(opt, strs);
+            }
+            if (cmp < 0) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+
+        for (uint32_t i = 0; i < rec_->opt_count; i++) {
+            const internal::schema_opt_rec *opt = schema_->__opt(rec_->opts + i);
+            if (opt->short_name != 0 && strcmp(strs + opt->short_name, name) == 0) {
+                return schema_option(opt, strs);
+            }
+        }
+
+        return schema_option();
+    }
+
+    schema_positional schema_command::get_positional(size_t i) const {
+        if (i >= rec_->pos_count) {
+            return schema_positional();
+        }
+        return schema_positional(schema_->__pos(rec_->positionals + (uint32_t)i), schema_->__strs());
+    }
+
+    schema_command schema_command::get_sub_cmd(size_t i) const {
+        if (i >= rec_->sub_count) {
+            return schema_command();
+        }
+        return schema_command(schema_, schema_->__cmd(schema_->__ref(rec_->subs + (uint32_t)i)));
+    }
+
+    schema_command schema_command::get_public_sub_cmd(size_t i) const {
+        if (i >= rec_->public_count) {
+            return schema_command();
+        }
+        return schema_command(schema_, schema_->__cmd(schema_->__ref(rec_->publics + (uint32_t)i)));
+    }
+
+    schema_command schema_command::find_sub_cmd(const char *name) const {
+        return __search(rec_->subs, rec_->sub_count, name);
+    }
+
+    schema_command schema_command::find_public_sub_cmd(const char *name) const {
+        return __search(rec_->publics, rec_->public_count, name);
+    }
+
+    schema_command schema_command::__search(uint32_t refs, uint32_t cnt, const char *name) const {
+        const char *strs = schema_->__strs();
+        size_t lo = 0;
+        size_t hi = cnt;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            const internal::schema_cmd_rec *cmd = schema_->__cmd(schema_->__ref(refs + (uint32_t)mid));
+            int cmp = strcmp(strs + cmd->name, name);
+            if (cmp == 0) {
+                return schema_command(schema_, cmd);
+            }
+            if (cmp < 0) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return schema_command();
+    }
+
+    schema::schema()
+      : file_(NULL),
+        base_(NULL),
+        hdr_(NULL) {
+    }
+
+    schema::~schema() {
+        delete file_;
+    }
+
+    bool schema::open(const std::string &path, std::string &err) {
+        internal::mapped_file *file = new internal::mapped_file();
+        if (!file->open(path.c_str())) {
+            delete file;
+            err = "open schema file " + path + " failed\n";
+            return false;
+        }
+        if (!load(file->data(), file->size(), err)) {
+            delete file;
+            return false;
+        }
+
+        delete file_;
+        file_ = file;
+
+        return true;
+    }
+
+    bool schema::load(const void *data, size_t size, std::string &err) {
+        if (!__check((const char*)data, size, err)) {
+            return false;
+        }
+
+        // A schema loaded over an opened one drops the file
+        delete file_;
+        file_ = NULL;
+        base_ = (const char*)data;
+        hdr_ = (const internal::schema_header*)data;
+
+        return true;
+    }
+
+    schema_command schema::get_root() const {
+        if (hdr_ == NULL) {
+            return schema_command();
+        }
+        return schema_command(this, __cmd(0));
+    }
+
+    schema_command schema::find(const char *const *names, size_t cnt) const {
+        std::vector<schema_command> path(1, get_root());
+        for (size_t i = 0; i < cnt && path.back().valid(); i++) {
+            schema_command sub = path.back().find_sub_cmd(names[i]);
+            for (size_t j = path.size(); !sub.valid() && j > 0; j--) {
+                sub = path[j - 1].find_public_sub_cmd(names[i]);
+            }
+            path.push_back(sub);
+        }
+        return path.back();
+    }
+
+    bool schema::__check(const char *data, size_t size, std::string &err) const {
+        const internal::schema_header *hdr = (const internal::schema_header*)data;
+        if (((uintptr_t)data & 7) != 0 || 
+            size < sizeof(internal::schema_header) || 
+            memcmp(hdr->magic, internal::schema_magic, sizeof(hdr->magic)) != 0) {
+            err = "not a schema file\n";
+            return false;
+        }
+        if (hdr->version != internal::SCHEMA_VERSION || hdr->byte_order != internal::SCHEMA_BYTE_ORDER) {
+            err = "unsupported schema version or byte order\n";
+            return false;
+        }
+
+        // Everything is checked here, so lookups can trust the records
+        err = "invalid schema\n";
+        if (hdr->size != size || hdr->cmd_count == 0 || hdr->str_size == 0 ||
+            !internal::check_table(hdr, hdr->cmds, hdr->cmd_count, sizeof(internal::schema_cmd_rec), 8) ||
+            !internal::check_table(hdr, hdr->opts, hdr->opt_count, sizeof(internal::schema_opt_rec), 8) ||
+            !internal::check_table(hdr, hdr->positionals, hdr->pos_count, sizeof(internal::schema_pos_rec), 4) ||
+            !internal::check_table(hdr, hdr->refs, hdr->ref_count, sizeof(uint32_t), 4) ||
+            !internal::check_table(hdr, hdr->strs, hdr->str_size, 1, 1)) {
+            return false;
+        }
+
+        const uint32_t str_size = hdr->str_size;
+        const char *strs = data + hdr->strs;
+        const uint32_t *refs = (const uint32_t*)(data + hdr->refs);
+        const internal::schema_cmd_rec *cmds = (const internal::schema_cmd_rec*)(data + hdr->cmds);
+        for (uint32_t i = 0; i < hdr->cmd_count; i++) {
+            const internal::schema_cmd_rec &c = cmds[i];
+            if (!internal::check_str(strs, str_size, c.name) || 
+                !internal::check_str(strs, str_size, c.desc) || 
+                !internal::check_str(strs, str_size, c.env_prefix) ||
+                (c.parent != internal::SCHEMA_NONE && c.parent >= hdr->cmd_count) ||
+                (uint64_t)c.opts + c.opt_count > hdr->opt_count ||
+                (uint64_t)c.positionals + c.pos_count > hdr->pos_count ||
+                (uint64_t)c.opt_index + c.opt_index_count > hdr->ref_count ||
+                (uint64_t)c.subs + c.sub_count > hdr->ref_count ||
+                (uint64_t)c.publics + c.public_count > hdr->ref_count) {
+                return false;
+            }
+            for (uint32_t j = 0; j < c.opt_index_count; j++) {
+                if (refs[c.opt_index + j] >= hdr->opt_count) {
+                    return false;
+                }
+            }
+            for (uint32_t j = 0; j < c.sub_count; j++) {
+                if (refs[c.subs + j] >= hdr->cmd_count) {
+                    return false;
+                }
+            }
+            for (uint32_t j = 0; j < c.public_count; j++) {
+                if (refs[c.publics + j] >= hdr->cmd_count) {
+                    return false;
+                }
+            }
+        }
+
+        const internal::schema_opt_rec *opts = (const internal::schema_opt_rec*)(data + hdr->opts);
+        for (uint32_t i = 0; i < hdr->opt_count; i++) {
+            const internal::schema_opt_rec &o = opts[i];
+            if (!internal::check_str(strs, str_size, o.long_name) || 
+                !internal::check_str(strs, str_size, o.short_name) || 
+                !internal::check_str(strs, str_size, o.env) || 
+                !internal::check_str(strs, str_size, o.desc) || 
+                o.type > internal::OP_TYPE_CHOICE) {
+                return false;
+            }
+            // Default bytes of typed options, the default string or choices otherwise
+            if (o.def_size > 0 ? (uint64_t)o.def_str + o.def_size > str_size 
+                               : !internal::check_str(strs, str_size, o.def_str)) {
+                return false;
+            }
+        }
+
+        const internal::schema_pos_rec *poss = (const internal::schema_pos_rec*)(data + hdr->positionals);
+        for (uint32_t i = 0; i < hdr->pos_count; i++) {
+            if (!internal::check_str(strs, str_size, poss[i].name) || 
+                !internal::check_str(strs, str_size, poss[i].desc)) {
+                return false;
+            }
+        }
+
+        err.clear();
+        return true;
+    }
+
+}
@@ -0,0 +1,458 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef easycmd_schema_h
+#define easycmd_schema_h
+
+#include <string>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "option.h"
+
+namespace easycmd {
+
+    namespace internal {
+
+        class mapped_file;
+
+        /*********************************************************************************
+         * Schema format
+         * A header followed by tables of commands, options, positional arguments, refs
+         * and strings. Records refer to each other by table index and to strings by
+         * offset in the string table, so the file can be used wherever it is mapped.
+         * Refs hold the sorted sub commands and the long name index of commands.
+         ********************************************************************************/
+        enum 
+        {
+            SCHEMA_VERSION = 1,
+            SCHEMA_BYTE_ORDER = 0x01020304,
+            SCHEMA_NONE = 0xffffffff
+        };
+
+        enum
+        {
+            SCHEMA_CMD_PUBLIC = 1,
+            SCHEMA_CMD_ACTION = 2,
+            SCHEMA_OPT_REQUIRED = 1,
+            SCHEMA_POS_REQUIRED = 1,
+            SCHEMA_POS_TAIL = 2
+        };
+
+        struct schema_header
+        {
+            char magic[8];
+            uint32_t version;
+            uint32_t byte_order;
+            uint32_t size;
+            uint32_t cmd_count;
+            uint32_t cmds;
+            uint32_t opt_count;
+            uint32_t opts;
+            uint32_t pos_count;
+            uint32_t positionals;
+            uint32_t ref_count;
+            uint32_t refs;
+            uint32_t str_size;
+            uint32_t strs;
+            uint32_t reserved;
+        };
+
+        struct schema_cmd_rec
+        {
+            uint32_t name;
+            uint32_t desc;
+            uint32_t env_prefix;
+            uint32_t parent;
+            uint32_t flags;
+            // Options in order of creation
+            uint32_t opts;
+            uint32_t opt_count;
+            // Refs of options with long name, sorted by long name
+            uint32_t opt_index;
+            uint32_t opt_index_count;
+            uint32_t positionals;
+            uint32_t pos_count;
+            // Refs of sub commands sorted by name
+            uint32_t subs;
+            uint32_t sub_count;
+            uint32_t publics;
+            uint32_t public_count;
+            uint32_t reserved;
+        };
+
+        struct schema_opt_rec
+        {
+            uint32_t long_name;
+            uint32_t short_name;
+            uint32_t env;
+            uint32_t desc;
+            uint32_t type;
+            uint32_t flags;
+            // Default string, or default bytes of typed option
+            uint32_t def_str;
+            uint32_t def_size;
+            int64_t def_int;
+            double def_float;
+        };
+
+        struct schema_pos_rec
+        {
+            uint32_t name;
+            uint32_t desc;
+            uint32_t flags;
+        };
+
+    }
+
+    class schema;
+
+    /*********************************************************************************
+     * Schema option
+     ********************************************************************************/
+    class schema_option
+    {
+    public:
+        schema_option()
+          : rec_(NULL), 
+            strs_(NULL) {
+        }
+
+        /*********************************************************************************
+         * Check the option is found
+         ********************************************************************************/
+        bool valid() const {
+            return rec_ != NULL;
+        }
+
+        /*********************************************************************************
+         * Get names, env and desc
+         ********************************************************************************/
+        const char* get_long_name() const {
+            return strs_ + rec_->long_name;
+        }
+        const char* get_short_name() const {
+            return strs_ + rec_->short_name;
+        }
+        const char* get_env() const {
+            return strs_ + rec_->env;
+        }
+        const char* get_desc() const {
+            return strs_ + rec_->desc;
+        }
+
+        /*********************************************************************************
+         * Get option type
+         ********************************************************************************/
+        internal::option_type get_type() const {
+            return (internal::option_type)rec_->type;
+        }
+
+        /*********************************************************************************
+         * Get required status
+         ********************************************************************************/
+        bool is_required() const {
+            return (rec_->flags & internal::SCHEMA_OPT_REQUIRED) != 0;
+        }
+
+        /*********************************************************************************
+         * Get default value
+         * Typed options have the bytes of their default value, choice options have the
+         * id of their default value as int.
+         ********************************************************************************/
+        int get_default_int() const {
+            return (int)rec_->def_int;
+        }
+        bool get_default_bool() const {
+            return rec_->def_int != 0;
+        }
+        double get_default_float() const {
+            return rec_->def_float;
+        }
+        const char* get_default_string() const {
+            return strs_ + rec_->def_str;
+        }
+        const void* get_default_bytes(size_t &size) const {
+            size = rec_->def_size;
+            return strs_ + rec_->def_str;
+        }
+
+        /*********************************************************************************
+         * Get accepted values of choice option
+         * The values are joined by '|', empty if the option is not a choice option.
+         ********************************************************************************/
+        const char* get_choices() const {
+            return rec_->type == internal::OP_TYPE_CHOICE ? strs_ + rec_->def_str : "";
+        }
+
+    private:
+        friend class schema_command;
+
+        schema_option(const internal::schema_opt_rec *rec, const char *strs)
+          : rec_(rec), 
+            strs_(strs) {
+        }
+
+    private:
+        const internal::schema_opt_rec *rec_;
+        const char *strs_;
+    };
+
+    /*********************************************************************************
+     * Schema positional argument
+     ********************************************************************************/
+    class schema_positional
+    {
+    public:
+        schema_positional()
+          : rec_(NULL), 
+            strs_(NULL) {
+        }
+
+        bool valid() const {
+            return rec_ != NULL;
+        }
+        const char* get_name() const {
+            return strs_ + rec_->name;
+        }
+        const char* get_desc() const {
+            return strs_ + rec_->desc;
+        }
+        bool is_required() const {
+            return (rec_->flags & internal::SCHEMA_POS_REQUIRED) != 0;
+        }
+        bool is_tail() const {
+            return (rec_->flags & internal::SCHEMA_POS_TAIL) != 0;
+        }
+
+    private:
+        friend class schema_command;
+
+        schema_positional(const internal::schema_pos_rec *rec, const char *strs)
+          : rec_(rec), 
+            strs_(strs) {
+        }
+
+    private:
+        const internal::schema_pos_rec *rec_;
+        const char *strs_;
+    };
+
+    /*********************************************************************************
+     * Schema command
+     * A view of a command record, valid while the schema is open.
+     ********************************************************************************/
+    class schema_command
+    {
+    public:
+        schema_command()
+          : schema_(NULL), 
+            rec_(NULL) {
+        }
+
+        /*********************************************************************************
+         * Check the command is found
+         ********************************************************************************/
+        bool valid() const {
+            return rec_ != NULL;
+        }
+
+        /*********************************************************************************
+         * Get name, desc and env prefix
+         ********************************************************************************/
+        const char* get_name() const;
+        const char* get_desc() const;
+        const char* get_env_prefix() const;
+
+        /*********************************************************************************
+         * Get status
+         * A public sub command is shared by all sub commands of its parent.
+         ********************************************************************************/
+        bool is_public() const {
+            return (rec_->flags & internal::SCHEMA_CMD_PUBLIC) != 0;
+        }
+        bool has_action() const {
+            return (rec_->flags & internal::SCHEMA_CMD_ACTION) != 0;
+        }
+
+        /*********************************************************************************
+         * Get parent command
+         * Invalid for the exported command.
+         ********************************************************************************/
+        schema_command get_parent() const;
+
+        /*********************************************************************************
+         * Get options in order of creation
+         ********************************************************************************/
+        size_t get_option_count() const {
+            return rec_->opt_count;
+        }
+        schema_option get_option(size_t i) const;
+
+        /*********************************************************************************
+         * Find option by long name or short name
+         * Long names are binary searched. Return invalid option if not found.
+         ********************************************************************************/
+        schema_option find_option(const char *name) const;
+
+        /*********************************************************************************
+         * Get positional arguments
+         ********************************************************************************/
+        size_t get_positional_count() const {
+            return rec_->pos_count;
+        }
+        schema_positional get_positional(size_t i) const;
+
+        /*********************************************************************************
+         * Get sub commands and public sub commands sorted by name
+         ********************************************************************************/
+        size_t get_sub_cmd_count() const {
+            return rec_->sub_count;
+        }
+        schema_command get_sub_cmd(size_t i) const;
+        size_t get_public_sub_cmd_count() const {
+            return rec_->public_count;
+        }
+        schema_command get_public_sub_cmd(size_t i) const;
+
+        /*********************************************************************************
+         * Find sub command or public sub command added to this command
+         * Return invalid command if not found.
+         ********************************************************************************/
+        schema_command find_sub_cmd(const char *name) const;
+        schema_command find_public_sub_cmd(const char *name) const;
+
+    private:
+        friend class schema;
+
+        schema_command(const schema *s, const internal::schema_cmd_rec *rec)
+          : schema_(s), 
+            rec_(rec) {
+        }
+
+        /*********************************************************************************
+         * Binary search refs of commands by name
+         ********************************************************************************/
+        schema_command __search(uint32_t refs, uint32_t cnt, const char *name) const;
+
+    private:
+        const schema *schema_;
+        const internal::schema_cmd_rec *rec_;
+    };
+
+    /*********************************************************************************
+     * Schema
+     * Reader of a command tree exported by command::get_schema. The file is mapped
+     * and checked once when opened, then lookups read the records in place.
+     ********************************************************************************/
+    class schema
+    {
+    public:
+        /*********************************************************************************
+         * Constructor
+         ********************************************************************************/
+        schema();
+
+        /*********************************************************************************
+         * Deconstructor
+         ********************************************************************************/
+        ~schema();
+
+        /*********************************************************************************
+         * Open schema file
+         * Return false with the error if the file can't be read or is not valid.
+         ********************************************************************************/
+        bool open(const std::string &path, std::string &err);
+
+        /*********************************************************************************
+         * Load schema from memory
+         * The data must be 8 bytes aligned and alive while the schema is used.
+         ********************************************************************************/
+        bool load(const void *data, size_t size, std::string &err);
+
+        /*********************************************************************************
+         * Get exported command
+         ********************************************************************************/
+        schema_command get_root() const;
+
+        /*********************************************************************************
+         * Get command count
+         ********************************************************************************/
+        size_t get_cmd_count() const {
+            return hdr_ ? hdr_->cmd_count : 0;
+        }
+
+        /*********************************************************************************
+         * Find command by path of sub command names
+         * Names are resolved as run() dispatches: sub commands of the current command,
+         * then public sub commands of the path from the current command up to the root.
+         * Return invalid command if a name is not found.
+         ********************************************************************************/
+        schema_command find(const char *const *names, size_t cnt) const;
+
+    private:
+        friend class schema_command;
+
+        /*********************************************************************************
+         * Disable copy
+         ********************************************************************************/
+        schema(const schema&);
+        schema& operator=(const schema&);
+
+        /*********************************************************************************
+         * Check all records
+         ********************************************************************************/
+        bool __check(const char *data, size_t size, std::string &err) const;
+
+        /*********************************************************************************
+         * Get records
+         ********************************************************************************/
+        const internal::schema_cmd_rec* __cmd(uint32_t idx) const {
+            return (const internal::schema_cmd_rec*)(base_ + hdr_->cmds) + idx;
+        }
+        const internal::schema_opt_rec* __opt(uint32_t idx) const {
+            return (const internal::schema_opt_rec*)(base_ + hdr_->opts) + idx;
+        }
+        const internal::schema_pos_rec* __pos(uint32_t idx) const {
+            return (const internal::schema_pos_rec*)(base_ + hdr_->positionals) + idx;
+        }
+        uint32_t __ref(uint32_t idx) const {
+            return ((const uint32_t*)(base_ + hdr_->refs))[idx];
+        }
+        const char* __strs() const {
+            return base_ + hdr_->strs;
+        }
+
+    private:
+        // Mapped file, null if loaded from memory
+        internal::mapped_file *file_;
+
+        // Schema data
+        const char *base_;
+        const internal::schema_header *hdr_;
+    };
+
+}
+
+#endif
@@ -0,0 +1,72 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef easycmd_string_ref_h
+#define easycmd_string_ref_h
+
+#include <string.h>
+#include <stddef.h>
+
+namespace easycmd {
+
+    namespace internal {
+
+        /*********************************************************************************
+         * String reference
+         * Non owning view of characters, the referenced memory must outlive the view.
+         ********************************************************************************/
+        struct string_ref
+        {
+            string_ref()
+              : data(""),
+                size(0) {
+            }
+
+            string_ref(const char *d, size_t n)
+              : data(d),
+                size(n) {
+            }
+
+            explicit string_ref(const char *d)
+              : data(d),
+                size(strlen(d)) {
+            }
+
+            bool empty() const {
+                return size == 0;
+            }
+
+            bool equal(const char *s, size_t n) const {
+                return size == n && memcmp(data, s, n) == 0;
+            }
+
+            const char *data;
+            size_t size;
+        };
+
+    }
+
+}
+
+#endif
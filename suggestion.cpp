@@ -0,0 +1,205 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "command.h"
+#include "suggestion.h"
+
+#include <string.h>
+
+namespace easycmd {
+
+    namespace internal {
+
+        void build_peq(const char *pattern, size_t len, uint64_t peq[256]) {
+            memset(peq, 0, sizeof(uint64_t) * 256);
+            for (size_t i = 0; i < len; i++) {
+                peq[(unsigned char)pattern[i]] |= (uint64_t)1 << i;
+            }
+        }
+
+        size_t edit_distance(const uint64_t peq[256], 
+                             size_t pattern_len, 
+                             const char *text, 
+                             size_t text_len,
+                             size_t max_dist) {
+            if (pattern_len == 0) {
+                return text_len <= max_dist ? text_len : max_dist + 1;
+            }
+
+            // Vertical deltas of the column are +1 (pv) or -1 (mv), the score is the 
+            // last cell of the column.
+            uint64_t pv = ~(uint64_t)0;
+            uint64_t mv = 0;
+            uint64_t last = (uint64_t)1 << (pattern_len - 1);
+            size_t score = pattern_len;
+            for (size_t j = 0; j < text_len; j++) {
+                uint64_t eq = peq[(unsigned char)text[j]];
+                uint64_t xv = eq | mv;
+                uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+                uint64_t ph = mv | ~(xh | pv);
+                uint64_t mh = pv & xh;
+                if (ph & last) {
+                    score++;
+                } else if (mh & last) {
+                    score--;
+                }
+
+                // The first row is the text position, so a +1 delta comes in from the top
+                ph = (ph << 1) | 1;
+                mh = mh << 1;
+                pv = mh | ~(xv | ph);
+                mv = ph & xv;
+
+                // The score drops at most one per remaining character
+                if (score > max_dist + (text_len - j - 1)) {
+                    return max_dist + 1;
+                }
+            }
+
+            return score <= max_dist ? score : max_dist + 1;
+        }
+
+        suggestion::suggestion(const char *word, size_t len)
+          : len_(len),
+            max_dist_(0),
+            cnt_(0) {
+            if (len_ > 64) {
+                return;
+            }
+            max_dist_ = len_ < 4 ? 1 : (len_ < 8 ? 2 : 3);
+            build_peq(word, len_, peq_);
+        }
+
+        void suggestion::add(const char *prefix, const char *name) {
+            if (max_dist_ == 0) {
+                return;
+            }
+
+            size_t len = strlen(name);
+            size_t diff = len > len_ ? len - len_ : len_ - len;
+            if (diff > max_dist_) {
+                return;
+            }
+
+            // Only a candidate better than the worst kept one is interesting
+            size_t limit = max_dist_;
+            if (cnt_ == MAX_SUGGESTIONS) {
+                limit = best_[cnt_ - 1].dist - 1;
+                if (best_[cnt_ - 1].dist == 0 || diff > limit) {
+                    return;
+                }
+            }
+
+            size_t dist = edit_distance(peq_, len_, name, len, limit);
+            if (dist > limit) {
+                return;
+            }
+
+            // The same name may be both a sub command and a public sub command
+            for (size_t i = 0; i < cnt_; i++) {
+                if (strcmp(best_[i].name, name) == 0 && strcmp(best_[i].prefix, prefix) == 0) {
+                    return;
+                }
+            }
+
+            size_t pos = cnt_ < MAX_SUGGESTIONS ? cnt_++ : cnt_ - 1;
+            while (pos > 0 && best_[pos - 1].dist > dist) {
+                best_[pos] = best_[pos - 1];
+                pos--;
+            }
+            best_[pos].prefix = prefix;
+            best_[pos].name = name;
+            best_[pos].dist = dist;
+        }
+
+        void suggestion::format(std::string &des) const {
+            if (cnt_ == 0) {
+                return;
+            }
+
+            des.append("did you mean: ");
+            for (size_t i = 0; i < cnt_; i++) {
+                if (i > 0) {
+                    des.append(", ");
+                }
+                des.append(best_[i].prefix).append(best_[i].name);
+            }
+            des.append("\n");
+        }
+
+    }
+
+    void command::__suggest_cmd(const std::string &name, 
+                                const parse_result &res, 
+                                std::string &hint) const {
+        internal::suggestion sug(name.data(), name.size());
+
+        command_map::const_iterator it;
+        for (it = sub_cmds_.begin(); it != sub_cmds_.end(); it++) {
+            sug.add("", it->second->name_);
+        }
+        lazy_cmd_map::const_iterator lit;
+        for (lit = lazy_sub_cmds_.begin(); lit != lazy_sub_cmds_.end(); lit++) {
+            sug.add("", lit->second->name);
+        }
+        if (def_) {
+            for (int i = 0; i < def_->sub_cmd_count; i++) {
+                sug.add("", def_->sub_cmds[i]->name);
+            }
+        }
+
+        // The current command is the last one of the path
+        for (size_t i = res.path_.size(); i > 0; i--) {
+            const command *cmd = res.path_[i - 1];
+            for (it = cmd->public_sub_cmds_.begin(); it != cmd->public_sub_cmds_.end(); it++) {
+                sug.add("", it->second->name_);
+            }
+            for (lit = cmd->lazy_public_sub_cmds_.begin(); lit != cmd->lazy_public_sub_cmds_.end(); lit++) {
+                sug.add("", lit->second->name);
+            }
+            if (cmd->def_) {
+                for (int j = 0; j < cmd->def_->public_sub_cmd_count; j++) {
+                    sug.add("", cmd->def_->public_sub_cmds[j]->name);
+                }
+            }
+        }
+
+        sug.format(hint);
+    }
+
+    void command::__suggest_option(const internal::string_ref &name, std::string &hint) const {
+        internal::suggestion sug(name.data, name.size);
+        for (size_t i = 0; i < options_.size(); i++) {
+            const option *opt = options_[i];
+            if (opt->long_name_[0] != 0) {
+                sug.add("--", opt->long_name_);
+            }
+            if (opt->short_name_[0] != 0 && opt->short_name_[1] != 0) {
+                sug.add("-", opt->short_name_);
+            }
+        }
+        sug.format(hint);
+    }
+
+}
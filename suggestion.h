@@ -0,0 +1,117 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef easycmd_suggestion_h
+#define easycmd_suggestion_h
+
+#include <string>
+#include <stdint.h>
+#include <stddef.h>
+
+namespace easycmd {
+
+    namespace internal {
+
+        /*********************************************************************************
+         * Bounded edit distance
+         * Levenshtein distance of pattern and text computed with Myers' bit-parallel
+         * algorithm, one machine word holds a whole column. peq is the match table of
+         * the pattern built by build_peq, the pattern can't be longer than 64. Return 
+         * max_dist + 1 as soon as the distance is known to be larger than max_dist.
+         ********************************************************************************/
+        void build_peq(const char *pattern, size_t len, uint64_t peq[256]);
+        size_t edit_distance(const uint64_t peq[256], 
+                             size_t pattern_len, 
+                             const char *text, 
+                             size_t text_len,
+                             size_t max_dist);
+
+        /*********************************************************************************
+         * Suggestion
+         * Keeps the names closest to a mistyped word. Names whose length differs from
+         * the word by more than the max distance are skipped before any distance is
+         * computed, so the cost of a candidate is one length compare or one pass over
+         * its characters.
+         ********************************************************************************/
+        class suggestion
+        {
+        public:
+            /*********************************************************************************
+             * Max suggestions
+             ********************************************************************************/
+            enum { MAX_SUGGESTIONS = 3 };
+
+            /*********************************************************************************
+             * Constructor
+             * The max distance grows with the word, a word longer than 64 gets no 
+             * suggestion.
+             ********************************************************************************/
+            suggestion(const char *word, size_t len);
+
+            /*********************************************************************************
+             * Add candidate
+             * The prefix is shown before the name, such as "--" of long options. Both 
+             * strings must stay alive while the suggestion is used.
+             ********************************************************************************/
+            void add(const char *prefix, const char *name);
+
+            /*********************************************************************************
+             * Get suggestion count
+             ********************************************************************************/
+            size_t size() const {
+                return cnt_;
+            }
+
+            /*********************************************************************************
+             * Format suggestions
+             * Appends "did you mean: a, b\n" if there is any suggestion.
+             ********************************************************************************/
+            void format(std::string &des) const;
+
+        private:
+            /*********************************************************************************
+             * Candidate
+             ********************************************************************************/
+            struct candidate {
+                const char *prefix;
+                const char *name;
+                size_t dist;
+            };
+
+        private:
+            // Match table of the word
+            uint64_t peq_[256];
+            size_t len_;
+            size_t max_dist_;
+
+            // Best candidates ordered by distance
+            candidate best_[MAX_SUGGESTIONS];
+            size_t cnt_;
+        };
+
+    }
+
+}
+
+#endif
@@ -0,0 +1,191 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "unit.h"
+
+#include <easycmd/async.h>
+
+#include <signal.h>
+#include <string.h>
+#if !defined(WIN32)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+#include <thread>
+#include <chrono>
+
+// Waits on the token until cancelled, returns 0 either way
+static int wait_cancel(const easycmd::command*, const easycmd::parse_result&, const easycmd::cancel_token &token)
+{
+	token.wait_for(5000);
+	return 0;
+}
+
+static int quick(const easycmd::command*, const easycmd::parse_result &res, const easycmd::cancel_token&)
+{
+	return res.get_option("fail")->get_bool() ? 3 : 0;
+}
+
+static void build_app(easycmd::command &app)
+{
+	app.with_name("app");
+	app.create_sub_cmd("wait")->with_action(wait_cancel);
+	app.create_sub_cmd("slow")->with_action(wait_cancel)->with_timeout(20);
+	easycmd::command *q = app.create_sub_cmd("quick")->with_action(quick)->with_timeout(5000);
+	q->create_option_bool("fail", "")->with_default(false);
+}
+
+UNIT_CASE(async_result)
+{
+	easycmd::command app;
+	build_app(app);
+
+	easycmd::parse_result res;
+	easycmd::cancel_token token;
+	const char *ok[] = { "app", "quick" };
+	CHECK(app.run(2, ok, res, token) == 0);
+	CHECK(res.get_error().get_code() == easycmd::ERR_NONE);
+
+	const char *fail[] = { "app", "quick", "--fail" };
+	CHECK(app.run(3, fail, res, token) == 3);
+	CHECK(res.get_error().get_code() == easycmd::ERR_ACTION_FAILED);
+}
+
+UNIT_CASE(async_timeout)
+{
+	easycmd::command app;
+	build_app(app);
+
+	easycmd::parse_result res;
+	easycmd::cancel_token token;
+	const char *argv[] = { "app", "slow" };
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	CHECK(app.run(2, argv, res, token) != 0);
+	CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(2));
+	CHECK(res.get_error().get_code() == easycmd::ERR_TIMEOUT);
+	CHECK(token.get_reason() == easycmd::CANCEL_TIMEOUT);
+}
+
+UNIT_CASE(async_cancel)
+{
+	easycmd::command app;
+	build_app(app);
+
+	easycmd::parse_result res;
+	easycmd::cancel_token token;
+	const char *argv[] = { "app", "wait" };
+	std::future<int> ret = app.run_async(2, argv, res, token);
+	CHECK(ret.wait_for(std::chrono::milliseconds(20)) == std::future_status::timeout);
+	token.cancel();
+	CHECK(ret.wait_for(std::chrono::seconds(2)) == std::future_status::ready);
+	CHECK(ret.get() != 0);
+	CHECK(res.get_error().get_code() == easycmd::ERR_CANCELLED);
+
+	// Only the first reason is kept
+	token.cancel(easycmd::CANCEL_TIMEOUT);
+	CHECK(token.get_reason() == easycmd::CANCEL_USER);
+
+	token.reset();
+	CHECK(!token.is_cancelled());
+	CHECK(!token.wait_for(1));
+}
+
+#if !defined(WIN32)
+static int usr1_count = 0;
+
+static void count_usr1(int)
+{
+	usr1_count++;
+}
+
+static void raise_usr1()
+{
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	raise(SIGUSR1);
+}
+
+UNIT_CASE(async_signal)
+{
+	easycmd::command app;
+	build_app(app);
+
+	struct sigaction prev;
+	struct sigaction act;
+	memset(&act, 0, sizeof(act));
+	act.sa_handler = count_usr1;
+	sigemptyset(&act.sa_mask);
+	CHECK(sigaction(SIGUSR1, &act, &prev) == 0);
+	CHECK(easycmd::cancel_token::cancel_on_signal(SIGUSR1));
+	CHECK(easycmd::cancel_token::cancel_on_signal(SIGUSR1));
+
+	// The handler before is kept while nothing runs
+	struct sigaction cur;
+	sigaction(SIGUSR1, NULL, &cur);
+	CHECK(cur.sa_handler == count_usr1);
+	raise(SIGUSR1);
+	CHECK(usr1_count == 1);
+
+	easycmd::parse_result res;
+	easycmd::cancel_token token;
+	const char *argv[] = { "app", "wait" };
+	std::thread sender(raise_usr1);
+	CHECK(app.run(2, argv, res, token) != 0);
+	sender.join();
+	CHECK(res.get_error().get_code() == easycmd::ERR_SIGNAL);
+	CHECK(token.get_reason() == easycmd::CANCEL_SIGNAL);
+	CHECK(usr1_count == 1);
+
+	// Restored after the run
+	sigaction(SIGUSR1, NULL, &cur);
+	CHECK(cur.sa_handler == count_usr1);
+	raise(SIGUSR1);
+	CHECK(usr1_count == 2);
+
+	sigaction(SIGUSR1, &prev, NULL);
+}
+
+UNIT_CASE(async_signal_default)
+{
+	pid_t pid = fork();
+	if (pid == 0) {
+		signal(SIGUSR2, SIG_DFL);
+		easycmd::cancel_token::cancel_on_signal(SIGUSR2);
+
+		easycmd::command app;
+		build_app(app);
+		easycmd::parse_result res;
+		easycmd::cancel_token token;
+		const char *argv[] = { "app", "quick" };
+		app.run(2, argv, res, token);
+
+		// Nothing runs, so the default disposition terminates the process
+		raise(SIGUSR2);
+		_exit(0);
+	}
+
+	int status = 0;
+	CHECK(pid > 0 && waitpid(pid, &status, 0) == pid);
+	CHECK(WIFSIGNALED(status) && WTERMSIG(status) == SIGUSR2);
+}
+#endif
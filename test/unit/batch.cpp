@@ -0,0 +1,105 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "unit.h"
+
+#include <easycmd/batch.h>
+
+#include <map>
+#include <stdio.h>
+
+static std::atomic<int> count_sum(0);
+
+static int add_count(const easycmd::command*, const easycmd::parse_result &res)
+{
+	count_sum += res.get_option("count")->get_int();
+	return 0;
+}
+
+static std::map<size_t, easycmd::batch_result> results;
+
+static void on_result(const easycmd::batch_result &res)
+{
+	results[res.line] = res;
+}
+
+static void build_app(easycmd::command &app)
+{
+	app.with_name("app");
+	app.create_sub_cmd("get")->with_action(add_count)->create_option_int("count", "c")->with_default(1);
+}
+
+UNIT_CASE(batch_lines)
+{
+	easycmd::command app;
+	build_app(app);
+
+	FILE *input = tmpfile();
+	CHECK(input != NULL);
+	if (input == NULL) {
+		return;
+	}
+	fputs(
+		"get --count 2\n"
+		"\n"
+		"# comment\n"
+		"get --count x\n"
+		"get 'unterminated\n"
+		"unknown\n"
+		"get -c \"5\"", input);
+
+	int workers[] = { 1, 4 };
+	for (int w = 0; w < 2; w++) {
+		rewind(input);
+		results.clear();
+		count_sum = 0;
+
+		easycmd::batch_stats stats;
+		CHECK(app.run_batch(input, workers[w], on_result, &stats) != 0);
+		CHECK(stats.lines == 5);
+		CHECK(stats.failed == 3);
+		CHECK(stats.seconds >= 0);
+		CHECK(count_sum == 7);
+
+		CHECK(results.size() == 5);
+		CHECK(results[1].ret == 0);
+		CHECK(results[4].code == easycmd::ERR_INVALID_VALUE);
+		CHECK(unit_contains(results[4].err, "--count"));
+		CHECK(results[5].code == easycmd::ERR_UNTERMINATED_QUOTE);
+		CHECK(results[6].code == easycmd::ERR_UNKNOWN_COMMAND);
+		CHECK(results[7].ret == 0);
+	}
+	fclose(input);
+
+	// All lines succeeded
+	CHECK(unit_write_file("unit_batch.txt", "get\nget -c 3\n"));
+	easycmd::batch_stats stats;
+	count_sum = 0;
+	CHECK(app.run_batch("unit_batch.txt", 2, NULL, &stats) == 0);
+	CHECK(stats.lines == 2 && stats.failed == 0);
+	CHECK(count_sum == 4);
+	remove("unit_batch.txt");
+
+	CHECK(app.run_batch("unit_missing.txt", 1, NULL, NULL) != 0);
+}
@@ -0,0 +1,172 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "unit.h"
+
+#include <stdio.h>
+
+static int noop(const easycmd::command*)
+{
+	return 0;
+}
+
+static std::vector<std::string> modes()
+{
+	std::vector<std::string> v;
+	v.push_back("fast");
+	v.push_back("safe");
+	v.push_back("audit");
+	return v;
+}
+
+static void build_app(easycmd::command &app)
+{
+	app.with_name("app")->with_action(noop);
+	app.create_option_choice("mode", "m", modes())->with_env("UNIT_MODE")->with_default("safe")->with_desc("Run mode");
+	app.create_option_choice("level", "", modes())->with_default(2);
+}
+
+static int find(const easycmd::internal::choice_table &t, const char *value)
+{
+	return t.find(value, strlen(value));
+}
+
+UNIT_CASE(choice_table)
+{
+	easycmd::arena a;
+	const char *values[] = { "fast", "safe", "audit", "fast" };
+	easycmd::internal::choice_table t;
+	CHECK(find(t, "fast") == -1);
+	t.build(&a, values, 4);
+
+	// A repeated value keeps the id of its first one
+	CHECK(find(t, "fast") == 0);
+	CHECK(find(t, "safe") == 1);
+	CHECK(find(t, "audit") == 2);
+	CHECK_STR(t.get(2), "audit");
+	CHECK_STR(t.get(9), "");
+	CHECK_STR(t.get(-1), "");
+
+	CHECK(find(t, "") == -1);
+	CHECK(find(t, "fas") == -1);
+	CHECK(find(t, "fastt") == -1);
+	CHECK(find(t, "FAST") == -1);
+	CHECK(find(t, "audi") == -1);
+
+	// Every value of a large set is found, nothing else is
+	std::vector<std::string> many;
+	for (int i = 0; i < 300; i++) {
+		char buf[16];
+		snprintf(buf, sizeof(buf), "v%d", i);
+		many.push_back(buf);
+	}
+	std::vector<const char*> ptrs;
+	for (size_t i = 0; i < many.size(); i++) {
+		ptrs.push_back(many[i].c_str());
+	}
+	easycmd::internal::choice_table big;
+	big.build(&a, &ptrs[0], ptrs.size());
+	int found = 0;
+	for (size_t i = 0; i < many.size(); i++) {
+		found += find(big, many[i].c_str()) == (int)i;
+	}
+	CHECK(found == 300);
+	CHECK(find(big, "v300") == -1);
+	CHECK(find(big, "v-1") == -1);
+	CHECK(find(big, "v01") == -1);
+}
+
+UNIT_CASE(choice_values)
+{
+	easycmd::command app;
+	build_app(app);
+
+	easycmd::parse_result res;
+	const char *plain[] = { "app" };
+	CHECK(unit_run(app, plain, res) == 0);
+	CHECK(res.get_option("mode")->get_int() == 1);
+	CHECK(res.get_option("level")->get_int() == 2);
+
+	const char *shorts[] = { "app", "-m", "audit" };
+	CHECK(unit_run(app, shorts, res) == 0);
+	CHECK(res.get_option("mode")->get_int() == 2);
+	CHECK(res.get_option("mode")->get_source() == easycmd::SOURCE_ARGS);
+
+	const char *attached[] = { "app", "--mode=fast" };
+	CHECK(unit_run(app, attached, res) == 0);
+	CHECK(res.get_option("mode")->get_int() == 0);
+
+	const char *env[] = { "UNIT_MODE=audit", NULL };
+	res.set_env(env);
+	CHECK(unit_run(app, plain, res) == 0);
+	CHECK(res.get_option("mode")->get_int() == 2);
+	CHECK(res.get_option("mode")->get_source() == easycmd::SOURCE_ENV);
+	res.set_env(NULL);
+
+	std::string usage;
+	app.get_usage(usage);
+	CHECK(unit_contains(usage, "Run mode (fast|safe|audit)"));
+}
+
+UNIT_CASE(choice_rejected)
+{
+	easycmd::command app;
+	build_app(app);
+
+	easycmd::parse_result res;
+	const char *slow[] = { "app", "--mode", "slow" };
+	CHECK(unit_run(app, slow, res) != 0);
+	CHECK(res.get_error().get_code() == easycmd::ERR_INVALID_VALUE);
+	CHECK(unit_contains(res.get_err(), "accepted values: fast, safe, audit"));
+
+	const char *upper[] = { "app", "-m", "SAFE" };
+	CHECK(unit_run(app, upper, res) != 0);
+	CHECK(res.get_error().get_code() == easycmd::ERR_INVALID_VALUE);
+
+	const char *empty[] = { "app", "--mode=" };
+	CHECK(unit_run(app, empty, res) != 0);
+
+	// A rejected env value leaves the default
+	const char *env[] = { "UNIT_MODE=fas", NULL };
+	res.set_env(env);
+	const char *plain[] = { "app" };
+	CHECK(unit_run(app, plain, res) == 0);
+	CHECK(res.get_option("mode")->get_int() == 1);
+	CHECK(res.get_option("mode")->get_source() == easycmd::SOURCE_DEFAULT);
+	res.set_env(NULL);
+
+	CHECK(unit_write_file("unit_choice.ini", "mode = slow\n"));
+	CHECK(app.load_config_file("unit_choice.ini") == 0);
+	CHECK(unit_run(app, plain, res) != 0);
+	CHECK(res.get_error().get_code() == easycmd::ERR_CONFIG_INVALID);
+	remove("unit_choice.ini");
+
+	// An unknown default is not taken, so the option stays required
+	easycmd::command strict;
+	strict.with_name("strict")->with_action(noop);
+	strict.create_option_choice("mode", "", modes())->with_default("slow");
+	const char *none[] = { "strict" };
+	CHECK(unit_run(strict, none, res) != 0);
+	CHECK(res.get_error().get_code() == easycmd::ERR_OPTION_REQUIRED);
+}
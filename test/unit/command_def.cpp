@@ -0,0 +1,169 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "unit.h"
+
+#include <easycmd/memory_report.h>
+
+#include <thread>
+
+static int noop(const easycmd::command*)
+{
+	return 0;
+}
+
+static const char *const modes[] = { "fast", "safe" };
+
+static const easycmd::option_def migrate_opts[] = {
+	easycmd::def_option_int("steps", "s").with_default(1).with_desc("Steps to apply"),
+	easycmd::def_option_string("target", "")
+};
+static const easycmd::command_def migrate_def = 
+	easycmd::def_command("migrate").with_desc("Migrate").with_action(noop).with_options(migrate_opts);
+
+static const easycmd::command_def *const db_subs[] = { &migrate_def };
+static const easycmd::option_def db_opts[] = {
+	easycmd::def_option_string("url", "u").with_default("local").with_env("UNIT_DEF_URL"),
+	easycmd::def_option_bool("dry", "").with_default(true),
+	easycmd::def_option_float("ratio", "").with_default(0.25),
+	easycmd::def_option_choice("mode", "m", modes).with_default("safe")
+};
+static const easycmd::command_def db_def = 
+	easycmd::def_command("db").with_desc("Database").with_action(noop).with_options(db_opts).with_sub_cmds(db_subs);
+
+static const easycmd::command_def help_def = easycmd::def_command("help").with_action(noop);
+static const easycmd::command_def *const app_subs[] = { &db_def };
+static const easycmd::command_def *const app_publics[] = { &help_def };
+static const easycmd::option_def app_opts[] = {
+	easycmd::def_option_int("level", "l").with_default(2)
+};
+static const easycmd::command_def app_def = 
+	easycmd::def_command("app")
+		.with_desc("Defined app")
+		.with_action(noop)
+		.with_options(app_opts)
+		.with_sub_cmds(app_subs)
+		.with_public_sub_cmds(app_publics);
+
+static size_t materialized(const easycmd::command &app)
+{
+	easycmd::memory_report rep;
+	app.get_memory_report(rep);
+	return rep.commands;
+}
+
+UNIT_CASE(def_dispatch)
+{
+	easycmd::command app(&app_def);
+	CHECK(materialized(app) == 1);
+
+	easycmd::parse_result res;
+	const char *root[] = { "app" };
+	CHECK(unit_run(app, root, res) == 0);
+	CHECK(res.get_option("level")->get_int() == 2);
+	CHECK(materialized(app) == 1);
+
+	// Defaults of a def sub command
+	const char *db[] = { "app", "db" };
+	CHECK(unit_run(app, db, res) == 0);
+	CHECK(res.get_cmd()->get_parent_cmd() == &app);
+	CHECK_STR(res.get_option("url")->get_string(), "local");
+	CHECK(res.get_option("dry")->get_bool());
+	CHECK(res.get_option("ratio")->get_float() == 0.25);
+	CHECK(res.get_option("mode")->get_int() == 1);
+	CHECK(materialized(app) == 2);
+
+	const char *env[] = { "UNIT_DEF_URL=pg", NULL };
+	res.set_env(env);
+	const char *args[] = { "app", "db", "-m", "fast", "--dry=false" };
+	CHECK(unit_run(app, args, res) == 0);
+	CHECK_STR(res.get_option("url")->get_string(), "pg");
+	CHECK(!res.get_option("dry")->get_bool());
+	CHECK(res.get_option("mode")->get_int() == 0);
+	res.set_env(NULL);
+
+	// Public sub commands are found below
+	const char *help[] = { "app", "db", "help" };
+	CHECK(unit_run(app, help, res) == 0);
+	CHECK(res.get_cmd()->get_parent_cmd() == &app);
+	CHECK(res.get_option("url") == NULL);
+
+	std::string usage;
+	app.get_usage(usage);
+	CHECK(unit_contains(usage, "Database"));
+}
+
+UNIT_CASE(def_errors)
+{
+	easycmd::command app(&app_def);
+
+	easycmd::parse_result res;
+	const char *missing[] = { "app", "db", "migrate" };
+	CHECK(unit_run(app, missing, res) != 0);
+	CHECK(res.get_error().get_code() == easycmd::ERR_OPTION_REQUIRED);
+	CHECK(unit_contains(res.get_err(), "target"));
+
+	const char *ok[] = { "app", "db", "migrate", "--target", "v2", "-s", "3" };
+	CHECK(unit_run(app, ok, res) == 0);
+	CHECK(res.get_option("steps")->get_int() == 3);
+
+	const char *bad[] = { "app", "db", "-m", "slow" };
+	CHECK(unit_run(app, bad, res) != 0);
+	CHECK(res.get_error().get_code() == easycmd::ERR_INVALID_VALUE);
+
+	const char *unknown[] = { "app", "nope" };
+	CHECK(unit_run(app, unknown, res) != 0);
+	CHECK(res.get_error().get_code() == easycmd::ERR_UNKNOWN_COMMAND);
+}
+
+UNIT_CASE(def_created_once)
+{
+	easycmd::command app(&app_def);
+
+	std::atomic<const easycmd::command*> first(NULL);
+	std::atomic<int> failed(0);
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 8; t++) {
+		threads.push_back(std::thread([&app, &first, &failed]() {
+			easycmd::parse_result res;
+			const char *argv[] = { "app", "db", "migrate", "--target", "x" };
+			for (int i = 0; i < 50; i++) {
+				if (((const easycmd::command&)app).run(5, argv, res) != 0) {
+					failed++;
+					continue;
+				}
+				const easycmd::command *expected = NULL;
+				if (!first.compare_exchange_strong(expected, res.get_cmd()) && expected != res.get_cmd()) {
+					failed++;
+				}
+			}
+		}));
+	}
+	for (size_t t = 0; t < threads.size(); t++) {
+		threads[t].join();
+	}
+
+	CHECK(failed == 0);
+	CHECK(materialized(app) == 3);
+}
@@ -0,0 +1,199 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "unit.h"
+
+#include <easycmd/memory_report.h>
+
+#if !defined(WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static int noop(const easycmd::command*)
+{
+	return 0;
+}
+
+static void build_app(easycmd::command &app)
+{
+	app.with_name("app")->with_action(noop);
+	app.create_option_int("count", "c")->with_default(1);
+	app.create_option_bool("color", "")->with_default(false);
+
+	easycmd::command *start = app.create_sub_cmd("start");
+	start->with_action(noop);
+	start->create_option_int("port", "p")->with_default(80);
+	app.create_sub_cmd("stop")->with_action(noop);
+	app.create_public_sub_cmd("help")->with_action(noop);
+}
+
+static std::string complete(const easycmd::command &app, const char *w1, const char *w2 = NULL, size_t limit = 0)
+{
+	std::vector<const char*> argv;
+	argv.push_back("app");
+	argv.push_back(w1);
+	if (w2) {
+		argv.push_back(w2);
+	}
+
+	std::vector<const char*> candidates;
+	size_t n = app.complete((int)argv.size(), &argv[0], candidates, limit);
+
+	std::string out;
+	for (size_t i = 0; i < candidates.size(); i++) {
+		out.append(i > 0 ? " " : "").append(candidates[i]);
+	}
+	return n == candidates.size() ? out : "count mismatch";
+}
+
+UNIT_CASE(completion_candidates)
+{
+	easycmd::command app;
+	build_app(app);
+
+	CHECK_STR(complete(app, ""), "--color --count -c help start stop");
+	CHECK_STR(complete(app, "st"), "start stop");
+	CHECK_STR(complete(app, "--c"), "--color --count");
+	CHECK_STR(complete(app, "x"), "");
+	CHECK_STR(complete(app, "", NULL, 2), "--color --count");
+
+	// Options of the dispatched command and public sub commands of the path
+	CHECK_STR(complete(app, "start", ""), "--port -p help");
+	CHECK_STR(complete(app, "start", "--"), "--port");
+
+	// No candidate at the position of an option value
+	CHECK_STR(complete(app, "--count", ""), "");
+}
+
+UNIT_CASE(completion_rebuilt_after_add)
+{
+	easycmd::command app;
+	build_app(app);
+
+	CHECK_STR(complete(app, "sta"), "start");
+	app.create_sub_cmd("status")->with_action(noop);
+	CHECK_STR(complete(app, "sta"), "start status");
+}
+
+UNIT_CASE(completion_rebuilt_in_place)
+{
+	easycmd::command app;
+	build_app(app);
+	easycmd::command *stop = app.create_sub_cmd("stop")->with_action(noop);
+
+	// Adding sub commands again and again doesn't take more of the arena
+	easycmd::memory_report first;
+	for (int i = 0; i < 100; i++) {
+		app.add_sub_cmd(stop);
+		CHECK_STR(complete(app, "st"), "start stop");
+		if (i == 0) {
+			app.get_memory_report(first);
+		}
+	}
+	easycmd::memory_report last;
+	app.get_memory_report(last);
+	CHECK(last.arena_used == first.arena_used);
+
+	app.create_option_int("depth", "d")->with_default(0);
+	CHECK_STR(complete(app, "-"), "--color --count --depth -c -d");
+}
+
+UNIT_CASE(completion_script)
+{
+	easycmd::command app;
+	build_app(app);
+
+	std::string script;
+	CHECK(app.get_completion_script("bash", script));
+	CHECK(unit_contains(script, "__complete"));
+	script.clear();
+	CHECK(app.get_completion_script("zsh", script));
+	script.clear();
+	CHECK(app.get_completion_script("fish", script));
+	CHECK(!app.get_completion_script("tcsh", script));
+}
+
+UNIT_CASE(completion_not_intercepted)
+{
+	easycmd::command app;
+	build_app(app);
+
+	// Runs with a parse result and runs without completion enabled treat 
+	// __complete as any other arg
+	easycmd::parse_result res;
+	const char *argv[] = { "app", "__complete", "st" };
+	CHECK(unit_run(app, argv, res) != 0);
+	CHECK(res.get_error().get_code() == easycmd::ERR_UNKNOWN_OPTION);
+
+	CHECK(app.run(3, argv) != 0);
+	CHECK(app.get_error().get_code() == easycmd::ERR_UNKNOWN_OPTION);
+
+	app.with_completion(true);
+	CHECK(unit_run(app, argv, res) != 0);
+	CHECK(res.get_error().get_code() == easycmd::ERR_UNKNOWN_OPTION);
+
+	// An operand may be __complete
+	easycmd::command echo;
+	echo.with_name("echo")->with_action(noop);
+	echo.create_positional_tail("words");
+	const char *words[] = { "echo", "__complete", "x" };
+	CHECK(unit_run(echo, words, res) == 0);
+	CHECK(res.get_operands().size() == 2);
+	CHECK(echo.run(3, words) == 0);
+}
+
+#if !defined(WIN32)
+UNIT_CASE(completion_printed_by_run)
+{
+	easycmd::command app;
+	build_app(app);
+	app.with_completion(true);
+
+	const char *path = "unit_completion.out";
+	fflush(stdout);
+	int saved = dup(STDOUT_FILENO);
+	int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	dup2(fd, STDOUT_FILENO);
+	close(fd);
+
+	const char *argv[] = { "app", "__complete", "st" };
+	int ret = app.run(3, argv);
+
+	fflush(stdout);
+	dup2(saved, STDOUT_FILENO);
+	close(saved);
+
+	char buf[64] = { 0 };
+	FILE *f = fopen(path, "r");
+	size_t n = f ? fread(buf, 1, sizeof(buf) - 1, f) : 0;
+	if (f) {
+		fclose(f);
+	}
+	remove(path);
+
+	CHECK(ret == 0);
+	CHECK_STR(std::string(buf, n), "start\nstop\n");
+}
+#endif
@@ -0,0 +1,152 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "unit.h"
+
+static int noop(const easycmd::command*)
+{
+	return 0;
+}
+
+static void build_app(easycmd::command &app)
+{
+	app.with_name("app")->with_action(noop);
+	app.create_option_int("level", "l")->with_env("UNIT_LEVEL")->with_default(1);
+	app.create_option_string("name", "")->with_default("default");
+
+	easycmd::command *serve = app.create_sub_cmd("serve");
+	serve->with_action(noop);
+	serve->create_option_int("port", "p")->with_default(80);
+	serve->create_option_string("host", "")->with_default("localhost");
+	serve->create_sub_cmd("tls")->with_action(noop)->create_option_bool("strict", "")->with_default(false);
+}
+
+UNIT_CASE(config_sections)
+{
+	CHECK(unit_write_file("unit_app.ini", 
+		"# keys before any section are of the root command\n"
+		"level = 2\n"
+		"unknown = ignored\n"
+		"\n"
+		"[serve]\n"
+		"port = 8080\n"
+		"host = \"example.org\"\n"
+		"[serve.tls]\n"
+		"strict = true\n"));
+
+	easycmd::command app;
+	build_app(app);
+	CHECK(app.load_config_file("unit_app.ini") == 0);
+
+	easycmd::parse_result res;
+	const char *root[] = { "app" };
+	CHECK(unit_run(app, root, res) == 0);
+	CHECK(res.get_option("level")->get_int() == 2);
+	CHECK(res.get_option("level")->get_source() == easycmd::SOURCE_CONFIG);
+	CHECK_STR(res.get_option("name")->get_string(), "default");
+	CHECK(res.get_option("name")->get_source() == easycmd::SOURCE_DEFAULT);
+
+	const char *serve[] = { "app", "serve" };
+	CHECK(unit_run(app, serve, res) == 0);
+	CHECK(res.get_option("port")->get_int() == 8080);
+	CHECK_STR(res.get_option("host")->get_string(), "example.org");
+
+	const char *tls[] = { "app", "serve", "tls" };
+	CHECK(unit_run(app, tls, res) == 0);
+	CHECK(res.get_option("strict")->get_bool());
+
+	remove("unit_app.ini");
+}
+
+UNIT_CASE(config_precedence)
+{
+	CHECK(unit_write_file("unit_prec.ini", "level = 2\nname = config\n"));
+
+	easycmd::command app;
+	build_app(app);
+	CHECK(app.load_config_file("unit_prec.ini") == 0);
+
+	// default < config < env < args
+	const char *env[] = { "UNIT_LEVEL=3", NULL };
+	easycmd::parse_result res;
+	res.set_env(env);
+
+	const char *plain[] = { "app" };
+	CHECK(unit_run(app, plain, res) == 0);
+	CHECK(res.get_option("level")->get_int() == 3);
+	CHECK(res.get_option("level")->get_source() == easycmd::SOURCE_ENV);
+	CHECK_STR(res.get_option("name")->get_string(), "config");
+
+	const char *args[] = { "app", "--level", "4", "--name", "args" };
+	CHECK(unit_run(app, args, res) == 0);
+	CHECK(res.get_option("level")->get_int() == 4);
+	CHECK(res.get_option("level")->get_source() == easycmd::SOURCE_ARGS);
+	CHECK_STR(res.get_option("name")->get_string(), "args");
+
+	res.set_env(NULL);
+	remove("unit_prec.ini");
+}
+
+UNIT_CASE(config_errors)
+{
+	easycmd::command app;
+	build_app(app);
+	CHECK(app.load_config_file("unit_missing.ini") != 0);
+
+	CHECK(unit_write_file("unit_header.ini", "[serve\nport = 1\n"));
+	CHECK(app.load_config_file("unit_header.ini") != 0);
+	remove("unit_header.ini");
+
+	CHECK(unit_write_file("unit_bad.ini", 
+		"level = 1\n"
+		"[serve]\n"
+		"port = eighty\n"));
+	CHECK(app.load_config_file("unit_bad.ini") == 0);
+
+	// Only the section of the dispatched command is parsed
+	easycmd::parse_result res;
+	const char *root[] = { "app" };
+	CHECK(unit_run(app, root, res) == 0);
+
+	const char *serve[] = { "app", "serve" };
+	CHECK(unit_run(app, serve, res) != 0);
+	CHECK(res.get_error().get_code() == easycmd::ERR_CONFIG_INVALID);
+	CHECK(res.get_error().get_line() == 3);
+	CHECK(unit_contains(res.get_err(), "invalid value of port at line 3 of config file unit_bad.ini"));
+
+	CHECK(unit_write_file("unit_range.ini", "level = 99999999999\n"));
+	CHECK(app.load_config_file("unit_range.ini") == 0);
+	CHECK(unit_run(app, root, res) != 0);
+	CHECK(res.get_error().get_code() == easycmd::ERR_CONFIG_OUT_OF_RANGE);
+
+	CHECK(unit_write_file("unit_line.ini", "level\n"));
+	CHECK(app.load_config_file("unit_line.ini") == 0);
+	CHECK(unit_run(app, root, res) != 0);
+	CHECK(res.get_error().get_code() == easycmd::ERR_CONFIG_FILE);
+	CHECK(unit_contains(res.get_err(), "invalid line 1"));
+
+	remove("unit_bad.ini");
+	remove("unit_range.ini");
+	remove("unit_line.ini");
+}
@@ -0,0 +1,97 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "unit.h"
+
+#include <easycmd/async.h>
+#include <easycmd/daemon.h>
+
+#include <string.h>
+#if !defined(WIN32)
+#include <unistd.h>
+#endif
+#include <thread>
+#include <chrono>
+
+#if !defined(WIN32)
+static std::string read_line;
+
+// Reads one line of stdin, the rest of the input stays in the buffer of stdin
+static int read_one(const easycmd::command*)
+{
+	char buf[64] = { 0 };
+	read_line = fgets(buf, sizeof(buf), stdin) ? buf : "";
+	return 0;
+}
+
+// Forwards args to the daemon with input as stdin
+static bool forward(const char *path, const char *input, int &ret)
+{
+	int fds[2];
+	if (pipe(fds) != 0) {
+		return false;
+	}
+	bool ok = write(fds[1], input, strlen(input)) == (ssize_t)strlen(input);
+	close(fds[1]);
+
+	int saved = dup(STDIN_FILENO);
+	dup2(fds[0], STDIN_FILENO);
+	close(fds[0]);
+	const char *argv[] = { "app", "read" };
+	ok = ok && easycmd::forward_to_daemon(path, 2, argv, ret);
+	dup2(saved, STDIN_FILENO);
+	close(saved);
+	return ok;
+}
+
+UNIT_CASE(daemon_stdin_not_shared)
+{
+	easycmd::command app;
+	app.with_name("app");
+	app.create_sub_cmd("read")->with_action(read_one);
+
+	const char *path = "unit_daemon.sock";
+	easycmd::cancel_token token;
+	std::thread server([&app, &token, path]() {
+		std::string err;
+		app.serve(path, token, err);
+	});
+
+	// Wait for the daemon to listen
+	int ret = -1;
+	bool ok = false;
+	for (int i = 0; i < 100 && !(ok = forward(path, "first\nleft\n", ret)); i++) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	CHECK(ok && ret == 0);
+	CHECK_STR(read_line, "first\n");
+
+	// Input the first client didn't read isn't seen by the second one
+	CHECK(forward(path, "second\n", ret) && ret == 0);
+	CHECK_STR(read_line, "second\n");
+
+	token.cancel();
+	server.join();
+}
+#endif
@@ -0,0 +1,135 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "unit.h"
+
+#include <easycmd/env_index.h>
+
+static int noop(const easycmd::command*)
+{
+	return 0;
+}
+
+UNIT_CASE(env_index_lookup)
+{
+	const char *env[] = { "A=1", "PATH=/bin", "A=2", "EMPTY=", "NOEQUALS", "B_C=x=y", NULL };
+	easycmd::internal::env_index idx;
+	CHECK(!idx.is_built());
+	idx.build(env);
+	CHECK(idx.is_built());
+
+	// The first of duplicated names is used, like getenv
+	CHECK_STR(idx.find("A", 1), "1");
+	CHECK_STR(idx.find("PATH", 4), "/bin");
+	CHECK_STR(idx.find("EMPTY", 5), "");
+	CHECK_STR(idx.find("B_C", 3), "x=y");
+	CHECK(idx.find("B", 1) == NULL);
+	CHECK(idx.find("NOEQUALS", 8) == NULL);
+	CHECK(idx.find("PAT", 3) == NULL);
+
+	// Many names grow the table
+	std::vector<std::string> names;
+	std::vector<const char*> many;
+	for (int i = 0; i < 1000; i++) {
+		char buf[32];
+		snprintf(buf, sizeof(buf), "VAR_%d=%d", i, i * 2);
+		names.push_back(buf);
+	}
+	for (size_t i = 0; i < names.size(); i++) {
+		many.push_back(names[i].c_str());
+	}
+	many.push_back(NULL);
+	idx.build(&many[0]);
+	CHECK(idx.size() == 1000);
+	CHECK_STR(idx.find("VAR_0", 5), "0");
+	CHECK_STR(idx.find("VAR_999", 7), "1998");
+	CHECK(idx.find("A", 1) == NULL);
+}
+
+UNIT_CASE(env_bound_options)
+{
+	easycmd::command app;
+	app.with_name("app")->with_action(noop)->with_env_prefix("UNIT_");
+	app.create_option_int("max-count", "")->with_default(1);
+	app.create_option_string("name", "")->with_env("UNIT_OWN_NAME")->with_default("none");
+	app.create_option_int("port", "")->with_default(80);
+
+	easycmd::command *sub = app.create_sub_cmd("sub");
+	sub->with_action(noop)->with_env_prefix("SUB_");
+	sub->create_option_int("max-count", "")->with_default(1);
+	easycmd::command *leaf = sub->create_sub_cmd("leaf");
+	leaf->with_action(noop);
+	leaf->create_option_int("max-count", "")->with_default(1);
+
+	const char *env[] = { 
+		"UNIT_MAX_COUNT=5", 
+		"UNIT_OWN_NAME=env", 
+		"UNIT_NAME=ignored", 
+		"UNIT_PORT=", 
+		"SUB_MAX_COUNT=7", 
+		NULL 
+	};
+	easycmd::parse_result res;
+	res.set_env(env);
+
+	const char *root[] = { "app" };
+	CHECK(unit_run(app, root, res) == 0);
+	CHECK(res.get_option("max-count")->get_int() == 5);
+	CHECK(res.get_option("max-count")->get_source() == easycmd::SOURCE_ENV);
+	// An explicit env is used instead of the prefix
+	CHECK_STR(res.get_option("name")->get_string(), "env");
+	// Empty values are not used
+	CHECK(res.get_option("port")->get_int() == 80);
+	CHECK(res.get_option("port")->get_source() == easycmd::SOURCE_DEFAULT);
+
+	// The nearest prefix on the path is used
+	const char *sub_args[] = { "app", "sub" };
+	CHECK(unit_run(app, sub_args, res) == 0);
+	CHECK(res.get_option("max-count")->get_int() == 7);
+	const char *leaf_args[] = { "app", "sub", "leaf" };
+	CHECK(unit_run(app, leaf_args, res) == 0);
+	CHECK(res.get_option("max-count")->get_int() == 7);
+
+	// Args override env
+	const char *args[] = { "app", "--max-count", "9" };
+	CHECK(unit_run(app, args, res) == 0);
+	CHECK(res.get_option("max-count")->get_int() == 9);
+	CHECK(res.get_option("max-count")->get_source() == easycmd::SOURCE_ARGS);
+}
+
+UNIT_CASE(env_invalid_value_ignored)
+{
+	easycmd::command app;
+	app.with_name("app")->with_action(noop);
+	app.create_option_int("port", "")->with_env("UNIT_PORT")->with_default(80);
+
+	const char *env[] = { "UNIT_PORT=eighty", NULL };
+	easycmd::parse_result res;
+	res.set_env(env);
+
+	const char *root[] = { "app" };
+	CHECK(unit_run(app, root, res) == 0);
+	CHECK(res.get_option("port")->get_int() == 80);
+	CHECK(res.get_option("port")->get_source() == easycmd::SOURCE_DEFAULT);
+}
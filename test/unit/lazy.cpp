@@ -0,0 +1,173 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "unit.h"
+
+#include <thread>
+
+static int noop(const easycmd::command*)
+{
+	return 0;
+}
+
+static std::atomic<int> build_count(0);
+
+static void build_db(easycmd::command *cmd)
+{
+	build_count++;
+	cmd->with_action(noop);
+	cmd->create_option_string("url", "")->with_default("local");
+	cmd->create_sub_cmd("migrate")->with_action(noop);
+}
+
+// Uses the tree while it is built: usage, completion and a sibling factory
+static void build_greedy(easycmd::command *cmd)
+{
+	build_count++;
+	cmd->with_action(noop);
+	cmd->create_option_int("level", "")->with_default(1);
+
+	const easycmd::command *parent = cmd->get_parent_cmd();
+	std::string usage;
+	parent->get_usage(usage);
+	cmd->get_usage(usage);
+
+	std::vector<const char*> candidates;
+	const char *argv[] = { "app", "db", "" };
+	parent->complete(3, argv, candidates);
+
+	easycmd::parse_result res;
+	const char *run_db[] = { "app", "db", "--url", "x" };
+	parent->run(4, run_db, res);
+}
+
+static void build_app(easycmd::command &app)
+{
+	app.with_name("app")->with_action(noop);
+	easycmd::command_factory db("db", "Database", build_db);
+	app.add_sub_cmd(db);
+	easycmd::command_factory greedy("greedy", "Uses the tree", build_greedy);
+	app.add_sub_cmd(greedy);
+	easycmd::command_factory tools("tools", "Public tools", build_db);
+	app.add_public_sub_cmd(tools);
+}
+
+UNIT_CASE(lazy_created_on_dispatch)
+{
+	build_count = 0;
+	easycmd::command app;
+	build_app(app);
+
+	// Usage and runs of other commands don't create them
+	std::string usage;
+	app.get_usage(usage);
+	CHECK(unit_contains(usage, "db"));
+	CHECK(unit_contains(usage, "Database"));
+	easycmd::parse_result res;
+	const char *root[] = { "app" };
+	CHECK(unit_run(app, root, res) == 0);
+	CHECK(build_count == 0);
+
+	const char *db[] = { "app", "db", "--url", "pg" };
+	CHECK(unit_run(app, db, res) == 0);
+	CHECK(build_count == 1);
+	CHECK_STR(res.get_option("url")->get_string(), "pg");
+	const easycmd::command *first = res.get_cmd();
+
+	CHECK(unit_run(app, db, res) == 0);
+	CHECK(build_count == 1);
+	CHECK(res.get_cmd() == first);
+	CHECK(first->get_parent_cmd() == &app);
+
+	const char *sub[] = { "app", "db", "migrate" };
+	CHECK(unit_run(app, sub, res) == 0);
+
+	// A public factory is visible below the command it is added to
+	const char *pub[] = { "app", "db", "tools", "--url", "y" };
+	CHECK(unit_run(app, pub, res) == 0);
+	CHECK(build_count == 2);
+}
+
+UNIT_CASE(lazy_builder_uses_tree)
+{
+	build_count = 0;
+	easycmd::command app;
+	build_app(app);
+
+	easycmd::parse_result res;
+	const char *greedy[] = { "app", "greedy", "--level", "3" };
+	CHECK(unit_run(app, greedy, res) == 0);
+	CHECK(res.get_option("level")->get_int() == 3);
+	// The builder created db while greedy was built
+	CHECK(build_count == 2);
+}
+
+UNIT_CASE(lazy_built_once_by_threads)
+{
+	build_count = 0;
+	easycmd::command app;
+	build_app(app);
+
+	std::vector<std::thread> threads;
+	std::atomic<int> failed(0);
+	for (int t = 0; t < 8; t++) {
+		threads.push_back(std::thread([&app, &failed]() {
+			easycmd::parse_result res;
+			const char *argv[] = { "app", "greedy" };
+			for (int i = 0; i < 20; i++) {
+				if (((const easycmd::command&)app).run(2, argv, res) != 0) {
+					failed++;
+				}
+			}
+		}));
+	}
+	for (size_t t = 0; t < threads.size(); t++) {
+		threads[t].join();
+	}
+
+	CHECK(failed == 0);
+	CHECK(build_count == 2);
+}
+
+UNIT_CASE(lazy_replaced)
+{
+	build_count = 0;
+	easycmd::command app;
+	build_app(app);
+
+	easycmd::parse_result res;
+	const char *db[] = { "app", "db" };
+	CHECK(unit_run(app, db, res) == 0);
+
+	// A created command replaced by another is freed with the tree
+	app.create_sub_cmd("db")->with_desc("Replaced")->with_action(noop);
+	CHECK(unit_run(app, db, res) == 0);
+	CHECK(res.get_option("url") == NULL);
+
+	easycmd::command_factory again("db", "Again", build_db);
+	app.add_sub_cmd(again);
+	CHECK(unit_run(app, db, res) == 0);
+	CHECK(res.get_option("url") != NULL);
+	CHECK(build_count == 2);
+}
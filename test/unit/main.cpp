@@ -0,0 +1,97 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*********************************************************************************
+ * Unit test runner
+ * Runs all cases, or the cases whose names contain the first arg.
+ ********************************************************************************/
+
+#include "unit.h"
+
+#include <vector>
+#include <string.h>
+
+struct unit_entry
+{
+	const char *name;
+	unit_case fn;
+};
+
+static std::vector<unit_entry>& unit_cases()
+{
+	static std::vector<unit_entry> cases;
+	return cases;
+}
+
+static int fail_count = 0;
+
+unit_register::unit_register(const char *name, unit_case fn)
+{
+	unit_entry e = { name, fn };
+	unit_cases().push_back(e);
+}
+
+void unit_fail(const char *file, int line, const char *expr)
+{
+	fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expr);
+	fail_count++;
+}
+
+bool unit_write_file(const char *path, const std::string &content)
+{
+	FILE *f = fopen(path, "wb");
+	if (f == NULL) {
+		return false;
+	}
+	bool ok = fwrite(content.data(), 1, content.size(), f) == content.size();
+	return fclose(f) == 0 && ok;
+}
+
+int main(int argc, const char **argv)
+{
+	const char *only = argc > 1 ? argv[1] : NULL;
+
+	int failed_cases = 0;
+	int cases = 0;
+	for (size_t i = 0; i < unit_cases().size(); i++) {
+		const unit_entry &e = unit_cases()[i];
+		if (only && strstr(e.name, only) == NULL) {
+			continue;
+		}
+
+		int fails = fail_count;
+		e.fn();
+		cases++;
+		if (fail_count != fails) {
+			failed_cases++;
+			printf("[failed] %s\n", e.name);
+		} else {
+			printf("[ok] %s\n", e.name);
+		}
+	}
+
+	printf("%d cases, %d failed\n", cases, failed_cases);
+
+	return failed_cases == 0 ? 0 : 1;
+}
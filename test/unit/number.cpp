@@ -0,0 +1,178 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "unit.h"
+
+#include <math.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+using easycmd::PARSE_OK;
+using easycmd::PARSE_INVALID;
+using easycmd::PARSE_OVERFLOW;
+
+static int noop(const easycmd::command*)
+{
+	return 0;
+}
+
+static easycmd::parse_status int64_of(const char *s, int64_t &v)
+{
+	return easycmd::internal::parse_int64(s, strlen(s), v);
+}
+
+static easycmd::parse_status uint64_of(const char *s, uint64_t &v)
+{
+	return easycmd::internal::parse_uint64(s, strlen(s), v);
+}
+
+static easycmd::parse_status double_of(const char *s, double &v)
+{
+	return easycmd::internal::parse_double(s, strlen(s), v);
+}
+
+UNIT_CASE(number_int64)
+{
+	int64_t v = 0;
+	CHECK(int64_of("0", v) == PARSE_OK && v == 0);
+	CHECK(int64_of("-42", v) == PARSE_OK && v == -42);
+	CHECK(int64_of("+42", v) == PARSE_OK && v == 42);
+	CHECK(int64_of("0010", v) == PARSE_OK && v == 10);
+	CHECK(int64_of("1234567890123", v) == PARSE_OK && v == 1234567890123LL);
+	CHECK(int64_of("0x7fffffffffffffff", v) == PARSE_OK && v == INT64_MAX);
+	CHECK(int64_of("0XfF", v) == PARSE_OK && v == 255);
+	CHECK(int64_of("0o17", v) == PARSE_OK && v == 15);
+	CHECK(int64_of("0b101", v) == PARSE_OK && v == 5);
+	CHECK(int64_of("-0x10", v) == PARSE_OK && v == -16);
+
+	CHECK(int64_of("9223372036854775807", v) == PARSE_OK && v == INT64_MAX);
+	CHECK(int64_of("-9223372036854775808", v) == PARSE_OK && v == INT64_MIN);
+	CHECK(int64_of("9223372036854775808", v) == PARSE_OVERFLOW);
+	CHECK(int64_of("-9223372036854775809", v) == PARSE_OVERFLOW);
+	CHECK(int64_of("99999999999999999999999", v) == PARSE_OVERFLOW);
+	CHECK(int64_of("0x8000000000000000", v) == PARSE_OVERFLOW);
+	CHECK(int64_of("0x10000000000000000", v) == PARSE_OVERFLOW);
+
+	const char *invalid[] = { "", "-", "+", " 1", "1 ", "1x", "0x", "0b2", "0o8", "1.0", "--1", "0xg" };
+	for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+		CHECK(int64_of(invalid[i], v) == PARSE_INVALID);
+	}
+	// Digits past len are not read
+	CHECK(easycmd::internal::parse_int64("123", 2, v) == PARSE_OK && v == 12);
+}
+
+UNIT_CASE(number_int_and_uint64)
+{
+	int i = 0;
+	CHECK(easycmd::internal::parse_int("2147483647", 10, i) == PARSE_OK && i == 2147483647);
+	CHECK(easycmd::internal::parse_int("-2147483648", 11, i) == PARSE_OK && i == -2147483647 - 1);
+	CHECK(easycmd::internal::parse_int("2147483648", 10, i) == PARSE_OVERFLOW);
+	CHECK(easycmd::internal::parse_int("-2147483649", 11, i) == PARSE_OVERFLOW);
+
+	uint64_t u = 0;
+	CHECK(uint64_of("18446744073709551615", u) == PARSE_OK && u == UINT64_MAX);
+	CHECK(uint64_of("0xffffffffffffffff", u) == PARSE_OK && u == UINT64_MAX);
+	CHECK(uint64_of("18446744073709551616", u) == PARSE_OVERFLOW);
+	CHECK(uint64_of("-1", u) == PARSE_INVALID);
+	CHECK(uint64_of("+1", u) == PARSE_OK && u == 1);
+
+	// Every length of decimal digits against strtoull
+	char buf[32];
+	for (int len = 1; len <= 20; len++) {
+		for (int k = 0; k < 50; k++) {
+			for (int j = 0; j < len; j++) {
+				buf[j] = (char)('0' + rand() % 10);
+			}
+			buf[len] = 0;
+			errno = 0;
+			unsigned long long expect = strtoull(buf, NULL, 10);
+			easycmd::parse_status st = uint64_of(buf, u);
+			if (errno == ERANGE) {
+				CHECK(st == PARSE_OVERFLOW);
+			} else {
+				CHECK(st == PARSE_OK && u == expect);
+			}
+		}
+	}
+}
+
+UNIT_CASE(number_double)
+{
+	double d = 0;
+	CHECK(double_of("1.5", d) == PARSE_OK && d == 1.5);
+	CHECK(double_of("-0.25", d) == PARSE_OK && d == -0.25);
+	CHECK(double_of(".5", d) == PARSE_OK && d == 0.5);
+	CHECK(double_of("5.", d) == PARSE_OK && d == 5.0);
+	CHECK(double_of("1e3", d) == PARSE_OK && d == 1000.0);
+	CHECK(double_of("1E-3", d) == PARSE_OK && d == 0.001);
+	CHECK(double_of("0.1", d) == PARSE_OK && d == 0.1);
+	CHECK(double_of("1.7976931348623157e308", d) == PARSE_OK && d == 1.7976931348623157e308);
+	CHECK(double_of("4.9e-324", d) == PARSE_OK && d == 4.9e-324);
+	CHECK(double_of("-0", d) == PARSE_OK && d == 0.0 && signbit(d));
+	CHECK(double_of("inf", d) == PARSE_OK && isinf(d) && d > 0);
+	CHECK(double_of("-Infinity", d) == PARSE_OK && isinf(d) && d < 0);
+	CHECK(double_of("NaN", d) == PARSE_OK && isnan(d));
+
+	CHECK(double_of("1e309", d) == PARSE_OVERFLOW);
+	CHECK(double_of("-1e400", d) == PARSE_OVERFLOW);
+
+	const char *invalid[] = { "", ".", "-", "e5", "1e", "1e+", "1.2.3", "1,5", " 1", "0x10", "infx", "nan(1)" };
+	for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+		CHECK(double_of(invalid[i], d) == PARSE_INVALID);
+	}
+
+	// Random decimals round like strtod
+	char buf[64];
+	for (int k = 0; k < 5000; k++) {
+		snprintf(buf, sizeof(buf), "%d.%de%d", rand() % 100000, rand(), rand() % 600 - 300);
+		double expect = strtod(buf, NULL);
+		if (isinf(expect)) {
+			continue;
+		}
+		CHECK(double_of(buf, d) == PARSE_OK && d == expect);
+	}
+}
+
+UNIT_CASE(number_option_values)
+{
+	easycmd::command app;
+	app.with_name("app")->with_action(noop);
+	app.create_option_int("count", "")->with_default(0);
+	app.create_option_float("ratio", "")->with_default(0.0);
+
+	easycmd::parse_result res;
+	const char *hex[] = { "app", "--count=0x10", "--ratio=2.5e-1" };
+	CHECK(unit_run(app, hex, res) == 0);
+	CHECK(res.get_option("count")->get_int() == 16);
+	CHECK(res.get_option("ratio")->get_float() == 0.25);
+
+	const char *big[] = { "app", "--count=2147483648" };
+	CHECK(unit_run(app, big, res) != 0);
+	CHECK(res.get_error().get_code() == easycmd::ERR_OUT_OF_RANGE);
+
+	const char *huge[] = { "app", "--ratio=1e999" };
+	CHECK(unit_run(app, huge, res) != 0);
+	CHECK(res.get_error().get_code() == easycmd::ERR_OUT_OF_RANGE);
+}
@@ -0,0 +1,163 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "unit.h"
+
+#include <easycmd/option_index.h>
+
+#include <string.h>
+
+static int find_long(const easycmd::internal::option_index &idx, const char *name)
+{
+	return idx.find_long(name, strlen(name));
+}
+
+static int find_short(const easycmd::internal::option_index &idx, const char *name)
+{
+	return idx.find_short(name, strlen(name));
+}
+
+static int find(const easycmd::internal::option_index &idx, const char *name)
+{
+	return idx.find(name, strlen(name));
+}
+
+UNIT_CASE(option_index_lookup)
+{
+	easycmd::internal::option_index idx;
+	idx.add("count", "c", 0);
+	idx.add("color", "", 1);
+	idx.add("verbose", "vv", 2);
+	idx.add("", "x", 3);
+	idx.add("", "\xff", 4);
+
+	CHECK(find_long(idx, "count") == 0);
+	CHECK(find_long(idx, "color") == 1);
+	CHECK(find_long(idx, "verbose") == 2);
+	CHECK(find_short(idx, "c") == 0);
+	CHECK(find_short(idx, "vv") == 2);
+	CHECK(find_short(idx, "x") == 3);
+	CHECK(find_short(idx, "\xff") == 4);
+
+	// Only len chars of the name are compared
+	CHECK(idx.find_long("counts", 5) == 0);
+	CHECK(idx.find_short("vvv", 2) == 2);
+
+	// Not found
+	CHECK(idx.find_long("", 0) == -1);
+	CHECK(idx.find_short("", 0) == -1);
+	CHECK(idx.find("", 0) == -1);
+	CHECK(find_long(idx, "cou") == -1);
+	CHECK(find_long(idx, "counts") == -1);
+	CHECK(find_long(idx, "c") == -1);
+	CHECK(find_long(idx, "x") == -1);
+	CHECK(find_short(idx, "v") == -1);
+	CHECK(find_short(idx, "vvv") == -1);
+	CHECK(find_short(idx, "count") == -1);
+	CHECK(find_short(idx, "z") == -1);
+	CHECK(find(idx, "nothing") == -1);
+}
+
+UNIT_CASE(option_index_clash)
+{
+	// A name used as long name of one option and short name of another is found
+	// as the option created first
+	easycmd::internal::option_index idx;
+	idx.add("all", "b", 0);
+	idx.add("b", "a", 1);
+	idx.add("cc", "", 2);
+	idx.add("", "cc", 3);
+	CHECK(find(idx, "b") == 0);
+	CHECK(find(idx, "a") == 1);
+	CHECK(find(idx, "all") == 0);
+	CHECK(find(idx, "cc") == 2);
+	CHECK(find_long(idx, "b") == 1);
+	CHECK(find_short(idx, "b") == 0);
+	CHECK(find_short(idx, "cc") == 3);
+
+	// A name already in the index keeps its old position
+	idx.add("all", "a", 4);
+	idx.add("", "cc", 5);
+	CHECK(find_long(idx, "all") == 0);
+	CHECK(find_short(idx, "a") == 1);
+	CHECK(find_short(idx, "cc") == 3);
+}
+
+UNIT_CASE(option_index_collisions)
+{
+	// Names with the same FNV-1a hash are told apart by their chars
+	easycmd::internal::option_index idx;
+	idx.add("glbvs", "glbvs", 0);
+	idx.add("yacxa", "yacxa", 1);
+	CHECK(find_long(idx, "glbvs") == 0);
+	CHECK(find_long(idx, "yacxa") == 1);
+	CHECK(find_short(idx, "glbvs") == 0);
+	CHECK(find_short(idx, "yacxa") == 1);
+	CHECK(find_long(idx, "glbvt") == -1);
+
+	// Many names grow the tables and probe past taken slots
+	std::vector<std::string> longs;
+	std::vector<std::string> shorts;
+	for (int i = 0; i < 1000; i++) {
+		char buf[32];
+		snprintf(buf, sizeof(buf), "option-%d", i);
+		longs.push_back(buf);
+		snprintf(buf, sizeof(buf), "o%d", i);
+		shorts.push_back(buf);
+	}
+	for (int i = 0; i < 1000; i++) {
+		idx.add(longs[i].c_str(), shorts[i].c_str(), i + 2);
+	}
+
+	bool all_found = true;
+	for (int i = 0; i < 1000; i++) {
+		all_found = all_found && find_long(idx, longs[i].c_str()) == i + 2;
+		all_found = all_found && find_short(idx, shorts[i].c_str()) == i + 2;
+	}
+	CHECK(all_found);
+	CHECK(find_long(idx, "glbvs") == 0);
+	CHECK(find_short(idx, "yacxa") == 1);
+	CHECK(find_long(idx, "option-1000") == -1);
+	CHECK(find_short(idx, "o1000") == -1);
+	CHECK(find_short(idx, "option-1") == -1);
+}
+
+UNIT_CASE(option_index_clear)
+{
+	easycmd::internal::option_index idx;
+	idx.add("count", "c", 0);
+	idx.add("verbose", "vv", 1);
+	idx.clear();
+	CHECK(find_long(idx, "count") == -1);
+	CHECK(find_short(idx, "c") == -1);
+	CHECK(find_short(idx, "vv") == -1);
+
+	// Names added after clear get their new positions
+	idx.add("verbose", "c", 0);
+	idx.add("count", "vv", 1);
+	CHECK(find_long(idx, "verbose") == 0);
+	CHECK(find_short(idx, "c") == 0);
+	CHECK(find_long(idx, "count") == 1);
+	CHECK(find_short(idx, "vv") == 1);
+}
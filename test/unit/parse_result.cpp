@@ -0,0 +1,180 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "unit.h"
+
+static int noop(const easycmd::command*)
+{
+	return 0;
+}
+
+static int fail(const easycmd::command*)
+{
+	return 3;
+}
+
+static void build_app(easycmd::command &app)
+{
+	app.with_name("app")->with_action(noop);
+	app.create_option_int("count", "c")->with_default(1);
+	app.create_option_string("name", "n")->with_default("none");
+	app.create_option_bool("verbose", "v")->with_default(false);
+	app.create_option_float("ratio", "")->with_default(0.5);
+
+	easycmd::command *start = app.create_sub_cmd("start");
+	start->with_action(noop);
+	start->create_option_int("port", "p");
+	start->create_positional("file")->with_required(true);
+	start->create_positional_tail("rest");
+
+	app.create_sub_cmd("stop")->with_action(fail);
+
+	easycmd::command *get = app.create_sub_cmd("get");
+	get->with_action(noop);
+	get->create_positional("key");
+}
+
+UNIT_CASE(parse_values)
+{
+	easycmd::command app;
+	build_app(app);
+
+	easycmd::parse_result res;
+	const char *argv[] = { "app", "--count", "7", "-n", "x", "-v", "--ratio=2.5" };
+	CHECK(unit_run(app, argv, res) == 0);
+	CHECK(res.get_cmd() == &app);
+	CHECK(res.get_option("count")->get_int() == 7);
+	CHECK(res.get_option("c")->get_source() == easycmd::SOURCE_ARGS);
+	CHECK_STR(res.get_option("name")->get_string(), "x");
+	CHECK(res.get_option("verbose")->get_bool());
+	CHECK(res.get_option("ratio")->get_float() == 2.5);
+	CHECK(res.get_option("missing") == NULL);
+
+	// The tree keeps its defaults
+	CHECK(app.get_option("count")->get_int() == 1);
+	CHECK(app.get_option("count")->get_source() == easycmd::SOURCE_DEFAULT);
+}
+
+UNIT_CASE(parse_results_are_independent)
+{
+	easycmd::command app;
+	build_app(app);
+
+	easycmd::parse_result a;
+	easycmd::parse_result b;
+	const char *argv_a[] = { "app", "-c", "2" };
+	const char *argv_b[] = { "app", "start", "-p", "80", "f1", "f2", "f3" };
+	CHECK(unit_run(app, argv_a, a) == 0);
+	CHECK(unit_run(app, argv_b, b) == 0);
+
+	CHECK(a.get_option("count")->get_int() == 2);
+	CHECK(a.get_path().size() == 1);
+
+	const easycmd::command *start = b.get_cmd();
+	CHECK(start != NULL && start != &app);
+	CHECK(b.get_path().size() == 2 && b.get_path()[0] == &app);
+	CHECK(b.get_parent_cmd(start) == &app);
+	CHECK(b.get_option("port")->get_int() == 80);
+	CHECK(b.get_option("count") == NULL);
+	CHECK_STR(b.get_positional("file"), "f1");
+	CHECK(b.get_operands().size() == 3);
+	CHECK(b.get_operands("rest").size() == 2);
+
+	// Reused for another run
+	const char *argv_c[] = { "app" };
+	CHECK(unit_run(app, argv_c, b) == 0);
+	CHECK(b.get_cmd() == &app);
+	CHECK(b.get_option("count")->get_int() == 1);
+}
+
+UNIT_CASE(parse_errors)
+{
+	easycmd::command app;
+	build_app(app);
+	easycmd::parse_result res;
+
+	const char *unknown_opt[] = { "app", "-c", "1", "--cout", "2" };
+	CHECK(unit_run(app, unknown_opt, res) != 0);
+	CHECK(res.get_error().get_code() == easycmd::ERR_UNKNOWN_OPTION);
+	CHECK(res.get_error().get_token() == 3);
+	CHECK_STR(res.get_error().get_arg(), "--cout");
+	CHECK(unit_contains(res.get_err(), "invalid option: --cout"));
+	CHECK(unit_contains(res.get_err(), "--count"));
+
+	const char *invalid[] = { "app", "--count", "abc" };
+	CHECK(unit_run(app, invalid, res) != 0);
+	CHECK(res.get_error().get_code() == easycmd::ERR_INVALID_VALUE);
+
+	const char *range[] = { "app", "--count", "99999999999" };
+	CHECK(unit_run(app, range, res) != 0);
+	CHECK(res.get_error().get_code() == easycmd::ERR_OUT_OF_RANGE);
+	CHECK(unit_contains(res.get_err(), "out of range"));
+
+	const char *unknown_cmd[] = { "app", "strat" };
+	CHECK(unit_run(app, unknown_cmd, res) != 0);
+	CHECK(res.get_error().get_code() == easycmd::ERR_UNKNOWN_COMMAND);
+	CHECK(unit_contains(res.get_err(), "no found command: strat"));
+	CHECK(unit_contains(res.get_err(), "start"));
+
+	const char *required_opt[] = { "app", "start", "f" };
+	CHECK(unit_run(app, required_opt, res) != 0);
+	CHECK(res.get_error().get_code() == easycmd::ERR_OPTION_REQUIRED);
+	CHECK(res.get_error().get_option() == res.get_cmd()->get_option("port"));
+	CHECK(unit_contains(res.get_err(), "option --port required"));
+
+	const char *required_arg[] = { "app", "start", "-p", "1" };
+	CHECK(unit_run(app, required_arg, res) != 0);
+	CHECK(res.get_error().get_code() == easycmd::ERR_ARGUMENT_REQUIRED);
+	CHECK(unit_contains(res.get_err(), "argument file required"));
+
+	const char *unexpected[] = { "app", "get", "key", "operand" };
+	CHECK(unit_run(app, unexpected, res) != 0);
+	CHECK(res.get_error().get_code() == easycmd::ERR_UNEXPECTED_ARGUMENT);
+	CHECK(res.get_error().get_token() == 3);
+
+	const char *failed[] = { "app", "stop" };
+	CHECK(unit_run(app, failed, res) == 3);
+	CHECK(res.get_error().get_code() == easycmd::ERR_ACTION_FAILED);
+	CHECK(unit_contains(res.get_err(), "process command stop failed"));
+
+	const char *ok[] = { "app" };
+	CHECK(unit_run(app, ok, res) == 0);
+	CHECK(res.get_error().get_code() == easycmd::ERR_NONE);
+	CHECK(res.get_err().empty());
+}
+
+UNIT_CASE(legacy_run)
+{
+	easycmd::command app;
+	build_app(app);
+
+	const char *argv[] = { "app", "-c", "5" };
+	CHECK(app.run(3, argv) == 0);
+	CHECK(app.get_option("count")->get_int() == 5);
+
+	const char *bad[] = { "app", "--bad" };
+	CHECK(app.run(2, bad) != 0);
+	CHECK(app.get_error().get_code() == easycmd::ERR_UNKNOWN_OPTION);
+	CHECK(unit_contains(app.get_err(), "--bad"));
+}
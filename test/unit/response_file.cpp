@@ -0,0 +1,138 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "unit.h"
+
+static int noop(const easycmd::command*)
+{
+	return 0;
+}
+
+static void build_app(easycmd::command &app)
+{
+	app.with_name("app")->with_action(noop);
+	app.create_option_string("user", "u")->with_default("");
+	app.create_option_int("count", "c")->with_default(0);
+	app.create_option_bool("all", "a")->with_default(false);
+	app.create_positional_tail("files");
+}
+
+static std::string operands(const easycmd::parse_result &res)
+{
+	std::string out;
+	easycmd::operand_range r = res.get_operands();
+	for (easycmd::operand_iterator it = r.begin(); it != r.end(); ++it) {
+		out.append(out.empty() ? "" : " ").append(*it);
+	}
+	return out;
+}
+
+UNIT_CASE(response_file_disabled_by_default)
+{
+	easycmd::command app;
+	build_app(app);
+
+	easycmd::parse_result res;
+	const char *argv[] = { "app", "--user", "@bob", "@handle" };
+	CHECK(unit_run(app, argv, res) == 0);
+	CHECK_STR(res.get_option("user")->get_string(), "@bob");
+	CHECK_STR(operands(res), "@handle");
+}
+
+UNIT_CASE(response_file_expanded)
+{
+	easycmd::command app;
+	build_app(app);
+	app.with_response_files(true);
+
+	CHECK(unit_write_file("unit_args.rsp", 
+		"# comment line\n"
+		"--user \"a b\"   # trailing comment\n"
+		"-c 3 'x y'\n"
+		"@unit_nested.rsp\n"));
+	CHECK(unit_write_file("unit_nested.rsp", "-a nested\n"));
+
+	easycmd::parse_result res;
+	const char *argv[] = { "app", "first", "@unit_args.rsp", "last" };
+	CHECK(unit_run(app, argv, res) == 0);
+	CHECK_STR(res.get_option("user")->get_string(), "a b");
+	CHECK(res.get_option("count")->get_int() == 3);
+	CHECK(res.get_option("all")->get_bool());
+	CHECK_STR(operands(res), "first x y nested last");
+
+	// Args point into the files, which are kept until the result is cleared
+	const char *again[] = { "app", "@unit_nested.rsp" };
+	CHECK(unit_run(app, again, res) == 0);
+	CHECK_STR(operands(res), "nested");
+
+	remove("unit_args.rsp");
+	remove("unit_nested.rsp");
+}
+
+UNIT_CASE(response_file_stops_at_end_of_options)
+{
+	easycmd::command app;
+	build_app(app);
+	app.with_response_files(true);
+
+	CHECK(unit_write_file("unit_end.rsp", "-c 1 -- @not_a_file\n"));
+
+	easycmd::parse_result res;
+	const char *argv[] = { "app", "@unit_end.rsp", "@also_not" };
+	CHECK(unit_run(app, argv, res) == 0);
+	CHECK(res.get_option("count")->get_int() == 1);
+	CHECK_STR(operands(res), "@not_a_file @also_not");
+
+	const char *after[] = { "app", "--", "@missing.rsp" };
+	CHECK(unit_run(app, after, res) == 0);
+	CHECK_STR(operands(res), "@missing.rsp");
+
+	remove("unit_end.rsp");
+}
+
+UNIT_CASE(response_file_errors)
+{
+	easycmd::command app;
+	build_app(app);
+	app.with_response_files(true);
+
+	easycmd::parse_result res;
+	const char *missing[] = { "app", "@unit_missing.rsp" };
+	CHECK(unit_run(app, missing, res) != 0);
+	CHECK(res.get_error().get_code() == easycmd::ERR_RESPONSE_FILE);
+	CHECK(unit_contains(res.get_err(), "open response file unit_missing.rsp failed"));
+
+	CHECK(unit_write_file("unit_quote.rsp", "--user \"open\n"));
+	const char *quote[] = { "app", "@unit_quote.rsp" };
+	CHECK(unit_run(app, quote, res) != 0);
+	CHECK(unit_contains(res.get_err(), "unterminated quote"));
+
+	CHECK(unit_write_file("unit_loop.rsp", "@unit_loop.rsp\n"));
+	const char *loop[] = { "app", "@unit_loop.rsp" };
+	CHECK(unit_run(app, loop, res) != 0);
+	CHECK(unit_contains(res.get_err(), "nested too deep"));
+
+	remove("unit_quote.rsp");
+	remove("unit_loop.rsp");
+}
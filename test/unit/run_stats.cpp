@@ -0,0 +1,104 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "unit.h"
+
+static int noop(const easycmd::command*)
+{
+	return 0;
+}
+
+static int traced_runs = 0;
+static easycmd::run_stats last_stats;
+
+static void on_trace(const easycmd::command*, const easycmd::parse_result &res)
+{
+	traced_runs++;
+	last_stats = res.get_stats();
+}
+
+static size_t allocs = 0;
+
+static size_t count_allocs()
+{
+	return allocs += 2;
+}
+
+static void build_app(easycmd::command &app)
+{
+	app.with_name("app")->with_action(noop);
+	easycmd::command *get = app.create_sub_cmd("get")->with_action(noop);
+	get->create_option_int("count", "c")->with_default(1);
+	get->create_option_string("name", "")->with_env("UNIT_NAME")->with_default("");
+}
+
+UNIT_CASE(stats_counts)
+{
+	easycmd::command app;
+	build_app(app);
+
+	easycmd::parse_result res;
+	const char *argv[] = { "app", "get", "--count", "2", "-c", "3" };
+	CHECK(unit_run(app, argv, res) == 0);
+	const easycmd::run_stats &st = res.get_stats();
+	CHECK(st.ret == 0);
+	CHECK(st.tokens >= 5);
+	CHECK(st.option_lookups == 2);
+	CHECK(st.env_probes == 1);
+	// Untraced runs don't read the clock
+	CHECK(st.total_ns == 0);
+	CHECK(traced_runs == 0);
+}
+
+UNIT_CASE(stats_traced)
+{
+	easycmd::command app;
+	build_app(app);
+	app.with_trace(on_trace, count_allocs);
+
+	easycmd::parse_result res;
+	const char *argv[] = { "app", "get", "--count", "x" };
+	CHECK(unit_run(app, argv, res) != 0);
+	CHECK(traced_runs == 1);
+	CHECK(last_stats.ret != 0);
+	CHECK(last_stats.allocations == 2);
+
+	uint64_t phases = 0;
+	for (int i = 0; i < easycmd::PHASE_COUNT; i++) {
+		phases += last_stats.phase_ns[i];
+	}
+	CHECK(last_stats.total_ns > 0);
+	CHECK(phases <= last_stats.total_ns);
+
+	std::string json;
+	last_stats.to_json(json);
+	CHECK(unit_contains(json, "\"ret\": "));
+	CHECK(unit_contains(json, "\"dispatch\": "));
+	CHECK(unit_contains(json, "\"option_lookups\": 1"));
+
+	app.with_trace(NULL);
+	const char *ok[] = { "app", "get" };
+	CHECK(unit_run(app, ok, res) == 0);
+	CHECK(traced_runs == 1);
+}
@@ -0,0 +1,251 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "unit.h"
+
+#include <easycmd/schema.h>
+
+#include <chrono>
+#include <vector>
+#include <string.h>
+
+static int noop(const easycmd::command*)
+{
+	return 0;
+}
+
+static void build_app(easycmd::command &app)
+{
+	app.with_name("app")->with_desc("Tool")->with_env_prefix("APP_")->with_action(noop);
+	app.create_option_bool("verbose", "v")->with_default(true);
+	app.create_option_int("level", "l")->with_default(3)->with_env("APP_LEVEL");
+	app.create_option_float("ratio", "")->with_default(0.5);
+	app.create_option_string("name", "n")->with_default("anon")->with_desc("Name");
+	std::vector<std::string> modes;
+	modes.push_back("fast");
+	modes.push_back("safe");
+	app.create_option_choice("mode", "", modes)->with_default("safe");
+	app.create_option<std::chrono::milliseconds>("wait", "")->with_default(std::chrono::milliseconds(250));
+
+	easycmd::command *get = app.create_sub_cmd("get")->with_desc("Get a key")->with_action(noop);
+	get->create_positional("key")->with_desc("Key");
+	get->create_positional_tail("rest");
+	get->create_option_int("limit", "")->with_default(10);
+	app.create_public_sub_cmd("help")->with_action(noop);
+}
+
+// Aligned copy of a schema
+static std::vector<uint64_t> aligned(const std::string &des)
+{
+	std::vector<uint64_t> buf((des.size() + 7) / 8);
+	memcpy(&buf[0], des.data(), des.size());
+	return buf;
+}
+
+// Reads every string and record reachable from the root
+static size_t walk(const easycmd::schema_command &cmd, int depth)
+{
+	size_t n = strlen(cmd.get_name()) + strlen(cmd.get_desc()) + strlen(cmd.get_env_prefix());
+	for (size_t i = 0; i < cmd.get_option_count(); i++) {
+		easycmd::schema_option opt = cmd.get_option(i);
+		size_t size = 0;
+		opt.get_default_bytes(size);
+		n += strlen(opt.get_long_name()) + strlen(opt.get_short_name()) + strlen(opt.get_env()) + 
+			strlen(opt.get_desc()) + strlen(opt.get_default_string()) + strlen(opt.get_choices()) + size;
+		n += cmd.find_option(opt.get_long_name()).valid();
+	}
+	for (size_t i = 0; i < cmd.get_positional_count(); i++) {
+		n += strlen(cmd.get_positional(i).get_name()) + strlen(cmd.get_positional(i).get_desc());
+	}
+	if (depth < 4) {
+		for (size_t i = 0; i < cmd.get_sub_cmd_count(); i++) {
+			n += walk(cmd.get_sub_cmd(i), depth + 1);
+		}
+		for (size_t i = 0; i < cmd.get_public_sub_cmd_count(); i++) {
+			n += walk(cmd.get_public_sub_cmd(i), depth + 1);
+		}
+	}
+	n += cmd.find_sub_cmd("get").valid() + cmd.get_parent().valid();
+	return n;
+}
+
+UNIT_CASE(schema_round_trip)
+{
+	easycmd::command app;
+	build_app(app);
+	std::string des;
+	app.get_schema(des);
+	std::vector<uint64_t> buf = aligned(des);
+
+	easycmd::schema s;
+	std::string err;
+	CHECK(s.load(&buf[0], des.size(), err));
+	CHECK(err.empty());
+	CHECK(s.get_cmd_count() == 3);
+
+	easycmd::schema_command root = s.get_root();
+	CHECK_STR(root.get_name(), "app");
+	CHECK_STR(root.get_desc(), "Tool");
+	CHECK_STR(root.get_env_prefix(), "APP_");
+	CHECK(root.has_action());
+	CHECK(!root.get_parent().valid());
+	CHECK(root.get_option_count() == 6);
+
+	CHECK(root.find_option("verbose").get_default_bool());
+	CHECK_STR(root.find_option("verbose").get_short_name(), "v");
+	CHECK(root.find_option("level").get_default_int() == 3);
+	CHECK_STR(root.find_option("level").get_env(), "APP_LEVEL");
+	CHECK(root.find_option("ratio").get_default_float() == 0.5);
+	CHECK_STR(root.find_option("name").get_default_string(), "anon");
+	CHECK_STR(root.find_option("name").get_desc(), "Name");
+	CHECK_STR(root.find_option("mode").get_choices(), "fast|safe");
+	CHECK(root.find_option("mode").get_default_int() == 1);
+	CHECK(!root.find_option("missing").valid());
+
+	size_t size = 0;
+	const void *wait = root.find_option("wait").get_default_bytes(size);
+	CHECK(size == sizeof(std::chrono::milliseconds));
+	std::chrono::milliseconds ms;
+	memcpy(&ms, wait, sizeof(ms));
+	CHECK(ms.count() == 250);
+
+	easycmd::schema_command get = root.find_sub_cmd("get");
+	CHECK(get.valid());
+	CHECK_STR(get.get_desc(), "Get a key");
+	CHECK(get.get_parent().valid());
+	CHECK(get.get_positional_count() == 2);
+	CHECK_STR(get.get_positional(0).get_name(), "key");
+	CHECK(get.get_positional(0).is_required());
+	CHECK(get.get_positional(1).is_tail());
+	CHECK(get.find_option("limit").get_default_int() == 10);
+
+	// Public sub commands are found below the command they are added to
+	CHECK(root.find_public_sub_cmd("help").valid());
+	const char *path[] = { "get", "help" };
+	CHECK(s.find(path, 2).valid());
+	CHECK(walk(root, 0) > 0);
+
+	// Same tree, same bytes
+	easycmd::command again;
+	build_app(again);
+	std::string des2;
+	again.get_schema(des2);
+	CHECK(des == des2);
+}
+
+UNIT_CASE(schema_rejects_truncated)
+{
+	easycmd::command app;
+	build_app(app);
+	std::string des;
+	app.get_schema(des);
+	std::vector<uint64_t> buf = aligned(des);
+	easycmd::internal::schema_header *hdr = (easycmd::internal::schema_header*)&buf[0];
+
+	easycmd::schema s;
+	std::string err;
+	for (size_t size = 0; size < des.size(); size++) {
+		CHECK(!s.load(&buf[0], size, err));
+		CHECK(!err.empty());
+	}
+
+	// Tables cut off even if the size in the header agrees, the padding at the end
+	// can be dropped
+	size_t end = hdr->strs + hdr->str_size;
+	for (size_t size = sizeof(*hdr); size < end; size += 4) {
+		hdr->size = (uint32_t)size;
+		CHECK(!s.load(&buf[0], size, err));
+	}
+	CHECK(!s.get_root().valid());
+}
+
+UNIT_CASE(schema_rejects_corrupted)
+{
+	easycmd::command app;
+	build_app(app);
+	std::string des;
+	app.get_schema(des);
+	const easycmd::internal::schema_header *orig = (const easycmd::internal::schema_header*)des.data();
+
+	easycmd::schema s;
+	std::string err;
+	{
+		std::vector<uint64_t> buf = aligned(des);
+		((char*)&buf[0])[0] = 'X';
+		CHECK(!s.load(&buf[0], des.size(), err));
+		CHECK_STR(err.c_str(), "not a schema file\n");
+
+		buf = aligned(des);
+		((easycmd::internal::schema_header*)&buf[0])->version++;
+		CHECK(!s.load(&buf[0], des.size(), err));
+		CHECK_STR(err.c_str(), "unsupported schema version or byte order\n");
+
+		// Strings must end within the string table
+		buf = aligned(des);
+		memset((char*)&buf[0] + orig->strs, 'x', orig->str_size);
+		CHECK(!s.load(&buf[0], des.size(), err));
+		CHECK_STR(err.c_str(), "invalid schema\n");
+
+		buf = aligned(des);
+		((char*)&buf[0])[orig->strs + orig->str_size - 1] = 'x';
+		CHECK(!s.load(&buf[0], des.size(), err));
+
+		// A name pointing past the string table
+		buf = aligned(des);
+		easycmd::internal::schema_cmd_rec *cmd = (easycmd::internal::schema_cmd_rec*)((char*)&buf[0] + orig->cmds);
+		cmd->name = orig->str_size;
+		CHECK(!s.load(&buf[0], des.size(), err));
+
+		// Sub command refs out of range
+		buf = aligned(des);
+		cmd = (easycmd::internal::schema_cmd_rec*)((char*)&buf[0] + orig->cmds);
+		uint32_t *refs = (uint32_t*)((char*)&buf[0] + orig->refs);
+		refs[cmd->subs] = orig->cmd_count;
+		CHECK(!s.load(&buf[0], des.size(), err));
+
+		// Misaligned data
+		std::vector<uint64_t> shifted(buf.size() + 1);
+		memcpy((char*)&shifted[0] + 4, des.data(), des.size());
+		CHECK(!s.load((char*)&shifted[0] + 4, des.size(), err));
+	}
+
+	// Any word of the records set to a bad offset or count is rejected, or loads a 
+	// schema whose strings and records can all be read
+	static const uint32_t values[] = { 0, 1, 7, 0x7fffffff, 0xffffffff };
+	size_t accepted = 0;
+	for (size_t off = 0; off + 4 <= orig->strs; off += 4) {
+		for (size_t v = 0; v < sizeof(values) / sizeof(values[0]); v++) {
+			for (int delta = 0; delta < 2; delta++) {
+				std::vector<uint64_t> buf = aligned(des);
+				uint32_t *word = (uint32_t*)((char*)&buf[0] + off);
+				*word = delta ? *word + values[v] : values[v];
+				if (s.load(&buf[0], des.size(), err)) {
+					accepted++;
+					CHECK(walk(s.get_root(), 0) > 0);
+				}
+			}
+		}
+	}
+	CHECK(accepted > 0);
+}
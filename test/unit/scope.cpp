@@ -0,0 +1,133 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "unit.h"
+
+#include <easycmd/memory_report.h>
+
+static int noop(const easycmd::command*)
+{
+	return 0;
+}
+
+UNIT_CASE(scope_sees_added_sub_cmds)
+{
+	easycmd::command app;
+	app.with_name("app")->with_action(noop);
+	easycmd::command *a = app.create_sub_cmd("a")->with_action(noop);
+	easycmd::command *b = a->create_sub_cmd("b")->with_action(noop);
+
+	easycmd::parse_result res;
+	const char *ab[] = { "app", "a", "b" };
+	CHECK(unit_run(app, ab, res) == 0);
+	CHECK(res.get_cmd() == b);
+
+	// Public sub commands of a parent added after the scope was built
+	const char *abh[] = { "app", "a", "b", "help" };
+	CHECK(unit_run(app, abh, res) != 0);
+	easycmd::command *help = app.create_public_sub_cmd("help")->with_action(noop);
+	CHECK(unit_run(app, abh, res) == 0);
+	CHECK(res.get_cmd() == help);
+
+	// A nearer one shadows it
+	easycmd::command *near = a->create_public_sub_cmd("help")->with_action(noop);
+	CHECK(unit_run(app, abh, res) == 0);
+	CHECK(res.get_cmd() == near);
+
+	// Sub commands added to b itself
+	const char *abc[] = { "app", "a", "b", "c" };
+	easycmd::command *c = b->create_sub_cmd("c")->with_action(noop);
+	CHECK(unit_run(app, abc, res) == 0);
+	CHECK(res.get_cmd() == c);
+
+	std::string usage;
+	b->get_usage(usage);
+	CHECK(unit_contains(usage, "help"));
+	CHECK(unit_contains(usage, "c"));
+}
+
+UNIT_CASE(scope_rebuilt_in_place)
+{
+	easycmd::command app;
+	app.with_name("app")->with_action(noop);
+	easycmd::command *a = app.create_sub_cmd("a")->with_action(noop);
+	a->create_sub_cmd("b")->with_action(noop);
+	easycmd::command *other = app.create_sub_cmd("other")->with_action(noop);
+	easycmd::command *x = other->create_sub_cmd("x")->with_action(noop);
+
+	easycmd::parse_result res;
+	const char *ab[] = { "app", "a", "b" };
+	CHECK(unit_run(app, ab, res) == 0);
+
+	// Changing the tree again and again doesn't take more of the arena
+	easycmd::memory_report first;
+	for (int i = 0; i < 100; i++) {
+		app.add_sub_cmd(a);
+		other->add_sub_cmd(x);
+		CHECK(unit_run(app, ab, res) == 0);
+		if (i == 0) {
+			app.get_memory_report(first);
+		}
+	}
+	easycmd::memory_report last;
+	app.get_memory_report(last);
+	CHECK(last.arena_used == first.arena_used);
+}
+
+UNIT_CASE(scope_usage_layout_rebuilt_in_place)
+{
+	easycmd::command app;
+	app.with_name("app")->with_action(noop);
+	app.create_option_int("count", "c")->with_default(1);
+	easycmd::command *a = app.create_sub_cmd("a")->with_action(noop);
+
+	// Measuring the usage again after the tree changes doesn't take more of the arena
+	std::string usage;
+	easycmd::memory_report first;
+	for (int i = 0; i < 100; i++) {
+		app.add_sub_cmd(a);
+		usage.clear();
+		app.get_usage(usage);
+		if (i == 0) {
+			app.get_memory_report(first);
+		}
+	}
+	easycmd::memory_report last;
+	app.get_memory_report(last);
+	CHECK(last.arena_used == first.arena_used);
+
+	// Options added past the measured ones are measured too
+	for (int i = 0; i < 20; i++) {
+		std::string name = "option-" + std::to_string(i);
+		app.create_option_int(name.c_str(), "")->with_default(i);
+		usage.clear();
+		app.get_usage(usage);
+		CHECK(unit_contains(usage, name.c_str()));
+	}
+	app.create_option_int("a-much-longer-option-name", "")->with_default(0);
+	usage.clear();
+	app.get_usage(usage);
+	CHECK(unit_contains(usage, "-c, --count                  [Optional]"));
+	CHECK(unit_contains(usage, "--a-much-longer-option-name  [Optional]"));
+}
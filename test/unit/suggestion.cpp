@@ -0,0 +1,145 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "unit.h"
+
+#include <easycmd/suggestion.h>
+
+#include <stdlib.h>
+#include <algorithm>
+
+static int noop(const easycmd::command*)
+{
+	return 0;
+}
+
+// Plain dynamic programming distance to check the bit-parallel one against
+static size_t reference_distance(const std::string &a, const std::string &b)
+{
+	std::vector<size_t> prev(b.size() + 1);
+	std::vector<size_t> cur(b.size() + 1);
+	for (size_t j = 0; j <= b.size(); j++) {
+		prev[j] = j;
+	}
+	for (size_t i = 1; i <= a.size(); i++) {
+		cur[0] = i;
+		for (size_t j = 1; j <= b.size(); j++) {
+			size_t sub = prev[j - 1] + (a[i - 1] == b[j - 1] ? 0 : 1);
+			cur[j] = std::min(sub, std::min(prev[j], cur[j - 1]) + 1);
+		}
+		prev.swap(cur);
+	}
+	return prev[b.size()];
+}
+
+static std::string random_word(size_t max_len)
+{
+	std::string w(rand() % (max_len + 1), 'a');
+	for (size_t i = 0; i < w.size(); i++) {
+		w[i] = (char)('a' + rand() % 4);
+	}
+	return w;
+}
+
+UNIT_CASE(suggestion_edit_distance)
+{
+	uint64_t peq[256];
+	easycmd::internal::build_peq("kitten", 6, peq);
+	CHECK(easycmd::internal::edit_distance(peq, 6, "sitting", 7, 10) == 3);
+	CHECK(easycmd::internal::edit_distance(peq, 6, "kitten", 6, 0) == 0);
+	// Bounded: anything above the max is max + 1
+	CHECK(easycmd::internal::edit_distance(peq, 6, "sitting", 7, 1) == 2);
+
+	srand(7);
+	for (int i = 0; i < 2000; i++) {
+		std::string p = random_word(64);
+		std::string t = random_word(70);
+		if (p.empty()) {
+			continue;
+		}
+		easycmd::internal::build_peq(p.data(), p.size(), peq);
+		size_t expect = reference_distance(p, t);
+		size_t max_dist = (size_t)(rand() % 70);
+		size_t got = easycmd::internal::edit_distance(peq, p.size(), t.data(), t.size(), max_dist);
+		CHECK(got == std::min(expect, max_dist + 1));
+	}
+}
+
+UNIT_CASE(suggestion_closest_names)
+{
+	easycmd::internal::suggestion s("strat", 5);
+	s.add("", "start");
+	s.add("", "stop");
+	s.add("", "restart");
+	s.add("--", "strata");
+	CHECK(s.size() == 2);
+	std::string out;
+	s.format(out);
+	CHECK_STR(out, "did you mean: --strata, start\n");
+
+	easycmd::internal::suggestion none("xyz", 3);
+	none.add("", "start");
+	CHECK(none.size() == 0);
+	out.clear();
+	none.format(out);
+	CHECK(out.empty());
+
+	std::string long_word(65, 'a');
+	easycmd::internal::suggestion too_long(long_word.data(), long_word.size());
+	too_long.add("", long_word.c_str());
+	CHECK(too_long.size() == 0);
+}
+
+UNIT_CASE(suggestion_in_errors)
+{
+	easycmd::command app;
+	app.with_name("app")->with_action(noop);
+	app.create_option_bool("verbose", "")->with_default(false);
+	app.create_sub_cmd("start")->with_action(noop);
+	easycmd::command *remote = app.create_sub_cmd("remote");
+	remote->with_action(noop);
+	remote->create_option_int("timeout", "")->with_default(1);
+	app.create_public_sub_cmd("status")->with_action(noop);
+
+	easycmd::parse_result res;
+	const char *cmd[] = { "app", "strat" };
+	CHECK(unit_run(app, cmd, res) != 0);
+	CHECK(unit_contains(res.get_err(), "did you mean: start"));
+
+	const char *opt[] = { "app", "--verbos" };
+	CHECK(unit_run(app, opt, res) != 0);
+	CHECK(unit_contains(res.get_err(), "did you mean: --verbose"));
+
+	// Public sub commands of the path and options of the dispatched command
+	const char *pub[] = { "app", "remote", "statu" };
+	CHECK(unit_run(app, pub, res) != 0);
+	CHECK(unit_contains(res.get_err(), "did you mean: status"));
+	const char *sub_opt[] = { "app", "remote", "--timeuot=1" };
+	CHECK(unit_run(app, sub_opt, res) != 0);
+	CHECK(unit_contains(res.get_err(), "--timeout"));
+
+	const char *far[] = { "app", "--zzzzzz" };
+	CHECK(unit_run(app, far, res) != 0);
+	CHECK(!unit_contains(res.get_err(), "did you mean"));
+}
@@ -0,0 +1,108 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "unit.h"
+
+#include <easycmd/tokenizer.h>
+
+#include <string.h>
+
+// Splits a copy of line, args are joined with '|' and wrapped in '[' ']'
+static std::string split(const char *line, bool comments = false)
+{
+	std::vector<char> buf(line, line + strlen(line) + 1);
+	std::vector<const char*> args;
+	if (!easycmd::internal::split_command_line(&buf[0], args, comments)) {
+		return "unterminated";
+	}
+
+	std::string out;
+	for (size_t i = 0; i < args.size(); i++) {
+		out.append(i > 0 ? "|" : "").append("[").append(args[i]).append("]");
+	}
+	return out;
+}
+
+UNIT_CASE(split_whitespace)
+{
+	CHECK_STR(split(""), "");
+	CHECK_STR(split(" \t\r\n"), "");
+	CHECK_STR(split("a"), "[a]");
+	CHECK_STR(split("  run\t--count 3 \r\n"), "[run]|[--count]|[3]");
+	CHECK_STR(split("a\n\nb"), "[a]|[b]");
+}
+
+UNIT_CASE(split_quotes)
+{
+	CHECK_STR(split("'a b' \"c d\""), "[a b]|[c d]");
+	CHECK_STR(split("'say \"hi\"' \"it's\""), "[say \"hi\"]|[it's]");
+
+	// Quoted parts join the chars around them
+	CHECK_STR(split("--name='a b'c \"x\"'y'z"), "[--name=a bc]|[xyz]");
+
+	// Empty quotes are empty args
+	CHECK_STR(split("'' \"\" a"), "[]|[]|[a]");
+	CHECK_STR(split("a ''"), "[a]|[]");
+}
+
+UNIT_CASE(split_escapes)
+{
+	CHECK_STR(split("a\\ b c"), "[a b]|[c]");
+	CHECK_STR(split("\\'x\\\" \\\\"), "['x\"]|[\\]");
+	CHECK_STR(split("\"a\\\"b\" \"c\\\\\""), "[a\"b]|[c\\]");
+
+	// Backslashes are kept in single quotes
+	CHECK_STR(split("'a\\b' 'c\\'"), "[a\\b]|[c\\]");
+
+	// A trailing backslash is kept
+	CHECK_STR(split("a\\"), "[a\\]");
+}
+
+UNIT_CASE(split_unterminated)
+{
+	CHECK_STR(split("'"), "unterminated");
+	CHECK_STR(split("a 'b c"), "unterminated");
+	CHECK_STR(split("a \"b"), "unterminated");
+	CHECK_STR(split("\"a\\\""), "unterminated");
+	CHECK_STR(split("'a\"b"), "unterminated");
+}
+
+UNIT_CASE(split_comments)
+{
+	CHECK_STR(split("a # b", true), "[a]");
+	CHECK_STR(split("# a\nb c # d\n  #e\nf", true), "[b]|[c]|[f]");
+	CHECK_STR(split("a#b '#c'", true), "[a#b]|[#c]");
+	CHECK_STR(split("a # b"), "[a]|[#]|[b]");
+}
+
+UNIT_CASE(split_in_place)
+{
+	// Args point into the rewritten line
+	char line[] = "x 'a b' c\\ d";
+	std::vector<const char*> args;
+	CHECK(easycmd::internal::split_command_line(line, args));
+	CHECK(args.size() == 3);
+	CHECK(args.size() == 3 && args[0] == line && args[1] == line + 2 && args[2] == line + 6);
+	CHECK(args.size() == 3 && strcmp(args[1], "a b") == 0 && strcmp(args[2], "c d") == 0);
+}
@@ -0,0 +1,169 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "unit.h"
+
+using easycmd::PARSE_OK;
+using easycmd::PARSE_INVALID;
+using easycmd::PARSE_OVERFLOW;
+
+enum unit_color { COLOR_RED, COLOR_GREEN, COLOR_BLUE };
+
+namespace easycmd {
+	template <>
+	struct option_parser<unit_color> {
+		static parse_status parse(const char *value, size_t len, unit_color &out) {
+			static const enum_value<unit_color> values[] = { 
+				{ "red", COLOR_RED }, 
+				{ "green", COLOR_GREEN }, 
+				{ "blue", COLOR_BLUE } 
+			};
+			return parse_enum(value, len, values, out);
+		}
+	};
+}
+
+static int noop(const easycmd::command*)
+{
+	return 0;
+}
+
+static easycmd::parse_status duration_of(const char *s, int64_t &ns)
+{
+	return easycmd::internal::parse_duration(s, strlen(s), ns);
+}
+
+static easycmd::parse_status size_of(const char *s, uint64_t &bytes)
+{
+	return easycmd::internal::parse_byte_size(s, strlen(s), bytes);
+}
+
+static easycmd::parse_status endpoint_of(const char *s, easycmd::endpoint &ep)
+{
+	return easycmd::internal::parse_endpoint(s, strlen(s), ep);
+}
+
+UNIT_CASE(typed_duration)
+{
+	int64_t ns = 0;
+	CHECK(duration_of("0", ns) == PARSE_OK && ns == 0);
+	CHECK(duration_of("250ms", ns) == PARSE_OK && ns == 250000000LL);
+	CHECK(duration_of("1.5s", ns) == PARSE_OK && ns == 1500000000LL);
+	CHECK(duration_of("1h30m", ns) == PARSE_OK && ns == 5400LL * 1000000000LL);
+	CHECK(duration_of("2d", ns) == PARSE_OK && ns == 172800LL * 1000000000LL);
+	CHECK(duration_of("10us5ns", ns) == PARSE_OK && ns == 10005);
+	CHECK(duration_of("", ns) == PARSE_INVALID);
+	CHECK(duration_of("5", ns) == PARSE_INVALID);
+	CHECK(duration_of("5x", ns) == PARSE_INVALID);
+	CHECK(duration_of("s", ns) == PARSE_INVALID);
+	CHECK(duration_of("1000000d", ns) == PARSE_OVERFLOW);
+}
+
+UNIT_CASE(typed_byte_size)
+{
+	uint64_t b = 0;
+	CHECK(size_of("512", b) == PARSE_OK && b == 512);
+	CHECK(size_of("64MiB", b) == PARSE_OK && b == 64ULL << 20);
+	CHECK(size_of("1.5G", b) == PARSE_OK && b == 3ULL << 29);
+	CHECK(size_of("2kb", b) == PARSE_OK && b == 2000);
+	CHECK(size_of("1k", b) == PARSE_OK && b == 1024);
+	CHECK(size_of("16e", b) == PARSE_OVERFLOW);
+	CHECK(size_of("", b) == PARSE_INVALID);
+	CHECK(size_of("12q", b) == PARSE_INVALID);
+	CHECK(size_of("-1", b) == PARSE_INVALID);
+}
+
+UNIT_CASE(typed_endpoint)
+{
+	easycmd::endpoint ep;
+	CHECK(endpoint_of("127.0.0.1:8080", ep) == PARSE_OK);
+	CHECK(ep.family == 4 && ep.port == 8080);
+	CHECK(ep.addr[0] == 127 && ep.addr[1] == 0 && ep.addr[2] == 0 && ep.addr[3] == 1);
+
+	CHECK(endpoint_of("[::1]:443", ep) == PARSE_OK);
+	CHECK(ep.family == 6 && ep.port == 443 && ep.addr[15] == 1 && ep.addr[0] == 0);
+
+	CHECK(endpoint_of("[2001:db8::ff00:42:8329]:1", ep) == PARSE_OK);
+	CHECK(ep.addr[0] == 0x20 && ep.addr[1] == 0x01 && ep.addr[14] == 0x83 && ep.addr[15] == 0x29);
+
+	const char *invalid[] = { "", "1.2.3.4", "1.2.3:80", "256.1.1.1:80", "1.2.3.4:", "1.2.3.4:x", "[::1]", "::1:80", "[::1:80" };
+	for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+		CHECK(endpoint_of(invalid[i], ep) != PARSE_OK);
+	}
+	CHECK(endpoint_of("1.2.3.4:65536", ep) == PARSE_OVERFLOW);
+}
+
+UNIT_CASE(typed_options)
+{
+	easycmd::command app;
+	app.with_name("app")->with_action(noop);
+	easycmd::typed_option<std::chrono::milliseconds> *timeout = 
+		app.create_option<std::chrono::milliseconds>("timeout", "t")->with_default(std::chrono::milliseconds(100));
+	easycmd::typed_option<easycmd::byte_size> *limit = app.create_option<easycmd::byte_size>("limit", "");
+	easycmd::typed_option<unit_color> *color = 
+		app.create_option<unit_color>("color", "")->with_env("UNIT_COLOR")->with_default(COLOR_RED);
+	easycmd::typed_option<unsigned int> *workers = 
+		app.create_option<unsigned int>("workers", "")->with_default(1u);
+	CHECK(app.create_option<int>("timeout", "") == NULL);
+
+	easycmd::parse_result res;
+	const char *argv[] = { "app", "-t", "1.5s", "--limit=4KiB" };
+	CHECK(unit_run(app, argv, res) == 0);
+	CHECK(res.get(timeout)->count() == 1500);
+	CHECK(res.get(limit)->bytes == 4096);
+	CHECK(*res.get(color) == COLOR_RED);
+	CHECK(*res.get(workers) == 1);
+
+	const char *env[] = { "UNIT_COLOR=blue", NULL };
+	res.set_env(env);
+	const char *argv2[] = { "app", "--limit", "1", "--workers", "8" };
+	CHECK(unit_run(app, argv2, res) == 0);
+	CHECK(res.get(timeout)->count() == 100);
+	CHECK(*res.get(color) == COLOR_BLUE);
+	CHECK(*res.get(workers) == 8);
+	res.set_env(NULL);
+
+	// Required without default
+	const char *missing[] = { "app" };
+	CHECK(unit_run(app, missing, res) != 0);
+	CHECK(res.get_error().get_code() == easycmd::ERR_OPTION_REQUIRED);
+
+	const char *bad[] = { "app", "--limit", "1", "--color", "pink" };
+	CHECK(unit_run(app, bad, res) != 0);
+	CHECK(res.get_error().get_code() == easycmd::ERR_INVALID_VALUE);
+
+	const char *range[] = { "app", "--limit", "1", "--workers", "4294967296" };
+	CHECK(unit_run(app, range, res) != 0);
+	CHECK(res.get_error().get_code() == easycmd::ERR_OUT_OF_RANGE);
+
+	// Values of run(argc, argv) are kept in the options
+	CHECK(app.run(4, argv) == 0);
+	CHECK(timeout->get().count() == 1500);
+	CHECK(limit->get().bytes == 4096);
+
+	// An option of another command has no value in the result
+	easycmd::command other;
+	easycmd::typed_option<int> *n = other.create_option<int>("n", "")->with_default(1);
+	CHECK(res.get(n) == NULL);
+}
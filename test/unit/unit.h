@@ -0,0 +1,84 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef easycmd_unit_h
+#define easycmd_unit_h
+
+#include <easycmd/command.h>
+
+#include <string>
+#include <stdio.h>
+
+/*********************************************************************************
+ * Unit tests
+ * Cases register themselves and run in order of registration. A failed check is
+ * reported and the case goes on, the test fails if any check failed.
+ ********************************************************************************/
+typedef void(*unit_case)();
+
+struct unit_register
+{
+	unit_register(const char *name, unit_case fn);
+};
+
+void unit_fail(const char *file, int line, const char *expr);
+
+#define UNIT_CASE(name) \
+	static void unit_##name(); \
+	static unit_register unit_reg_##name(#name, unit_##name); \
+	static void unit_##name()
+
+#define CHECK(expr) \
+	do { \
+		if (!(expr)) { \
+			unit_fail(__FILE__, __LINE__, #expr); \
+		} \
+	} while (0)
+
+#define CHECK_STR(a, b) CHECK(std::string(a) == std::string(b))
+
+/*********************************************************************************
+ * Run args with parse result
+ ********************************************************************************/
+template <size_t N>
+int unit_run(const easycmd::command &cmd, const char *(&argv)[N], easycmd::parse_result &res)
+{
+	return cmd.run((int)N, argv, res);
+}
+
+/*********************************************************************************
+ * Write file in the working directory
+ * Return false if it can't be written.
+ ********************************************************************************/
+bool unit_write_file(const char *path, const std::string &content);
+
+/*********************************************************************************
+ * Check text contains part
+ ********************************************************************************/
+inline bool unit_contains(const std::string &text, const char *part)
+{
+	return text.find(part) != std::string::npos;
+}
+
+#endif
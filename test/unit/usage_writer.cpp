@@ -0,0 +1,133 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "unit.h"
+
+#include <easycmd/usage_writer.h>
+
+#include <stdio.h>
+
+static int noop(const easycmd::command*)
+{
+	return 0;
+}
+
+// Text written to a temporary file through a writer of its fd or FILE
+static std::string read_back(FILE *f)
+{
+	std::string text;
+	fflush(f);
+	rewind(f);
+	char buf[4096];
+	size_t n;
+	while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+		text.append(buf, n);
+	}
+	fclose(f);
+	return text;
+}
+
+// Short copied text between long text written by reference, so the piece table
+// fills up before the buffer and the other way around
+static void write_mixed(easycmd::usage_writer &w, const std::vector<std::string> &refs)
+{
+	for (size_t i = 0; i < refs.size(); i++) {
+		char num[32];
+		snprintf(num, sizeof(num), "<%d>", (int)i);
+		w.write(num);
+		w.write_ref(refs[i].c_str(), refs[i].size());
+		w.pad(i % 7);
+		if (i % 5 == 0) {
+			std::string copy(100 + i % 300, (char)('a' + i % 26));
+			w.write(copy.c_str(), copy.size());
+		}
+	}
+}
+
+UNIT_CASE(writer_pieces)
+{
+	std::vector<std::string> refs;
+	for (int i = 0; i < 2000; i++) {
+		refs.push_back(std::string(32 + i % 90, (char)('A' + i % 26)));
+	}
+
+	std::string expected;
+	{
+		easycmd::usage_writer w(expected);
+		write_mixed(w, refs);
+	}
+
+	FILE *f = tmpfile();
+	CHECK(f != NULL);
+	if (f) {
+		{
+			easycmd::usage_writer w(fileno(f));
+			write_mixed(w, refs);
+			CHECK(w.flush());
+		}
+		CHECK(read_back(f) == expected);
+	}
+
+	f = tmpfile();
+	CHECK(f != NULL);
+	if (f) {
+		{
+			easycmd::usage_writer w(f);
+			write_mixed(w, refs);
+		}
+		CHECK(read_back(f) == expected);
+	}
+}
+
+UNIT_CASE(writer_large_usage)
+{
+	easycmd::command app;
+	app.with_name("app")->with_desc("A tool with more usage than the buffer and the piece table hold")->with_action(noop);
+	for (int i = 0; i < 600; i++) {
+		char name[32];
+		snprintf(name, sizeof(name), "option-%d", i);
+		std::string desc = "Description of " + std::string(name) + " long enough to be written by reference";
+		app.create_option_int(name, "")->with_default(i)->with_desc(desc);
+	}
+	for (int i = 0; i < 300; i++) {
+		char name[32];
+		snprintf(name, sizeof(name), "sub%d", i);
+		std::string desc = "Sub command " + std::string(name) + " with a desc longer than a copied piece";
+		app.create_sub_cmd(name)->with_desc(desc)->with_action(noop);
+	}
+
+	std::string expected;
+	app.get_usage(expected);
+	CHECK(expected.size() > 16 * 4096);
+
+	FILE *f = tmpfile();
+	CHECK(f != NULL);
+	if (f) {
+		{
+			easycmd::usage_writer w(fileno(f));
+			app.write_usage(w, -1);
+		}
+		CHECK(read_back(f) == expected);
+	}
+}
@@ -0,0 +1,139 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "tokenizer.h"
+
+#include <ctype.h>
+
+namespace easycmd {
+
+    namespace internal {
+
+        void tokenize_arg(const char *arg, arg_token &tok) {
+            tok.has_value = false;
+            tok.value = string_ref();
+
+            // A negative number is never an option, so it can be a value
+            if (arg[0] != '-' || arg[1] == 0 || isdigit((unsigned char)arg[1]) || 
+                (arg[1] == '.' && isdigit((unsigned char)arg[2]))) {
+                tok.type = isalpha((unsigned char)arg[0]) ? ARG_COMMAND : ARG_OTHER;
+                tok.name = string_ref(arg);
+                return;
+            }
+
+            if (arg[1] == '-') {
+                if (isalpha((unsigned char)arg[2]) == 0) {
+                    tok.type = ARG_BAD_OPTION;
+                    tok.name = string_ref(arg);
+                    return;
+                }
+
+                const char *p = arg + 2;
+                while (*p != 0 && *p != '=') {
+                    p++;
+                }
+                tok.type = ARG_LONG_OPTION;
+                tok.name = string_ref(arg + 2, p - arg - 2);
+                if (*p == '=') {
+                    if (p[1] == 0) {
+                        tok.type = ARG_BAD_OPTION;
+                        tok.name = string_ref(arg);
+                        return;
+                    }
+                    tok.value = string_ref(p + 1);
+                    tok.has_value = true;
+                }
+                return;
+            }
+
+            if (isalpha((unsigned char)arg[1]) == 0) {
+                tok.type = ARG_BAD_OPTION;
+                tok.name = string_ref(arg);
+                return;
+            }
+
+            const char *p = arg + 1;
+            while (*p != 0) {
+                if (*p == '=') {
+                    tok.type = ARG_BAD_OPTION;
+                    tok.name = string_ref(arg);
+                    return;
+                }
+                p++;
+            }
+            tok.type = ARG_SHORT_OPTION;
+            tok.name = string_ref(arg + 1, p - arg - 1);
+        }
+
+        bool split_command_line(char *line, std::vector<const char*> &args, bool comments) {
+            char *r = line;
+            char *w = line;
+            while (true) {
+                while (*r == ' ' || *r == '\t' || *r == '\r' || *r == '\n') {
+                    r++;
+                }
+                if (comments && *r == '#') {
+                    while (*r != 0 && *r != '\n') {
+                        r++;
+                    }
+                    continue;
+                }
+                if (*r == 0) {
+                    return true;
+                }
+
+                char *arg = w;
+                char quote = 0;
+                while (*r != 0) {
+                    char c = *r;
+                    if (quote == 0 && (c == ' ' || c == '\t' || c == '\r' || c == '\n')) {
+                        r++;
+                        break;
+                    }
+
+                    r++;
+                    if (c == '\'' && quote != '"') {
+                        quote = quote ? 0 : c;
+                    } else if (c == '"' && quote != '\'') {
+                        quote = quote ? 0 : c;
+                    } else if (c == '\\' && quote != '\'' && *r != 0) {
+                        *w++ = *r++;
+                    } else {
+                        *w++ = c;
+                    }
+                }
+                if (quote != 0) {
+                    return false;
+                }
+
+                // The write position never passes the read position, so the
+                // terminator can't overwrite unread characters.
+                *w++ = 0;
+                args.push_back(arg);
+            }
+        }
+
+    }
+
+}
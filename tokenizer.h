@@ -0,0 +1,100 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef easycmd_tokenizer_h
+#define easycmd_tokenizer_h
+
+#include <vector>
+
+#include "string_ref.h"
+
+namespace easycmd {
+
+    namespace internal {
+
+        /*********************************************************************************
+         * Argument types
+         ********************************************************************************/
+        enum arg_type
+        {
+            // --name or --name=value
+            ARG_LONG_OPTION = 0,
+            // -n or bundled short names -abc
+            ARG_SHORT_OPTION,
+            // Starts with '-' but is not a valid option, it can't be an option value
+            ARG_BAD_OPTION,
+            // Starts with a letter, it may be a command or an option value
+            ARG_COMMAND,
+            // Any other argument such as a negative number, it may be an option value
+            ARG_OTHER
+        };
+
+        /*********************************************************************************
+         * Argument token
+         * Name and value are views into the argument string. A value is always the 
+         * tail of the argument, so it is null terminated.
+         ********************************************************************************/
+        struct arg_token
+        {
+            arg_type type;
+            // Option name(s) without dashes, or the whole argument
+            string_ref name;
+            // Value after '=' of long option
+            string_ref value;
+            bool has_value;
+        };
+
+        /*********************************************************************************
+         * Tokenize argument
+         * The argument is scanned once and never copied.
+         ********************************************************************************/
+        void tokenize_arg(const char *arg, arg_token &tok);
+
+        /*********************************************************************************
+         * Split command line
+         * Arguments are separated by whitespace. Single quotes keep all characters,
+         * double quotes keep all characters but backslash escapes, and a backslash
+         * outside single quotes escapes the next character. The line is rewritten in
+         * place and the arguments point into it. If comments is true, an argument 
+         * starting with '#' starts a comment to the end of the line. Return false if 
+         * a quote is not terminated.
+         ********************************************************************************/
+        bool split_command_line(char *line, 
+                                std::vector<const char*> &args, 
+                                bool comments = false);
+
+        /*********************************************************************************
+         * Check the argument can't be used as option value
+         ********************************************************************************/
+        inline bool is_option_token(const arg_token &tok) {
+            return tok.type == ARG_LONG_OPTION ||
+                   tok.type == ARG_SHORT_OPTION ||
+                   tok.type == ARG_BAD_OPTION;
+        }
+
+    }
+
+}
+
+#endif
@@ -0,0 +1,265 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "typed_option.h"
+
+#if defined(WIN32)
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#endif
+
+namespace easycmd {
+
+    namespace internal {
+
+        struct value_unit
+        {
+            const char *name;
+            uint64_t scale;
+        };
+
+        static const value_unit duration_units[] = {
+            { "ns", 1ULL },
+            { "us", 1000ULL },
+            { "\xC2\xB5s", 1000ULL },
+            { "ms", 1000000ULL },
+            { "s", 1000000000ULL },
+            { "m", 60000000000ULL },
+            { "h", 3600000000000ULL },
+            { "d", 86400000000000ULL },
+        };
+
+        static const value_unit byte_units[] = {
+            { "b", 1ULL },
+            { "k", 1ULL << 10 },
+            { "kib", 1ULL << 10 },
+            { "kb", 1000ULL },
+            { "m", 1ULL << 20 },
+            { "mib", 1ULL << 20 },
+            { "mb", 1000000ULL },
+            { "g", 1ULL << 30 },
+            { "gib", 1ULL << 30 },
+            { "gb", 1000000000ULL },
+            { "t", 1ULL << 40 },
+            { "tib", 1ULL << 40 },
+            { "tb", 1000000000000ULL },
+            { "p", 1ULL << 50 },
+            { "pib", 1ULL << 50 },
+            { "pb", 1000000000000000ULL },
+            { "e", 1ULL << 60 },
+            { "eib", 1ULL << 60 },
+            { "eb", 1000000000000000000ULL },
+        };
+
+        /*********************************************************************************
+         * Parse a number with unit from s[i] and scale it
+         * The unit is matched without case if nocase is true. The number is invalid 
+         * if it has no digit or the unit is unknown.
+         ********************************************************************************/
+        template <size_t N>
+        static parse_status __parse_scaled(const char *s, 
+                                           size_t len, 
+                                           size_t &i, 
+                                           const value_unit (&units)[N], 
+                                           bool nocase,
+                                           bool unit_required,
+                                           uint64_t &value) {
+            size_t beg = i;
+            uint64_t whole = 0;
+            bool overflow = false;
+            for (; i < len && s[i] >= '0' && s[i] <= '9'; i++) {
+                uint64_t d = (uint64_t)(s[i] - '0');
+                if (whole > (UINT64_MAX - d) / 10) {
+                    overflow = true;
+                } else {
+                    whole = whole * 10 + d;
+                }
+            }
+            bool any = i > beg;
+            double frac = 0.0;
+            if (i < len && s[i] == '.') {
+                double scale = 0.1;
+                size_t fbeg = ++i;
+                for (; i < len && s[i] >= '0' && s[i] <= '9'; i++) {
+                    frac += (s[i] - '0') * scale;
+                    scale /= 10;
+                }
+                any = any || i > fbeg;
+            }
+            if (!any) {
+                return PARSE_INVALID;
+            }
+
+            size_t ubeg = i;
+            while (i < len && !(s[i] >= '0' && s[i] <= '9') && s[i] != '.') {
+                i++;
+            }
+            uint64_t scale = 0;
+            if (ubeg == i) {
+                scale = unit_required ? 0 : 1;
+            }
+            for (size_t u = 0; u < N && scale == 0 && ubeg < i; u++) {
+                size_t n = strlen(units[u].name);
+                if (n != i - ubeg) {
+                    continue;
+                }
+                size_t k = 0;
+                for (; k < n; k++) {
+                    char c = s[ubeg + k];
+                    if ((nocase && c >= 'A' && c <= 'Z' ? c | 0x20 : c) != units[u].name[k]) {
+                        break;
+                    }
+                }
+                if (k == n) {
+                    scale = units[u].scale;
+                }
+            }
+            if (scale == 0) {
+                return PARSE_INVALID;
+            }
+
+            if (overflow || (whole > 0 && whole > UINT64_MAX / scale)) {
+                return PARSE_OVERFLOW;
+            }
+            uint64_t part = (uint64_t)(frac * (double)scale + 0.5);
+            if (whole * scale > UINT64_MAX - part) {
+                return PARSE_OVERFLOW;
+            }
+
+            value = whole * scale + part;
+            return PARSE_OK;
+        }
+
+        parse_status parse_duration(const char *s, size_t len, int64_t &ns) {
+            size_t i = 0;
+            bool neg = false;
+            if (len > 0 && (s[0] == '-' || s[0] == '+')) {
+                neg = s[0] == '-';
+                i++;
+            }
+            if (i + 1 == len && s[i] == '0') {
+                ns = 0;
+                return PARSE_OK;
+            }
+            if (i == len) {
+                return PARSE_INVALID;
+            }
+
+            uint64_t total = 0;
+            while (i < len) {
+                uint64_t v = 0;
+                parse_status st = __parse_scaled(s, len, i, duration_units, false, true, v);
+                if (st != PARSE_OK) {
+                    return st;
+                }
+                if (v > (uint64_t)INT64_MAX - total) {
+                    return PARSE_OVERFLOW;
+                }
+                total += v;
+            }
+
+            ns = neg ? -(int64_t)total : (int64_t)total;
+            return PARSE_OK;
+        }
+
+        parse_status parse_byte_size(const char *s, size_t len, uint64_t &bytes) {
+            size_t i = 0;
+            if (len > 0 && s[0] == '+') {
+                i++;
+            }
+
+            uint64_t v = 0;
+            parse_status st = __parse_scaled(s, len, i, byte_units, true, false, v);
+            if (st != PARSE_OK) {
+                return st;
+            }
+            if (i != len) {
+                return PARSE_INVALID;
+            }
+
+            bytes = v;
+            return PARSE_OK;
+        }
+
+        parse_status parse_endpoint(const char *s, size_t len, endpoint &ep) {
+            // The address is copied to be null terminated for inet_pton
+            char host[64];
+            const char *colon = NULL;
+            endpoint v;
+            memset(&v, 0, sizeof(v));
+            if (len > 0 && s[0] == '[') {
+                const char *close = (const char*)memchr(s, ']', len);
+                if (close == NULL || close + 1 == s + len || close[1] != ':') {
+                    return PARSE_INVALID;
+                }
+                size_t n = (size_t)(close - s - 1);
+                if (n == 0 || n >= sizeof(host)) {
+                    return PARSE_INVALID;
+                }
+                memcpy(host, s + 1, n);
+                host[n] = 0;
+                if (inet_pton(AF_INET6, host, v.addr) != 1) {
+                    return PARSE_INVALID;
+                }
+                v.family = 6;
+                colon = close + 1;
+            } else {
+                colon = (const char*)memchr(s, ':', len);
+                size_t n = colon ? (size_t)(colon - s) : 0;
+                if (n == 0 || n >= sizeof(host)) {
+                    return PARSE_INVALID;
+                }
+                memcpy(host, s, n);
+                host[n] = 0;
+                if (inet_pton(AF_INET, host, v.addr) != 1) {
+                    return PARSE_INVALID;
+                }
+                v.family = 4;
+            }
+
+            const char *port = colon + 1;
+            const char *end = s + len;
+            if (port == end) {
+                return PARSE_INVALID;
+            }
+            unsigned p = 0;
+            for (; port < end; port++) {
+                if (*port < '0' || *port > '9') {
+                    return PARSE_INVALID;
+                }
+                p = p * 10 + (unsigned)(*port - '0');
+                if (p > 65535) {
+                    return PARSE_OVERFLOW;
+                }
+            }
+
+            v.port = (unsigned short)p;
+            ep = v;
+            return PARSE_OK;
+        }
+
+    }
+
+}
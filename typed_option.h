@@ -0,0 +1,308 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef easycmd_typed_option_h
+#define easycmd_typed_option_h
+
+#include <new>
+#include <chrono>
+#include <string>
+#include <stdint.h>
+#include <string.h>
+
+#include "option.h"
+#include "number.h"
+
+namespace easycmd {
+
+    /*********************************************************************************
+     * Byte size
+     * Parsed from a number with an optional unit, such as "512", "64MiB" or "1.5G".
+     * Units are case insensitive: b, k/kib, m/mib, g/gib, t/tib, p/pib and e/eib are
+     * powers of 1024, kb, mb, gb, tb, pb and eb are powers of 1000.
+     ********************************************************************************/
+    struct byte_size
+    {
+        uint64_t bytes;
+    };
+
+    /*********************************************************************************
+     * IP endpoint
+     * Parsed from "a.b.c.d:port" or "[ipv6]:port". The address is in network order,
+     * only the first 4 bytes are used by IPv4.
+     ********************************************************************************/
+    struct endpoint
+    {
+        // 4 or 6
+        int family;
+        unsigned char addr[16];
+        unsigned short port;
+    };
+
+    /*********************************************************************************
+     * Enum value name
+     ********************************************************************************/
+    template <typename E>
+    struct enum_value
+    {
+        const char *name;
+        E value;
+    };
+
+    namespace internal {
+
+        /*********************************************************************************
+         * Parse duration
+         * A sequence of numbers with units, such as "250ms", "1.5s" or "1h30m". Units
+         * are ns, us, ms, s, m, h and d. A bare "0" is allowed.
+         ********************************************************************************/
+        parse_status parse_duration(const char *s, size_t len, int64_t &ns);
+
+        /*********************************************************************************
+         * Parse byte size
+         ********************************************************************************/
+        parse_status parse_byte_size(const char *s, size_t len, uint64_t &bytes);
+
+        /*********************************************************************************
+         * Parse endpoint
+         ********************************************************************************/
+        parse_status parse_endpoint(const char *s, size_t len, endpoint &ep);
+
+    }
+
+    /*********************************************************************************
+     * Parse enum by name
+     * Helper for option parsers of enums, names are case sensitive.
+     ********************************************************************************/
+    template <typename E, size_t N>
+    parse_status parse_enum(const char *value, size_t len, const enum_value<E> (&values)[N], E &out) {
+        for (size_t i = 0; i < N; i++) {
+            if (strlen(values[i].name) == len && memcmp(values[i].name, value, len) == 0) {
+                out = values[i].value;
+                return PARSE_OK;
+            }
+        }
+        return PARSE_INVALID;
+    }
+
+    /*********************************************************************************
+     * Option parser
+     * Specialize it to use a type for typed options:
+     *
+     *   template <> struct option_parser<color> {
+     *       static parse_status parse(const char *value, size_t len, color &out) {
+     *           static const enum_value<color> values[] = { {"red", RED}, {"blue", BLUE} };
+     *           return parse_enum(value, len, values, out);
+     *       }
+     *   };
+     *
+     * The value is not null terminated. There is no parser for types without one.
+     ********************************************************************************/
+    template <typename T>
+    struct option_parser;
+
+    template <>
+    struct option_parser<int> {
+        static parse_status parse(const char *value, size_t len, int &out) {
+            return internal::parse_int(value, len, out);
+        }
+    };
+
+    template <>
+    struct option_parser<long long> {
+        static parse_status parse(const char *value, size_t len, long long &out) {
+            int64_t v = 0;
+            parse_status st = internal::parse_int64(value, len, v);
+            out = (long long)v;
+            return st;
+        }
+    };
+
+    template <>
+    struct option_parser<long> {
+        static parse_status parse(const char *value, size_t len, long &out) {
+            int64_t v = 0;
+            parse_status st = internal::parse_int64(value, len, v);
+            if (st == PARSE_OK && (long)v != v) {
+                return PARSE_OVERFLOW;
+            }
+            out = (long)v;
+            return st;
+        }
+    };
+
+    template <>
+    struct option_parser<unsigned long long> {
+        static parse_status parse(const char *value, size_t len, unsigned long long &out) {
+            uint64_t v = 0;
+            parse_status st = internal::parse_uint64(value, len, v);
+            out = (unsigned long long)v;
+            return st;
+        }
+    };
+
+    template <>
+    struct option_parser<unsigned long> {
+        static parse_status parse(const char *value, size_t len, unsigned long &out) {
+            uint64_t v = 0;
+            parse_status st = internal::parse_uint64(value, len, v);
+            if (st == PARSE_OK && (unsigned long)v != v) {
+                return PARSE_OVERFLOW;
+            }
+            out = (unsigned long)v;
+            return st;
+        }
+    };
+
+    template <>
+    struct option_parser<unsigned int> {
+        static parse_status parse(const char *value, size_t len, unsigned int &out) {
+            uint64_t v = 0;
+            parse_status st = internal::parse_uint64(value, len, v);
+            if (st == PARSE_OK && (unsigned int)v != v) {
+                return PARSE_OVERFLOW;
+            }
+            out = (unsigned int)v;
+            return st;
+        }
+    };
+
+    template <>
+    struct option_parser<double> {
+        static parse_status parse(const char *value, size_t len, double &out) {
+            return internal::parse_double(value, len, out);
+        }
+    };
+
+    template <>
+    struct option_parser<byte_size> {
+        static parse_status parse(const char *value, size_t len, byte_size &out) {
+            return internal::parse_byte_size(value, len, out.bytes);
+        }
+    };
+
+    template <>
+    struct option_parser<endpoint> {
+        static parse_status parse(const char *value, size_t len, endpoint &out) {
+            return internal::parse_endpoint(value, len, out);
+        }
+    };
+
+    // Durations are truncated to the period of the type
+    template <typename Rep, typename Period>
+    struct option_parser<std::chrono::duration<Rep, Period> > {
+        static parse_status parse(const char *value, 
+                                  size_t len, 
+                                  std::chrono::duration<Rep, Period> &out) {
+            int64_t ns = 0;
+            parse_status st = internal::parse_duration(value, len, ns);
+            out = std::chrono::duration_cast<std::chrono::duration<Rep, Period> >(std::chrono::nanoseconds(ns));
+            return st;
+        }
+    };
+
+    /*********************************************************************************
+     * Typed option
+     * The value is parsed by option_parser<T> and stored as T. T must be trivially 
+     * copyable, the value is copied by parse results.
+     ********************************************************************************/
+    template <typename T>
+    class typed_option : public option {
+      protected:
+        friend class arena;
+        friend class command;
+
+      public:
+        /*********************************************************************************
+         * Set environmnet
+         ********************************************************************************/
+        typed_option* with_env(const std::string &env) { 
+            option::with_env(env);
+            return this; 
+        }
+
+        /*********************************************************************************
+         * Set desc
+         ********************************************************************************/
+        typed_option* with_desc(const std::string &usage) { 
+            option::with_desc(usage);
+            return this; 
+        }
+
+        /*********************************************************************************
+         * Set default value
+         ********************************************************************************/
+        typed_option* with_default(const T &value) {
+            required_ = false;
+            *(T*)typed_->def = value;
+            *(T*)typed_->last = value;
+            val_.found_ = true;
+            val_.source_ = SOURCE_DEFAULT;
+            return this;
+        }
+
+        /*********************************************************************************
+         * Get value
+         * Inside an action callback, this returns the value parsed by the running 
+         * command line of the current thread. Otherwise it returns the value of the 
+         * last run(argc, argv), or the default value.
+         ********************************************************************************/
+        const T& get() const {
+            return *(const T*)__typed_value();
+        }
+
+      private:
+        /*********************************************************************************
+         * Constructor
+         ********************************************************************************/
+        typed_option(arena *a,
+                     const command *owner,
+                     int pos,
+                     const char *lname, 
+                     const char *sname,
+                     internal::typed_value *tv)
+          : option(a, owner, pos, internal::OP_TYPE_TYPED, lname, sname) {
+            typed_ = tv;
+            typed_->parse = &typed_option::__parse;
+            new (typed_->def) T();
+            new (typed_->last) T();
+        }
+
+        /*********************************************************************************
+         * Parse value
+         * The value is only changed if it is parsed.
+         ********************************************************************************/
+        static parse_status __parse(const char *value, size_t len, void *out) {
+            T v(*(const T*)out);
+            parse_status st = option_parser<T>::parse(value, len, v);
+            if (st == PARSE_OK) {
+                *(T*)out = v;
+            }
+            return st;
+        }
+    };
+
+}
+
+#endif
@@ -0,0 +1,368 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "command.h"
+#include "usage_writer.h"
+
+#include <algorithm>
+
+#if !defined(WIN32)
+#include <unistd.h>
+#endif
+
+namespace easycmd {
+
+    namespace internal
+    {
+        // Names are indented, and descs start at least at this column
+        static const size_t usage_indent = 4;
+        static const size_t usage_min_column = 32;
+        // Descs narrower than this are not wrapped, the terminal wraps them
+        static const size_t usage_min_desc_width = 20;
+
+        /*********************************************************************************
+         * Usage text
+         * Text written at a column. If width is set, words are wrapped at it and lines
+         * go on at the column, else text is written as it is. Text not alive until the
+         * writer is flushed must not be written by reference.
+         ********************************************************************************/
+        class usage_text
+        {
+        public:
+            usage_text(usage_writer &w, size_t column, size_t width)
+              : w_(w),
+                column_(column),
+                width_(width),
+                x_(column),
+                space_(false) {
+            }
+
+            void write(const char *data, size_t len, bool ref = true) {
+                if (width_ == 0) {
+                    ref ? w_.write_ref(data, len) : w_.write(data, len);
+                    return;
+                }
+
+                const char *end = data + len;
+                while (data < end) {
+                    if (*data == ' ' || *data == '\t') {
+                        space_ = x_ > column_;
+                        data++;
+                        continue;
+                    }
+                    if (*data == '\n') {
+                        __break_line();
+                        data++;
+                        continue;
+                    }
+
+                    const char *word = data;
+                    while (data < end && *data != ' ' && *data != '\t' && *data != '\n') {
+                        data++;
+                    }
+                    size_t len = (size_t)(data - word);
+                    if (x_ > column_ && x_ + (space_ ? 1 : 0) + len > width_) {
+                        __break_line();
+                    } else if (space_) {
+                        w_.write(" ", 1);
+                        x_++;
+                    }
+                    ref ? w_.write_ref(word, len) : w_.write(word, len);
+                    x_ += len;
+                    space_ = false;
+                }
+            }
+
+            void write(const char *str) {
+                write(str, strlen(str));
+            }
+
+        private:
+            void __break_line() {
+                w_.write("\n", 1);
+                w_.pad(column_);
+                x_ = column_;
+                space_ = false;
+            }
+
+        private:
+            usage_writer &w_;
+            size_t column_;
+            size_t width_;
+            // Column of the next byte
+            size_t x_;
+            // A space is pending before the next word
+            bool space_;
+        };
+
+        /*********************************************************************************
+         * Pad usage row name
+         * Descs start at the column of the name line, or of the next line if the name 
+         * reaches it.
+         ********************************************************************************/
+        static void pad_usage_name(usage_writer &w, size_t name_len, size_t column) {
+            if (usage_indent + name_len < column) {
+                w.pad(column - usage_indent - name_len);
+            } else {
+                w.write("\n", 1);
+                w.pad(column);
+            }
+        }
+    }
+
+    void command::get_usage(std::string &des) const {
+        usage_writer w(des);
+        write_usage(w, -1);
+    }
+
+    void command::print_usage() const {
+        fflush(stdout);
+#if defined(WIN32)
+        usage_writer w(stdout);
+#else
+        usage_writer w(STDOUT_FILENO);
+#endif
+        write_usage(w);
+    }
+
+    void command::write_usage(usage_writer &w, int width) const {
+        if (width == 0) {
+            width = w.get_terminal_width();
+        }
+        size_t term_width = width > 0 ? (size_t)width : 0;
+
+        if (desc_[0] != 0) {
+            w.write("\n", 1);
+            internal::usage_text text(w, 0, term_width);
+            text.write(desc_);
+            w.write("\n", 1);
+        }
+
+        // Names and descs of visible sub commands sorted by name, without this one.
+        // The static scope is read from the scope table without copying.
+        const scope_table *table = NULL;
+        desc_map descs;
+        if (__has_static_scope()) {
+            table = __get_scope_table();
+        } else {
+            __get_sub_cmds(descs, this);
+            __get_public_sub_cmds(descs, this);
+        }
+        const usage_layout *layout = __get_usage_layout(table);
+
+        bool has_sub_cmds = false;
+        size_t sub_cmd_width = 0;
+        if (table) {
+            sub_cmd_width = layout->sub_cmd_width;
+            for (size_t i = 0; i < table->entries.size() && !has_sub_cmds; i++) {
+                has_sub_cmds = __get_scope_cmd(table->entries[i], false) != this;
+            }
+        } else {
+            for (desc_map::const_iterator it = descs.begin(); it != descs.end(); it++) {
+                if (it->second != NULL) {
+                    sub_cmd_width = std::max(sub_cmd_width, it->first.size());
+                    has_sub_cmds = true;
+                }
+            }
+        }
+
+        std::string path = __get_cmd_path();
+        w.write("\nUsage:\n  ");
+        w.write(path.data(), path.size());
+        if (has_sub_cmds) {
+            w.write(" [COMMAND]");
+        }
+        if (!options_.empty()) {
+            w.write(" [OPTIONS]");
+        }
+        for (size_t i = 0; i < positionals_.size(); i++) {
+            const positional *pos = positionals_[i];
+            w.write(pos->required_ ? " <" : " [", 2);
+            w.write_ref(pos->name_);
+            if (pos->tail_) {
+                w.write("...", 3);
+            }
+            w.write(pos->required_ ? ">" : "]", 1);
+        }
+        w.write("\n", 1);
+
+        // Descs of all sections start at one column, after the widest name. On a 
+        // terminal the column is kept in the left half, wider names get their own line.
+        size_t name_width = std::max(sub_cmd_width, std::max(layout->option_width, layout->positional_width));
+        size_t column = std::max(internal::usage_min_column, internal::usage_indent + name_width + 2);
+        if (term_width > 0 && column > term_width / 2) {
+            column = std::max(internal::usage_min_column, term_width / 2);
+        }
+        size_t wrap_width = term_width >= column + internal::usage_min_desc_width ? term_width : 0;
+
+        if (has_sub_cmds) {
+            w.write("\nCOMMANDS: \n");
+            if (table) {
+                for (size_t i = 0; i < table->entries.size(); i++) {
+                    const scope_entry &e = table->entries[i];
+                    if (__get_scope_cmd(e, false) != this) {
+                        w.write("    ", 4);
+                        w.write_ref(e.name);
+                        internal::pad_usage_name(w, strlen(e.name), column);
+                        internal::usage_text(w, column, wrap_width).write(e.desc);
+                        w.write("\n", 1);
+                    }
+                }
+            } else {
+                for (desc_map::const_iterator it = descs.begin(); it != descs.end(); it++) {
+                    if (it->second != NULL) {
+                        w.write("    ", 4);
+                        w.write_ref(it->first.data(), it->first.size());
+                        internal::pad_usage_name(w, it->first.size(), column);
+                        internal::usage_text(w, column, wrap_width).write(it->second);
+                        w.write("\n", 1);
+                    }
+                }
+            }
+        }
+
+        if (!options_.empty()) {
+            std::string choices;
+            w.write("\nOPTIONS: \n");
+            for (size_t i = 0; i < options_.size(); i++) {
+                const option *opt = options_[i];
+
+                w.write("    ", 4);
+                if (opt->short_name_[0] != 0) {
+                    w.write("-", 1);
+                    w.write_ref(opt->short_name_);
+                }
+                if (opt->long_name_[0] != 0) {
+                    if (opt->short_name_[0] != 0) {
+                        w.write(", ", 2);
+                    }
+                    w.write("--", 2);
+                    w.write_ref(opt->long_name_);
+                }
+
+                internal::pad_usage_name(w, layout->option_widths[i], column);
+                internal::usage_text text(w, column, wrap_width);
+                text.write(opt->required_ ? "[Required] " : "[Optional] ");
+                text.write(opt->desc_);
+                if (opt->choices_) {
+                    // Choices are copied, the string is reused by the next option
+                    choices.assign(opt->desc_[0] != 0 ? " (" : "(");
+                    opt->choices_->join("|", choices);
+                    choices.append(")");
+                    text.write(choices.data(), choices.size(), false);
+                }
+                w.write("\n", 1);
+            }
+        }
+
+        if (!positionals_.empty()) {
+            w.write("\nARGUMENTS: \n");
+            for (size_t i = 0; i < positionals_.size(); i++) {
+                const positional *pos = positionals_[i];
+                size_t name_len = strlen(pos->name_);
+                w.write("    ", 4);
+                w.write_ref(pos->name_, name_len);
+                if (pos->tail_) {
+                    w.write("...", 3);
+                    name_len += 3;
+                }
+
+                internal::pad_usage_name(w, name_len, column);
+                internal::usage_text text(w, column, wrap_width);
+                text.write(pos->required_ ? "[Required] " : "[Optional] ");
+                text.write(pos->desc_);
+                w.write("\n", 1);
+            }
+        }
+
+        // Sub command names of the desc map and the path are written by reference
+        w.flush();
+    }
+
+    const command::usage_layout* command::__get_usage_layout(const scope_table *table) const {
+        unsigned generation = table ? table->generation.load(std::memory_order_acquire) : 0;
+        usage_layout *layout = usage_layout_.load(std::memory_order_acquire);
+        if (layout && !usage_layout_stale_.load(std::memory_order_acquire) &&
+            (table == NULL || layout->scope_generation == generation)) {
+            return layout;
+        }
+
+        std::lock_guard<std::mutex> lock(arena_->get_mutex());
+        layout = usage_layout_.load(std::memory_order_relaxed);
+        if (layout && !usage_layout_stale_.load(std::memory_order_relaxed) &&
+            (table == NULL || layout->scope_generation == generation)) {
+            return layout;
+        }
+
+        // A stale layout is measured again in place, the widths only grow when 
+        // options were added past their room
+        if (layout == NULL) {
+            layout = arena_->create<usage_layout>();
+            layout->option_widths = NULL;
+            layout->option_capacity = 0;
+        }
+        layout->scope_generation = generation;
+        layout->sub_cmd_width = 0;
+        if (table) {
+            for (size_t i = 0; i < table->entries.size(); i++) {
+                const scope_entry &e = table->entries[i];
+                if (__get_scope_cmd(e, false) != this) {
+                    layout->sub_cmd_width = std::max(layout->sub_cmd_width, strlen(e.name));
+                }
+            }
+        }
+
+        layout->option_width = 0;
+        if (layout->option_widths == NULL || options_.size() > layout->option_capacity) {
+            size_t capacity = std::max(options_.size(), layout->option_capacity * 2);
+            layout->option_widths = (size_t*)arena_->allocate(sizeof(size_t) * (capacity + 1), 
+                                                              alignof(size_t));
+            layout->option_capacity = capacity;
+        }
+        for (size_t i = 0; i < options_.size(); i++) {
+            const option *opt = options_[i];
+            size_t len = 0;
+            if (opt->short_name_[0] != 0) {
+                len += 1 + strlen(opt->short_name_);
+            }
+            if (opt->long_name_[0] != 0) {
+                len += (opt->short_name_[0] != 0 ? 2 : 0) + 2 + strlen(opt->long_name_);
+            }
+            layout->option_widths[i] = len;
+            layout->option_width = std::max(layout->option_width, len);
+        }
+
+        layout->positional_width = 0;
+        for (size_t i = 0; i < positionals_.size(); i++) {
+            size_t len = strlen(positionals_[i]->name_) + (positionals_[i]->tail_ ? 3 : 0);
+            layout->positional_width = std::max(layout->positional_width, len);
+        }
+
+        usage_layout_stale_.store(false, std::memory_order_release);
+        usage_layout_.store(layout, std::memory_order_release);
+
+        return layout;
+    }
+
+}
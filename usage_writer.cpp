@@ -0,0 +1,202 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "usage_writer.h"
+
+#if defined(WIN32)
+#include <io.h>
+#else
+#include <errno.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <sys/ioctl.h>
+#endif
+
+namespace easycmd {
+
+    usage_writer::usage_writer(int fd)
+      : fd_(fd),
+        file_(NULL),
+        des_(NULL),
+        piece_cnt_(0),
+        buffer_len_(0),
+        failed_(false) {
+    }
+
+    usage_writer::usage_writer(FILE *file)
+      : fd_(-1),
+        file_(file),
+        des_(NULL),
+        piece_cnt_(0),
+        buffer_len_(0),
+        failed_(false) {
+    }
+
+    usage_writer::usage_writer(std::string &des)
+      : fd_(-1),
+        file_(NULL),
+        des_(&des),
+        piece_cnt_(0),
+        buffer_len_(0),
+        failed_(false) {
+    }
+
+    usage_writer::~usage_writer() {
+        flush();
+    }
+
+    void usage_writer::write(const char *data, size_t len) {
+        if (des_) {
+            des_->append(data, len);
+            return;
+        }
+
+        while (len > 0) {
+            // A flush empties the buffer, so it is done before copying: when the
+            // buffer is full, or the copy needs a piece and the table is full
+            char *dst = buffer_ + buffer_len_;
+            bool extends = piece_cnt_ > 0 && 
+                           pieces_[piece_cnt_ - 1].data + pieces_[piece_cnt_ - 1].len == dst;
+            if ((buffer_len_ == BUFFER_SIZE || (piece_cnt_ == MAX_PIECES && !extends)) && !flush()) {
+                return;
+            }
+            size_t n = BUFFER_SIZE - buffer_len_;
+            n = n < len ? n : len;
+            dst = buffer_ + buffer_len_;
+            memcpy(dst, data, n);
+            buffer_len_ += n;
+            __add_piece(dst, n);
+            data += n;
+            len -= n;
+        }
+    }
+
+    void usage_writer::write_ref(const char *data, size_t len) {
+        if (des_) {
+            des_->append(data, len);
+        } else if (len < MIN_REF_SIZE) {
+            write(data, len);
+        } else {
+            __add_piece(data, len);
+        }
+    }
+
+    void usage_writer::pad(size_t cnt) {
+        static const char spaces[] = "                                ";
+        while (cnt > 0) {
+            size_t n = cnt < sizeof(spaces) - 1 ? cnt : sizeof(spaces) - 1;
+            write(spaces, n);
+            cnt -= n;
+        }
+    }
+
+    void usage_writer::__add_piece(const char *data, size_t len) {
+        // Copied text next to the last piece extends it
+        if (piece_cnt_ > 0) {
+            piece &last = pieces_[piece_cnt_ - 1];
+            if (last.data + last.len == data) {
+                last.len += len;
+                return;
+            }
+        }
+        if (piece_cnt_ == MAX_PIECES && !flush()) {
+            return;
+        }
+        pieces_[piece_cnt_].data = data;
+        pieces_[piece_cnt_].len = len;
+        piece_cnt_++;
+    }
+
+    bool usage_writer::flush() {
+        if (piece_cnt_ == 0 || failed_) {
+            piece_cnt_ = 0;
+            buffer_len_ = 0;
+            return !failed_;
+        }
+
+        if (file_) {
+            for (size_t i = 0; i < piece_cnt_ && !failed_; i++) {
+                failed_ = fwrite(pieces_[i].data, 1, pieces_[i].len, file_) != pieces_[i].len;
+            }
+        } else {
+            failed_ = !__write_fd();
+        }
+        piece_cnt_ = 0;
+        buffer_len_ = 0;
+
+        return !failed_;
+    }
+
+    bool usage_writer::__write_fd() {
+#if defined(WIN32)
+        for (size_t i = 0; i < piece_cnt_; i++) {
+            if (_write(fd_, pieces_[i].data, (unsigned)pieces_[i].len) != (int)pieces_[i].len) {
+                return false;
+            }
+        }
+        return true;
+#else
+        iovec iov[MAX_PIECES];
+        for (size_t i = 0; i < piece_cnt_; i++) {
+            iov[i].iov_base = (void*)pieces_[i].data;
+            iov[i].iov_len = pieces_[i].len;
+        }
+
+        // A short write continues from where it stopped
+        iovec *cur = iov;
+        int cnt = (int)piece_cnt_;
+        while (cnt > 0) {
+            ssize_t n = writev(fd_, cur, cnt);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            while (cnt > 0 && (size_t)n >= cur->iov_len) {
+                n -= (ssize_t)cur->iov_len;
+                cur++;
+                cnt--;
+            }
+            if (cnt > 0) {
+                cur->iov_base = (char*)cur->iov_base + n;
+                cur->iov_len -= (size_t)n;
+            }
+        }
+        return true;
+#endif
+    }
+
+    int usage_writer::get_terminal_width() const {
+#if !defined(WIN32)
+        int fd = file_ ? fileno(file_) : fd_;
+        winsize ws;
+        if (fd >= 0 && isatty(fd) && ioctl(fd, TIOCGWINSZ, &ws) == 0) {
+            return (int)ws.ws_col;
+        }
+#endif
+        return 0;
+    }
+
+}
@@ -0,0 +1,149 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 jimi36
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef easycmd_usage_writer_h
+#define easycmd_usage_writer_h
+
+#include <string>
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+
+namespace easycmd {
+
+    /*********************************************************************************
+     * Usage writer
+     * Sink of usage text: a file descriptor, a FILE or a string. Text for a file 
+     * descriptor or a FILE is gathered in a bounded buffer and written out when it
+     * is full or flushed, a file descriptor with writev. Text written by reference 
+     * is not copied and must be alive until it is flushed.
+     ********************************************************************************/
+    class usage_writer
+    {
+    public:
+        /*********************************************************************************
+         * Constructor
+         ********************************************************************************/
+        explicit usage_writer(int fd);
+        explicit usage_writer(FILE *file);
+        explicit usage_writer(std::string &des);
+
+        /*********************************************************************************
+         * Deconstructor
+         * Buffered text is flushed.
+         ********************************************************************************/
+        ~usage_writer();
+
+        /*********************************************************************************
+         * Write text
+         ********************************************************************************/
+        void write(const char *data, size_t len);
+        void write(const char *str) {
+            write(str, strlen(str));
+        }
+
+        /*********************************************************************************
+         * Write text by reference
+         ********************************************************************************/
+        void write_ref(const char *data, size_t len);
+        void write_ref(const char *str) {
+            write_ref(str, strlen(str));
+        }
+
+        /*********************************************************************************
+         * Write spaces
+         ********************************************************************************/
+        void pad(size_t cnt);
+
+        /*********************************************************************************
+         * Flush buffered text
+         * Return false if writing failed, then later text is dropped.
+         ********************************************************************************/
+        bool flush();
+
+        /*********************************************************************************
+         * Get terminal width
+         * Columns of the terminal the sink writes to, 0 if it is not a terminal.
+         ********************************************************************************/
+        int get_terminal_width() const;
+
+        /*********************************************************************************
+         * Check writing failed
+         ********************************************************************************/
+        bool is_failed() const {
+            return failed_;
+        }
+
+    private:
+        /*********************************************************************************
+         * Disable copy
+         ********************************************************************************/
+        usage_writer(const usage_writer&);
+        usage_writer& operator=(const usage_writer&);
+
+        /*********************************************************************************
+         * Add text piece
+         ********************************************************************************/
+        void __add_piece(const char *data, size_t len);
+
+        /*********************************************************************************
+         * Write pieces to file descriptor
+         ********************************************************************************/
+        bool __write_fd();
+
+    private:
+        enum 
+        {
+            // Pieces and bytes buffered before a flush
+            MAX_PIECES = 64,
+            BUFFER_SIZE = 4096,
+            // Shorter text written by reference is copied, a piece costs more
+            MIN_REF_SIZE = 32
+        };
+
+        struct piece
+        {
+            const char *data;
+            size_t len;
+        };
+
+    private:
+        // Sink, one of them
+        int fd_;
+        FILE *file_;
+        std::string *des_;
+
+        // Buffered pieces, copied text is placed in buffer
+        piece pieces_[MAX_PIECES];
+        size_t piece_cnt_;
+        char buffer_[BUFFER_SIZE];
+        size_t buffer_len_;
+
+        // Writing failed
+        bool failed_;
+    };
+
+}
+
+#endif